@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_BENCH_ALLOCATIONS_HPP
+#define SIFTER_BENCH_ALLOCATIONS_HPP
+
+#include <cstddef>
+#include <benchmark/benchmark.h>
+
+namespace bench
+{
+    /*
+     * Number of global operator new calls since the program start.
+     */
+    std::size_t allocations();
+
+    /*
+     * Reports average number of allocations per iteration as "allocs"
+     * counter of the benchmark.
+     */
+    class allocation_counter
+    {
+    public:
+        explicit allocation_counter(benchmark::State &state)
+            : m_state(state),
+              m_start(allocations())
+        {
+        }
+
+        ~allocation_counter()
+        {
+            m_state.counters["allocs"] = benchmark::Counter(
+                    static_cast<double>(allocations() - m_start),
+                    benchmark::Counter::kAvgIterations);
+        }
+
+    private:
+        benchmark::State &m_state;
+        std::size_t m_start;
+    };
+}
+
+#endif //SIFTER_BENCH_ALLOCATIONS_HPP
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Typical request handler, compiled by compile_bench with and without
+ * extern filter templates.
+ */
+
+#include <sstream>
+#include "types.hpp"
+
+std::string handler(int max_id, const std::string &pattern)
+{
+    using namespace app;
+
+    filter f = condition(id) < max_id &&
+               (condition(name) % pattern || condition(age) == 20);
+    f |= condition(age) > max_id;
+
+    filter copy(f);
+    copy &= ~f;
+
+    std::ostringstream out;
+    out << sifter::out<sifter::default_dumper, field, int, std::string>(copy);
+    return copy == f ? std::string() : out.str();
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cstdlib>
+#include <string>
+#include <benchmark/benchmark.h>
+
+namespace
+{
+    /*
+     * Compiles the handler with the same compiler and standard as the
+     * library, with optimization level of the first argument and with
+     * extern filter templates if the second one is set. Object file is
+     * discarded.
+     */
+    void compile(benchmark::State &state)
+    {
+        const bool extern_templates = state.range(1) != 0;
+        const std::string command =
+                std::string(SIFTER_COMPILE_COMMAND) +
+                " -O" + std::to_string(state.range(0)) +
+                (extern_templates ? " -DSIFTER_COMPILE_BENCH_EXTERN" : "") +
+                " -c " + SIFTER_COMPILE_SOURCE + " -o " +
+                SIFTER_COMPILE_OUTPUT;
+        state.SetLabel(extern_templates ? "extern" : "implicit");
+
+        for (auto _ : state)
+        {
+            if (std::system(command.c_str()) != 0)
+            {
+                state.SkipWithError("compilation failed");
+                break;
+            }
+        }
+    }
+}
+
+BENCHMARK(compile)->ArgsProduct({{0, 2}, {0, 1}})
+        ->Iterations(3)->Unit(benchmark::kMillisecond)->UseRealTime();
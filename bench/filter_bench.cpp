@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <sifter/cost.hpp>
+#include <sifter/evaluate.hpp>
+#include <sifter/filter_batch.hpp>
+#include <sifter/incremental.hpp>
+#include <sifter/profile.hpp>
+#include "allocations.hpp"
+#include "shapes.hpp"
+
+namespace
+{
+    bench::shape shape_arg(benchmark::State &state)
+    {
+        const auto s = static_cast<bench::shape>(state.range(0));
+        state.SetLabel(bench::shape_name(s));
+        return s;
+    }
+
+    void build(benchmark::State &state)
+    {
+        const bench::shape s = shape_arg(state);
+        const auto conditions = bench::make_conditions(state.range(1));
+
+        bench::allocation_counter counter(state);
+        for (auto _ : state)
+        {
+            bench::filter f = bench::make_filter(s, conditions);
+            benchmark::DoNotOptimize(f);
+        }
+    }
+
+    void copy(benchmark::State &state)
+    {
+        const bench::filter f = bench::make_filter(shape_arg(state),
+                                                   state.range(1));
+
+        bench::allocation_counter counter(state);
+        for (auto _ : state)
+        {
+            bench::filter c(f);
+            benchmark::DoNotOptimize(c);
+        }
+    }
+
+    void move(benchmark::State &state)
+    {
+        bench::filter f = bench::make_filter(shape_arg(state), state.range(1));
+
+        bench::allocation_counter counter(state);
+        for (auto _ : state)
+        {
+            bench::filter m(std::move(f));
+            f = std::move(m);
+            benchmark::DoNotOptimize(f);
+        }
+    }
+
+    void compare(benchmark::State &state)
+    {
+        const bench::shape s = shape_arg(state);
+        const bench::filter f0 = bench::make_filter(s, state.range(1));
+        const bench::filter f1 = bench::make_filter(s, state.range(1));
+
+        bench::allocation_counter counter(state);
+        for (auto _ : state)
+            benchmark::DoNotOptimize(f0 == f1);
+    }
+
+    void evaluate(benchmark::State &state)
+    {
+        const bench::filter f = bench::make_filter(shape_arg(state),
+                                                   state.range(1));
+        const bench::person p = {100, "name 1 and some text", 30};
+        const bench::person_accessor accessor;
+
+        bench::allocation_counter counter(state);
+        for (auto _ : state)
+        {
+            const bool matches = sifter::evaluate<bench::field>(f, p, accessor);
+            benchmark::DoNotOptimize(matches);
+        }
+    }
+
+    void evaluate_ordered(benchmark::State &state)
+    {
+        const bench::filter f = sifter::order_by_cost(bench::make_filter(
+                shape_arg(state), state.range(1)));
+        const bench::person p = {100, "name 1 and some text", 30};
+        const bench::person_accessor accessor;
+
+        bench::allocation_counter counter(state);
+        for (auto _ : state)
+        {
+            const bool matches = sifter::evaluate<bench::field>(f, p, accessor);
+            benchmark::DoNotOptimize(matches);
+        }
+    }
+
+    void evaluate_profiled(benchmark::State &state)
+    {
+        const bench::filter f = bench::make_filter(shape_arg(state),
+                                                   state.range(1));
+        const bench::person p = {100, "name 1 and some text", 30};
+        const bench::person_accessor accessor;
+        sifter::evaluation_profile profile(f);
+
+        bench::allocation_counter counter(state);
+        for (auto _ : state)
+        {
+            const bool matches = sifter::evaluate<bench::field>(f, p, accessor,
+                                                                profile);
+            benchmark::DoNotOptimize(matches);
+        }
+    }
+
+    void incremental_update(benchmark::State &state)
+    {
+        const bench::filter f = bench::make_filter(shape_arg(state),
+                                                   state.range(1));
+        sifter::incremental_matcher<bench::field, bench::filter,
+                bench::person_accessor> matcher(f);
+        bench::person p = {100, "name 1 and some text", 30};
+        matcher.insert(0, p);
+
+        bench::allocation_counter counter(state);
+        for (auto _ : state)
+        {
+            p.age = p.age == 30 ? 0 : 30;
+            const sifter::match_event e = matcher.update(0, p, sql::age);
+            benchmark::DoNotOptimize(e);
+        }
+    }
+
+    /*
+     * Subscriber filters, built from the small pool of conditions.
+     */
+    std::vector<bench::filter> make_subscribers(std::size_t count)
+    {
+        const std::vector<bench::condition> pool = bench::make_conditions(48);
+
+        std::vector<bench::filter> out;
+        out.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            out.push_back(pool[i % 48] && (pool[i * 7 % 48] ||
+                                           pool[i * 13 % 48]));
+        }
+        return out;
+    }
+
+    void batch_naive(benchmark::State &state)
+    {
+        const std::vector<bench::filter> filters = make_subscribers(
+                static_cast<std::size_t>(state.range(0)));
+        const bench::person p = {10, "name 1 and some text", 30};
+        const bench::person_accessor accessor;
+
+        for (auto _ : state)
+        {
+            std::size_t matches = 0;
+            for (const bench::filter &f : filters)
+                matches += sifter::evaluate<bench::field>(f, p, accessor);
+            benchmark::DoNotOptimize(matches);
+        }
+    }
+
+    void batch_shared(benchmark::State &state)
+    {
+        const sifter::filter_batch<bench::field, bench::filter,
+                bench::person_accessor> batch(make_subscribers(
+                        static_cast<std::size_t>(state.range(0))));
+        const bench::person p = {10, "name 1 and some text", 30};
+
+        for (auto _ : state)
+        {
+            const sifter::bitmap matches = batch.match(p);
+            benchmark::DoNotOptimize(matches.words().data());
+        }
+    }
+
+    void evaluate_schema(benchmark::State &state)
+    {
+        const bench::filter f = bench::make_filter(shape_arg(state),
+                                                   state.range(1));
+        const auto bound = bench::person_schema::bind(f);
+        const bench::person p = {100, "name 1 and some text", 30};
+
+        bench::allocation_counter counter(state);
+        for (auto _ : state)
+        {
+            const bool matches = bound(p);
+            benchmark::DoNotOptimize(matches);
+        }
+    }
+}
+
+BENCHMARK(build)->Apply(bench::shapes);
+BENCHMARK(copy)->Apply(bench::shapes);
+BENCHMARK(move)->Apply(bench::shapes);
+BENCHMARK(compare)->Apply(bench::shapes);
+BENCHMARK(evaluate)->Apply(bench::shapes);
+BENCHMARK(evaluate_ordered)->Apply(bench::shapes);
+BENCHMARK(evaluate_profiled)->Apply(bench::shapes);
+BENCHMARK(evaluate_schema)->Apply(bench::shapes);
+BENCHMARK(incremental_update)->Apply(bench::shapes);
+BENCHMARK(batch_naive)->Arg(500)->Arg(5000);
+BENCHMARK(batch_shared)->Arg(500)->Arg(5000);
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <sifter/json.hpp>
+#include "allocations.hpp"
+#include "shapes.hpp"
+
+namespace
+{
+    struct field_map
+    {
+        bool operator()(const char *text, std::size_t size,
+                        bench::field &out) const
+        {
+            for (const auto &field : bench::sql_fields())
+            {
+                if (field.second.size() == size &&
+                    std::memcmp(field.second.data(), text, size) == 0)
+                {
+                    out = field.first;
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    struct field_names
+    {
+        const std::string &operator()(bench::field f) const
+        {
+            return bench::sql_fields().at(f);
+        }
+    };
+
+    std::string encode(const bench::filter &f)
+    {
+        std::string out;
+        sifter::encode_json<bench::field>(out, f, field_names());
+        return out;
+    }
+
+    /*
+     * Decoding allocations are the allocations of the copy benchmark: the
+     * nodes and long strings of the tree.
+     */
+    void json_decode(benchmark::State &state)
+    {
+        const auto s = static_cast<bench::shape>(state.range(0));
+        state.SetLabel(bench::shape_name(s));
+        const std::string text = encode(bench::make_filter(s, state.range(1)));
+
+        bench::allocation_counter counter(state);
+        for (auto _ : state)
+        {
+            const bench::filter f = sifter::decode_json<bench::field,
+                    bench::filter>(text, field_map());
+            benchmark::DoNotOptimize(f);
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                     text.size()));
+    }
+
+    void json_encode(benchmark::State &state)
+    {
+        const auto s = static_cast<bench::shape>(state.range(0));
+        state.SetLabel(bench::shape_name(s));
+        const bench::filter f = bench::make_filter(s, state.range(1));
+
+        std::string buffer;
+        bench::allocation_counter counter(state);
+        for (auto _ : state)
+        {
+            buffer.clear();
+            sifter::encode_json<bench::field>(buffer, f, field_names());
+            benchmark::DoNotOptimize(buffer);
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                     buffer.size()));
+    }
+}
+
+BENCHMARK(json_decode)->Apply(bench::shapes);
+BENCHMARK(json_encode)->Apply(bench::shapes);
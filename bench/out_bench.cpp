@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <sstream>
+#include <sifter/buffer_dumper.hpp>
+#include "allocations.hpp"
+#include "shapes.hpp"
+
+namespace
+{
+    using out = sifter::out<sifter::default_dumper, bench::field, int,
+            std::string>;
+
+    void dump(benchmark::State &state)
+    {
+        const auto s = static_cast<bench::shape>(state.range(0));
+        state.SetLabel(bench::shape_name(s));
+        const bench::filter f = bench::make_filter(s, state.range(1));
+
+        std::ostringstream stream;
+        bench::allocation_counter counter(state);
+        for (auto _ : state)
+        {
+            stream.str(std::string());
+            stream << out(f);
+            benchmark::DoNotOptimize(stream);
+        }
+    }
+
+    void dump_buffer(benchmark::State &state)
+    {
+        const auto s = static_cast<bench::shape>(state.range(0));
+        state.SetLabel(bench::shape_name(s));
+        const bench::filter f = bench::make_filter(s, state.range(1));
+
+        std::string buffer;
+        bench::allocation_counter counter(state);
+        for (auto _ : state)
+        {
+            buffer.clear();
+            sifter::dump(buffer, f);
+            benchmark::DoNotOptimize(buffer);
+        }
+    }
+
+    void sql_where(benchmark::State &state)
+    {
+        const auto s = static_cast<bench::shape>(state.range(0));
+        state.SetLabel(bench::shape_name(s));
+        const bench::filter f = bench::make_filter(s, state.range(1));
+
+        bench::allocation_counter counter(state);
+        for (auto _ : state)
+        {
+            std::string text = sql::where(f, bench::sql_fields());
+            benchmark::DoNotOptimize(text);
+        }
+    }
+}
+
+BENCHMARK(dump)->Apply(bench::shapes);
+BENCHMARK(dump_buffer)->Apply(bench::shapes);
+BENCHMARK(sql_where)->Apply(bench::shapes);
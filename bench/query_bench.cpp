@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <string>
+#include <vector>
+#include <sifter/query.hpp>
+#include "allocations.hpp"
+#include "shapes.hpp"
+
+#ifndef SIFTER_USE_BOOST_VARIANT
+#include <memory_resource>
+#endif
+
+namespace
+{
+    struct field_map
+    {
+        bool operator()(sifter::string_view text, bench::field &out) const
+        {
+            if (text == "id")
+                out = sql::id;
+            else if (text == "name")
+                out = sql::name;
+            else if (text == "age")
+                out = sql::age;
+            else
+                return false;
+            return true;
+        }
+    };
+
+    /*
+     * Typical listing requests with 1-5 conditions.
+     */
+    const std::vector<std::string> &queries()
+    {
+        static const std::vector<std::string> out =
+        {
+            "?age=gt:20",
+            "?name=like:John%25&age=lt:60",
+            "?id=ge:1000&id=lt:2000&or=name:like:A%25,name:like:B%25",
+            "?name=John+Smith&age=ge:18&age=le:65&id=ne:7",
+            "?or=age:lt:18,age:gt:65&name=nlike:test%25&id=gt:0"
+        };
+        return out;
+    }
+
+    void query_decode(benchmark::State &state)
+    {
+        const auto &texts = queries();
+        std::size_t i = 0;
+
+        bench::allocation_counter counter(state);
+        for (auto _ : state)
+        {
+            const bench::filter f = sifter::decode_query<bench::field,
+                    bench::filter>(texts[i++ % texts.size()], field_map());
+            benchmark::DoNotOptimize(f);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+#ifndef SIFTER_USE_BOOST_VARIANT
+    /*
+     * Nodes are placed into the stack arena, so decoding doesn't allocate.
+     */
+    void query_decode_arena(benchmark::State &state)
+    {
+        using pmr_filter = sifter::filter<bench::field, int,
+                std::pmr::string>;
+        const auto &texts = queries();
+        std::size_t i = 0;
+        char buffer[4096];
+
+        bench::allocation_counter counter(state);
+        for (auto _ : state)
+        {
+            std::pmr::monotonic_buffer_resource arena(
+                    buffer, sizeof(buffer), std::pmr::null_memory_resource());
+            const sifter::allocator_type a(&arena);
+            const pmr_filter f = sifter::decode_query<bench::field,
+                    pmr_filter>(texts[i++ % texts.size()], field_map(),
+                                sifter::query_values<pmr_filter>(a), a);
+            benchmark::DoNotOptimize(f);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+#endif
+}
+
+BENCHMARK(query_decode);
+#ifndef SIFTER_USE_BOOST_VARIANT
+BENCHMARK(query_decode_arena);
+#endif
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <sifter/registry.hpp>
+#include "shapes.hpp"
+
+namespace
+{
+    const int rules_count = 2000;
+
+    using rule = sifter::bound_filter<bench::person>;
+    using rule_map = std::map<int, std::shared_ptr<const rule>>;
+
+    void fill(rule_map &map)
+    {
+        for (int i = 0; i < rules_count; ++i)
+            map[i] = std::make_shared<const rule>(
+                    bench::person_schema::bind(bench::make_filter(
+                            bench::balanced, 16)));
+    }
+
+    /*
+     * Reloads all rules in the background, while the benchmark reads.
+     */
+    class reloader
+    {
+    public:
+        template <typename Reload>
+        reloader(bool enabled, Reload reload)
+            : m_stop(false)
+        {
+            if (enabled)
+            {
+                m_thread = std::thread([this, reload]()
+                {
+                    while (!m_stop)
+                        reload();
+                });
+            }
+        }
+
+        ~reloader()
+        {
+            m_stop = true;
+            if (m_thread.joinable())
+                m_thread.join();
+        }
+
+    private:
+        std::atomic<bool> m_stop;
+        std::thread m_thread;
+    };
+
+    void registry_read(benchmark::State &state)
+    {
+        sifter::registry<int, rule> registry;
+        registry.update(fill);
+        const bench::person p = {100, "name 1 and some text", 30};
+
+        reloader reload(state.range(0) != 0, [&registry]()
+        {
+            registry.update(fill);
+        });
+
+        int i = 0;
+        for (auto _ : state)
+        {
+            const auto snapshot = registry.read();
+            const bool matches = (*snapshot.find(i++ % rules_count))(p);
+            benchmark::DoNotOptimize(matches);
+        }
+        state.SetLabel(state.range(0) ? "reload" : "static");
+    }
+
+    void mutex_read(benchmark::State &state)
+    {
+        std::mutex mutex;
+        std::shared_ptr<const rule_map> rules;
+        {
+            std::shared_ptr<rule_map> map = std::make_shared<rule_map>();
+            fill(*map);
+            rules = map;
+        }
+        const bench::person p = {100, "name 1 and some text", 30};
+
+        reloader reload(state.range(0) != 0, [&mutex, &rules]()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::shared_ptr<rule_map> map = std::make_shared<rule_map>(*rules);
+            fill(*map);
+            rules = map;
+        });
+
+        int i = 0;
+        for (auto _ : state)
+        {
+            std::shared_ptr<const rule_map> snapshot;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                snapshot = rules;
+            }
+            const bool matches = (*snapshot->at(i++ % rules_count))(p);
+            benchmark::DoNotOptimize(matches);
+        }
+        state.SetLabel(state.range(0) ? "reload" : "static");
+    }
+}
+
+BENCHMARK(registry_read)->Arg(0)->Arg(1)->UseRealTime();
+BENCHMARK(mutex_read)->Arg(0)->Arg(1)->UseRealTime();
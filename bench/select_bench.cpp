@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <thread>
+#include <vector>
+#include <sifter/schema.hpp>
+#include <sifter/select.hpp>
+#include <sifter/view.hpp>
+#include "shapes.hpp"
+
+namespace
+{
+    const std::size_t persons_count = 1 << 22;
+
+    const std::vector<bench::person> &persons()
+    {
+        static const std::vector<bench::person> out = [] {
+            std::vector<bench::person> persons;
+            persons.reserve(persons_count);
+            for (std::size_t i = 0; i < persons_count; ++i)
+            {
+                const int n = static_cast<int>(i * 2654435761u % 1000);
+                persons.push_back({n, "name " + std::to_string(n), n % 100});
+            }
+            return persons;
+        }();
+        return out;
+    }
+
+    bench::filter select_filter()
+    {
+        return bench::condition(sql::id) < 500 &&
+               (bench::condition(sql::name) % "name 1%" ||
+                bench::condition(sql::age) > 90);
+    }
+
+    void threads(benchmark::internal::Benchmark *b)
+    {
+        const int max = static_cast<int>(sifter::thread_pool::default_size());
+        for (int n = 1; n < max; n *= 2)
+            b->Arg(n);
+        b->Arg(max);
+        b->UseRealTime();
+    }
+
+    void select_evaluate(benchmark::State &state)
+    {
+        const auto &range = persons();
+        const bench::filter f = select_filter();
+        sifter::thread_pool pool(static_cast<std::size_t>(state.range(0)));
+
+        for (auto _ : state)
+        {
+            const auto indices = sifter::select<bench::field>(
+                    range, f, bench::person_accessor(), pool);
+            benchmark::DoNotOptimize(indices.data());
+        }
+        state.SetItemsProcessed(state.iterations() * range.size());
+    }
+
+    void select_schema(benchmark::State &state)
+    {
+        const auto &range = persons();
+        const auto bound = bench::person_schema::bind(select_filter());
+        sifter::thread_pool pool(static_cast<std::size_t>(state.range(0)));
+
+        for (auto _ : state)
+        {
+            const auto indices = sifter::select_if(range, bound, pool);
+            benchmark::DoNotOptimize(indices.data());
+        }
+        state.SetItemsProcessed(state.iterations() * range.size());
+    }
+
+    void select_limit(benchmark::State &state)
+    {
+        const auto &range = persons();
+        const auto bound = bench::person_schema::bind(select_filter());
+        sifter::thread_pool pool(static_cast<std::size_t>(state.range(0)));
+
+        for (auto _ : state)
+        {
+            const auto indices = sifter::select_if(range, bound, pool, 100);
+            benchmark::DoNotOptimize(indices.data());
+        }
+    }
+
+    void loop(benchmark::State &state)
+    {
+        const auto &range = persons();
+        const auto bound = bench::person_schema::bind(select_filter());
+
+        for (auto _ : state)
+        {
+            std::size_t count = 0;
+            for (const auto &p : range)
+            {
+                if (bound(p))
+                    ++count;
+            }
+            benchmark::DoNotOptimize(count);
+        }
+        state.SetItemsProcessed(state.iterations() * range.size());
+    }
+
+    void where_view(benchmark::State &state)
+    {
+        const auto &range = persons();
+        const auto bound = bench::person_schema::bind(select_filter());
+
+        for (auto _ : state)
+        {
+            std::size_t count = 0;
+            for (const auto &p : range | sifter::where_if(bound))
+            {
+                benchmark::DoNotOptimize(p);
+                ++count;
+            }
+            benchmark::DoNotOptimize(count);
+        }
+        state.SetItemsProcessed(state.iterations() * range.size());
+    }
+}
+
+BENCHMARK(loop);
+BENCHMARK(where_view);
+BENCHMARK(select_evaluate)->Apply(threads);
+BENCHMARK(select_schema)->Apply(threads);
+BENCHMARK(select_limit)->Apply(threads);
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_BENCH_SHAPES_HPP
+#define SIFTER_BENCH_SHAPES_HPP
+
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <sifter/schema.hpp>
+#include <sql/sql.hpp>
+
+namespace bench
+{
+    using field = sql::field;
+    using condition = sql::condition;
+    using filter = sql::filter;
+
+    enum shape
+    {
+        left_deep,
+        balanced,
+        wide_or
+    };
+
+    struct person
+    {
+        int id;
+        std::string name;
+        int age;
+    };
+
+    struct person_accessor
+    {
+        condition::value_type operator()(const person &p, field f) const
+        {
+            switch (f)
+            {
+                case sql::id:
+                    return p.id;
+                case sql::name:
+                    return p.name;
+                case sql::age:
+                    return p.age;
+            }
+            return condition::value_type();
+        }
+    };
+
+    using person_schema = sifter::schema<person,
+            SIFTER_FIELD(sql::id, &person::id),
+            SIFTER_FIELD(sql::name, &person::name),
+            SIFTER_FIELD(sql::age, &person::age)>;
+
+    inline condition make_condition(int i)
+    {
+        switch (i % 3)
+        {
+            case 0:
+                return condition(sql::id) < i;
+            case 1:
+                return condition(sql::name) %
+                       ("name " + std::to_string(i) + "%");
+            default:
+                return condition(sql::age) > i;
+        }
+    }
+
+    inline std::vector<condition> make_conditions(int n)
+    {
+        std::vector<condition> out;
+        for (int i = 0; i < n; ++i)
+            out.push_back(make_condition(i));
+        return out;
+    }
+
+    inline filter make_balanced(const std::vector<condition> &conditions,
+                                std::size_t begin, std::size_t end,
+                                bool conjunction)
+    {
+        if (end - begin == 1)
+            return filter(conditions[begin]);
+
+        const std::size_t middle = begin + (end - begin) / 2;
+        filter lhs = make_balanced(conditions, begin, middle, !conjunction);
+        filter rhs = make_balanced(conditions, middle, end, !conjunction);
+        return conjunction ? lhs && rhs : lhs || rhs;
+    }
+
+    /*
+     * Builds filter of the given shape from the conditions.
+     */
+    inline filter make_filter(shape s, const std::vector<condition> &conditions)
+    {
+        if (s == balanced)
+            return make_balanced(conditions, 0, conditions.size(), true);
+
+        filter f(conditions[0]);
+        for (std::size_t i = 1; i < conditions.size(); ++i)
+        {
+            if (s == left_deep)
+                f &= conditions[i];
+            else
+                f |= conditions[i];
+        }
+        return f;
+    }
+
+    inline filter make_filter(shape s, int n)
+    {
+        return make_filter(s, make_conditions(n));
+    }
+
+    inline const char *shape_name(shape s)
+    {
+        switch (s)
+        {
+            case left_deep:
+                return "left_deep";
+            case balanced:
+                return "balanced";
+            case wide_or:
+                return "wide_or";
+        }
+        return "";
+    }
+
+    /*
+     * Filter shapes and sizes, used as benchmark arguments.
+     */
+    inline void shapes(benchmark::internal::Benchmark *b)
+    {
+        b->ArgsProduct({{left_deep, balanced, wide_or}, {4, 16, 64, 256}});
+    }
+
+    inline const sql::fieldmap &sql_fields()
+    {
+        static const sql::fieldmap fields =
+        {
+            {sql::id, "id"},
+            {sql::name, "name"},
+            {sql::age, "age"}
+        };
+        return fields;
+    }
+}
+
+#endif //SIFTER_BENCH_SHAPES_HPP
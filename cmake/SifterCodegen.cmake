@@ -0,0 +1,56 @@
+# Copyright (c) 2021 Sergei Fundaev
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+# Generates header with inline predicates from filters, written by
+# default_dumper, e.g.
+#
+# sifter_generate_filters(${CMAKE_CURRENT_BINARY_DIR}/rules.hpp
+#         SCHEMA person.schema
+#         FILTERS rules.filters)
+#
+# The header should be listed in the sources of the target, which uses it.
+function(sifter_generate_filters OUTPUT)
+    cmake_parse_arguments(ARG "" "SCHEMA;FILTERS" "" ${ARGN})
+
+    if (NOT ARG_SCHEMA OR NOT ARG_FILTERS)
+        message(FATAL_ERROR "sifter_generate_filters: SCHEMA and FILTERS are required")
+    endif()
+
+    get_filename_component(schema ${ARG_SCHEMA} ABSOLUTE)
+    get_filename_component(filters ${ARG_FILTERS} ABSOLUTE)
+
+    if (TARGET sifter_codegen)
+        set(codegen $<TARGET_FILE:sifter_codegen>)
+        set(codegen_target sifter_codegen)
+    else()
+        find_program(SIFTER_CODEGEN_EXECUTABLE sifter_codegen)
+        if (NOT SIFTER_CODEGEN_EXECUTABLE)
+            message(FATAL_ERROR "sifter_generate_filters: sifter_codegen is not found")
+        endif()
+        set(codegen ${SIFTER_CODEGEN_EXECUTABLE})
+        set(codegen_target)
+    endif()
+
+    add_custom_command(OUTPUT ${OUTPUT}
+            COMMAND ${codegen} ${schema} ${filters} ${OUTPUT}
+            DEPENDS ${codegen_target} ${schema} ${filters}
+            COMMENT "Generating filters ${OUTPUT}"
+            VERBATIM)
+endfunction()
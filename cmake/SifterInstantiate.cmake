@@ -0,0 +1,54 @@
+# Copyright (c) 2021 Sergei Fundaev
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+# Instantiates filter types once in the target instead of every translation
+# unit, which includes the filter, e.g.
+#
+# sifter_instantiate_filters(
+#         TARGET sifter
+#         HEADER ${CMAKE_CURRENT_SOURCE_DIR}/include/fields.hpp
+#         TYPES app::field int std::string)
+#
+# TARGET is sifter by default. HEADER should declare the operand types and
+# SIFTER_EXTERN_FILTER for them, see sifter/instantiate.hpp.
+function(sifter_instantiate_filters)
+    cmake_parse_arguments(ARG "" "TARGET;HEADER" "TYPES" ${ARGN})
+
+    if (NOT ARG_HEADER OR NOT ARG_TYPES)
+        message(FATAL_ERROR "sifter_instantiate_filters: HEADER and TYPES are required")
+    endif()
+
+    if (NOT ARG_TARGET)
+        set(ARG_TARGET sifter)
+    endif()
+
+    get_filename_component(header ${ARG_HEADER} ABSOLUTE)
+    string(REPLACE ";" ", " types "${ARG_TYPES}")
+    string(MAKE_C_IDENTIFIER "${ARG_TARGET}_${types}" name)
+    set(output ${CMAKE_CURRENT_BINARY_DIR}/sifter_instantiate_${name}.cpp)
+
+    file(WRITE ${output}.in
+            "#include \"${header}\"\n"
+            "#include <sifter/instantiate.hpp>\n"
+            "\n"
+            "SIFTER_INSTANTIATE_FILTER(${types})\n")
+    configure_file(${output}.in ${output} COPYONLY)
+    target_sources(${ARG_TARGET} PRIVATE ${output})
+endfunction()
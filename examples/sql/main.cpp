@@ -20,213 +20,42 @@
  * IN THE SOFTWARE.
  */
 
+#include <iostream>
 #include <map>
 #include <string>
-#include <iostream>
-#include <sifter/filter.hpp>
+#include <vector>
+#include <sifter/schema.hpp>
+#include "sql.hpp"
 
-namespace sql
+struct person
 {
-    class query
-    {
-    public:
-        explicit query(const std::string &sql)
-                : m_sql(sql)
-        {
-        }
-
-        const std::string& sql() const
-        {
-            return m_sql;
-        }
-
-        std::string bound_sql() const
-        {
-            std::string sql = m_sql;
-            for (const auto p : m_int_values)
-                replace(sql, p.first, std::to_string(p.second));
-
-            for (const auto p : m_string_values)
-                replace(sql, p.first, "'" + p.second + "'");
-
-            return sql;
-        }
-
-        void bind(const std::string &placeholder, int value)
-        {
-            m_int_values[placeholder] = value;
-        }
-
-        void bind(const std::string &placeholder, const std::string &value)
-        {
-            m_string_values[placeholder] = value;
-        }
-
-    private:
-        void replace(std::string &target, const std::string &placeholder,
-                     const std::string &value) const
-        {
-            const std::size_t pos = target.find(placeholder);
-            if (pos != std::string::npos)
-                target.replace(pos, placeholder.size(), value);
-        }
-
-    private:
-        std::string m_sql;
-        std::map<std::string, int> m_int_values;
-        std::map<std::string, std::string> m_string_values;
-    };
-
-    enum field
-    {
-        id,
-        name,
-        age
-    };
-
-    using filter = sifter::filter<field, int, std::string>;
-    using condition = sifter::condition<field, int, std::string>;
-    using fieldmap = std::map<field, std::string>;
-
-    void
-    bind(query &q, const condition::value_type &v, const std::string &prefix)
-    {
-        const std::string placeholder = ":" + prefix + "v";
-#ifdef SIFTER_USE_BOOST_VARIANT
-        if (boost::variant2::holds_alternative<int>(v))
-            q.bind(placeholder, boost::variant2::get<int>(v));
-        else if (boost::variant2::holds_alternative<std::string>(v))
-            q.bind(placeholder, boost::variant2::get<std::string>(v));
-#else
-        if (std::holds_alternative<int>(v))
-            q.bind(placeholder, std::get<int>(v));
-        else if (std::holds_alternative<std::string>(v))
-            q.bind(placeholder, std::get<std::string>(v));
-#endif
-    }
-
-    void
-    bind(query &q, const filter::condition_type &c, const std::string &prefix)
-    {
-        bind(q, c.lhs(), prefix + "l");
-        bind(q, c.rhs(), prefix + "r");
-    }
-
-    void bind(query &q, const filter &f, const std::string &prefix = "")
-    {
-        if (f.left_is_condition())
-            bind(q, f.left_condition(), prefix + "l");
-        else if (f.left_is_filter())
-            bind(q, f.left_filter(), prefix + "l");
-
-        if (f.right_is_condition())
-            bind(q, f.right_condition(), prefix + "r");
-        else if (f.right_is_filter())
-            bind(q, f.right_filter(), prefix + "r");
-    }
-
-    std::string dump(sifter::comparison c)
-    {
-        std::string out;
-        switch (c)
-        {
-            case sifter::eq:
-                out = " = ";
-                break;
-            case sifter::ne:
-                out = " <> ";
-                break;
-            case sifter::lt:
-                out = " < ";
-                break;
-            case sifter::le:
-                out = " <= ";
-                break;
-            case sifter::gt:
-                out = " > ";
-                break;
-            case sifter::ge:
-                out = " >= ";
-                break;
-            case sifter::like:
-                out = " like ";
-                break;
-        }
-        return out;
-    }
-
-    std::string dump(sifter::operation o)
-    {
-        std::string out;
-        switch (o)
-        {
-            case sifter::operation::_and:
-                out = " and ";
-                break;
-            case sifter::operation::_or:
-                out = " or ";
-                break;
-            default:
-                break;
-        }
-        return out;
-    }
-
-    std::string dump(const condition::value_type &v, const std::string &prefix,
-                     const fieldmap &sql_fields)
-    {
-#ifdef SIFTER_USE_BOOST_VARIANT
-        if (boost::variant2::holds_alternative<field>(v))
-        {
-            const auto p = sql_fields.find(boost::variant2::get<field>(v));
-            return p->second;
-        }
-#else
-        if (std::holds_alternative<field>(v))
-        {
-            const auto p = sql_fields.find(std::get<field>(v));
-            return p->second;
-        }
-#endif
-        return ":" + prefix + "v";
-    }
+    int id;
+    std::string name;
+    int age;
+};
 
-    std::string dump(const filter::condition_type &c, const std::string &prefix,
-                     const fieldmap &sql_fields)
-    {
-        return dump(c.lhs(), prefix + "l", sql_fields) + dump(c.comp()) +
-               dump(c.rhs(), prefix + "r", sql_fields);
-    }
-
-    std::string
-    dump(const filter &f, const std::string &prefix, const fieldmap &sql_fields)
-    {
-        if (!f)
-            return "";
-
-        std::string out = "(";
-        if (f.left_is_condition())
-            out += dump(f.left_condition(), prefix + "l", sql_fields);
-        else if (f.left_is_filter())
-            out += dump(f.left_filter(), prefix + "l", sql_fields);
-
-        out += dump(f.oper());
-
-        if (f.right_is_condition())
-            out += dump(f.right_condition(), prefix + "r", sql_fields);
-        else if (f.right_is_filter())
-            out += dump(f.right_filter(), prefix + "r", sql_fields);
-
-        out += ")";
-        return out;
-    }
+/*
+ * Row of the batched statement in case_flags mode: person and match flag
+ * columns.
+ */
+struct flagged_row
+{
+    person value;
+    std::map<std::string, int> flags;
+};
 
-    std::string where(const filter &f, const fieldmap &sql_fields)
+struct flag_reader
+{
+    int operator()(const flagged_row &row, const std::string &column) const
     {
-        return " where " + dump(f, "", sql_fields);
+        return row.flags.at(column);
     }
-}
+};
 
+using person_schema = sifter::schema<person,
+        SIFTER_FIELD(sql::id, &person::id),
+        SIFTER_FIELD(sql::name, &person::name),
+        SIFTER_FIELD(sql::age, &person::age)>;
 
 int main(int, char**)
 {
@@ -247,6 +76,64 @@ int main(int, char**)
 
     std::cout << q.sql() << std::endl;
     std::cout << q.bound_sql() << std::endl;
+    std::cout << "select * from table" + sql::where(~f, sql_fields)
+              << std::endl;
+
+    const std::vector<person> persons =
+    {
+        {1, "John Smith", 18},
+        {2, "Jane Doe", 25},
+        {12, "Bob Brown", 40}
+    };
+
+    const auto matches = person_schema::bind(f);
+    for (const auto &p : persons)
+    {
+        if (matches(p))
+            std::cout << p.id << " " << p.name << std::endl;
+    }
+
+    const std::vector<sql::filter> page =
+    {
+        sql::filter(sql::condition(sql::age) >= 18),
+        sql::filter(sql::condition(sql::name) % "J%"),
+        sql::condition(sql::id) > 10 || sql::condition(sql::age) < 20
+    };
+
+    const sql::batch by_union(sql::batch_mode::union_all, "id, name, age",
+                              "person", page, sql_fields);
+    std::cout << by_union.statement().bound_sql() << std::endl;
+
+    const sql::batch by_flags(sql::batch_mode::case_flags, "id, name, age",
+                              "person", page, sql_fields);
+    std::cout << by_flags.statement().bound_sql() << std::endl;
+
+    /*
+     * Rows, which the database would return for the flags statement.
+     */
+    std::vector<flagged_row> rows;
+    for (const auto &p : persons)
+    {
+        flagged_row row = {p, {}};
+        bool any = false;
+        for (std::size_t i = 0; i < page.size(); ++i)
+        {
+            const bool flag = person_schema::bind(page[i])(p);
+            row.flags[by_flags.column(i)] = flag;
+            any = any || flag;
+        }
+        if (any)
+            rows.push_back(row);
+    }
+
+    const auto results = by_flags.demultiplex(rows, flag_reader());
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        std::cout << "filter " << i << ":";
+        for (const auto &row : results[i])
+            std::cout << " " << row.value.id;
+        std::cout << std::endl;
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,388 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_EXAMPLES_SQL_HPP
+#define SIFTER_EXAMPLES_SQL_HPP
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include <sifter/filter.hpp>
+
+namespace sql
+{
+    class query
+    {
+    public:
+        explicit query(const std::string &sql)
+                : m_sql(sql)
+        {
+        }
+
+        const std::string& sql() const
+        {
+            return m_sql;
+        }
+
+        std::string bound_sql() const
+        {
+            std::string sql = m_sql;
+            for (const auto &p : m_int_values)
+                replace(sql, p.first, std::to_string(p.second));
+
+            for (const auto &p : m_string_values)
+                replace(sql, p.first, "'" + p.second + "'");
+
+            return sql;
+        }
+
+        void bind(const std::string &placeholder, int value)
+        {
+            m_int_values[placeholder] = value;
+        }
+
+        void bind(const std::string &placeholder, const std::string &value)
+        {
+            m_string_values[placeholder] = value;
+        }
+
+    private:
+        void replace(std::string &target, const std::string &placeholder,
+                     const std::string &value) const
+        {
+            std::size_t pos = target.find(placeholder);
+            while (pos != std::string::npos)
+            {
+                target.replace(pos, placeholder.size(), value);
+                pos = target.find(placeholder, pos + value.size());
+            }
+        }
+
+    private:
+        std::string m_sql;
+        std::map<std::string, int> m_int_values;
+        std::map<std::string, std::string> m_string_values;
+    };
+
+    enum field
+    {
+        id,
+        name,
+        age
+    };
+
+    using filter = sifter::filter<field, int, std::string>;
+    using condition = sifter::condition<field, int, std::string>;
+    using fieldmap = std::map<field, std::string>;
+
+    inline void
+    bind(query &q, const condition::value_type &v, const std::string &prefix)
+    {
+        const std::string placeholder = ":" + prefix + "v";
+#ifdef SIFTER_USE_BOOST_VARIANT
+        if (boost::variant2::holds_alternative<int>(v))
+            q.bind(placeholder, boost::variant2::get<int>(v));
+        else if (boost::variant2::holds_alternative<std::string>(v))
+            q.bind(placeholder, boost::variant2::get<std::string>(v));
+#else
+        if (std::holds_alternative<int>(v))
+            q.bind(placeholder, std::get<int>(v));
+        else if (std::holds_alternative<std::string>(v))
+            q.bind(placeholder, std::get<std::string>(v));
+#endif
+    }
+
+    inline void
+    bind(query &q, const filter::condition_type &c, const std::string &prefix)
+    {
+        sql::bind(q, c.lhs(), prefix + "l");
+        sql::bind(q, c.rhs(), prefix + "r");
+    }
+
+    inline void
+    bind(query &q, const filter &f, const std::string &prefix = "")
+    {
+        if (f.left_is_condition())
+            sql::bind(q, f.left_condition(), prefix + "l");
+        else if (f.left_is_filter())
+            sql::bind(q, f.left_filter(), prefix + "l");
+
+        if (f.right_is_condition())
+            sql::bind(q, f.right_condition(), prefix + "r");
+        else if (f.right_is_filter())
+            sql::bind(q, f.right_filter(), prefix + "r");
+    }
+
+    inline std::string dump(sifter::comparison c)
+    {
+        std::string out;
+        switch (c)
+        {
+            case sifter::eq:
+                out = " = ";
+                break;
+            case sifter::ne:
+                out = " <> ";
+                break;
+            case sifter::lt:
+                out = " < ";
+                break;
+            case sifter::le:
+                out = " <= ";
+                break;
+            case sifter::gt:
+                out = " > ";
+                break;
+            case sifter::ge:
+                out = " >= ";
+                break;
+            case sifter::like:
+                out = " like ";
+                break;
+            case sifter::not_like:
+                out = " not like ";
+                break;
+        }
+        return out;
+    }
+
+    inline std::string dump(sifter::operation o)
+    {
+        std::string out;
+        switch (o)
+        {
+            case sifter::operation::_and:
+                out = " and ";
+                break;
+            case sifter::operation::_or:
+                out = " or ";
+                break;
+            default:
+                break;
+        }
+        return out;
+    }
+
+    inline std::string
+    dump(const condition::value_type &v, const std::string &prefix,
+         const fieldmap &sql_fields)
+    {
+#ifdef SIFTER_USE_BOOST_VARIANT
+        if (boost::variant2::holds_alternative<field>(v))
+        {
+            const auto p = sql_fields.find(boost::variant2::get<field>(v));
+            return p->second;
+        }
+#else
+        if (std::holds_alternative<field>(v))
+        {
+            const auto p = sql_fields.find(std::get<field>(v));
+            return p->second;
+        }
+#endif
+        return ":" + prefix + "v";
+    }
+
+    inline std::string
+    dump(const filter::condition_type &c, const std::string &prefix,
+         const fieldmap &sql_fields)
+    {
+        return dump(c.lhs(), prefix + "l", sql_fields) + dump(c.comp()) +
+               dump(c.rhs(), prefix + "r", sql_fields);
+    }
+
+    inline std::string
+    dump(const filter &f, const std::string &prefix, const fieldmap &sql_fields)
+    {
+        if (!f)
+            return "";
+
+        std::string out = "(";
+        if (f.left_is_condition())
+            out += dump(f.left_condition(), prefix + "l", sql_fields);
+        else if (f.left_is_filter())
+            out += dump(f.left_filter(), prefix + "l", sql_fields);
+
+        out += dump(f.oper());
+
+        if (f.right_is_condition())
+            out += dump(f.right_condition(), prefix + "r", sql_fields);
+        else if (f.right_is_filter())
+            out += dump(f.right_filter(), prefix + "r", sql_fields);
+
+        out += ")";
+        return out;
+    }
+
+    inline std::string where(const filter &f, const fieldmap &sql_fields)
+    {
+        return " where " + dump(f, "", sql_fields);
+    }
+
+    /*
+     * Ways to answer several filters by one statement: union of per-filter
+     * selects with the filter number column, or single scan with the
+     * match flag column per filter.
+     */
+    enum class batch_mode
+    {
+        union_all,
+        case_flags
+    };
+
+    /*
+     * Statement, answering several filters against the same table in one
+     * round trip. Placeholders of i-th filter are prefixed by "q<i>", so
+     * values of all filters are bound to the same query.
+     */
+    class batch
+    {
+    public:
+        batch(batch_mode mode, const std::string &columns,
+              const std::string &table, const std::vector<filter> &filters,
+              const fieldmap &sql_fields)
+                : m_mode(mode),
+                  m_size(filters.size()),
+                  m_query(statement(mode, columns, table, filters,
+                                    sql_fields))
+        {
+            for (std::size_t i = 0; i < filters.size(); ++i)
+                sql::bind(m_query, filters[i], prefix(i));
+        }
+
+        const query &statement() const
+        {
+            return m_query;
+        }
+
+        std::size_t size() const
+        {
+            return m_size;
+        }
+
+        /*
+         * Column with the filter number (union_all) or the flag of i-th
+         * filter (case_flags).
+         */
+        std::string column(std::size_t i) const
+        {
+            return m_mode == batch_mode::union_all
+                   ? "sifter_filter"
+                   : "sifter_f" + std::to_string(i);
+        }
+
+        /*
+         * Splits returned rows per filter, read(row, column) should return
+         * integer value of the column.
+         */
+        template <typename Row, typename Reader>
+        std::vector<std::vector<Row>> demultiplex(const std::vector<Row> &rows,
+                                                  Reader read) const
+        {
+            std::vector<std::vector<Row>> out(m_size);
+            if (m_mode == batch_mode::union_all)
+            {
+                const std::string filter_column = column(0);
+                for (const Row &row : rows)
+                {
+                    const auto i = static_cast<std::size_t>(
+                            read(row, filter_column));
+                    if (i < m_size)
+                        out[i].push_back(row);
+                }
+                return out;
+            }
+
+            std::vector<std::string> flag_columns;
+            flag_columns.reserve(m_size);
+            for (std::size_t i = 0; i < m_size; ++i)
+                flag_columns.push_back(column(i));
+
+            for (const Row &row : rows)
+            {
+                for (std::size_t i = 0; i < m_size; ++i)
+                {
+                    if (read(row, flag_columns[i]))
+                        out[i].push_back(row);
+                }
+            }
+            return out;
+        }
+
+    private:
+        static std::string prefix(std::size_t i)
+        {
+            return "q" + std::to_string(i);
+        }
+
+        static std::string predicate(const filter &f, std::size_t i,
+                                     const fieldmap &sql_fields)
+        {
+            return f ? dump(f, prefix(i), sql_fields) : "(1 = 1)";
+        }
+
+        std::string statement(batch_mode mode, const std::string &columns,
+                              const std::string &table,
+                              const std::vector<filter> &filters,
+                              const fieldmap &sql_fields) const
+        {
+            std::string out;
+            if (mode == batch_mode::union_all)
+            {
+                if (filters.empty())
+                    return "select 0 as " + column(0) + ", " + columns +
+                           " from " + table + " where 1 = 0";
+
+                for (std::size_t i = 0; i < filters.size(); ++i)
+                {
+                    if (i)
+                        out += " union all ";
+                    out += "select " + std::to_string(i) + " as " +
+                           column(0) + ", " + columns + " from " + table +
+                           " where " + predicate(filters[i], i, sql_fields);
+                }
+                return out;
+            }
+
+            std::string any;
+            out = "select " + columns;
+            for (std::size_t i = 0; i < filters.size(); ++i)
+            {
+                const std::string p = predicate(filters[i], i, sql_fields);
+                out += ", case when " + p + " then 1 else 0 end as " +
+                       column(i);
+                any += (i ? " or " : "") + p;
+            }
+            return out + " from " + table + " where " +
+                   (any.empty() ? "1 = 0" : any);
+        }
+
+    private:
+        batch_mode m_mode;
+        std::size_t m_size;
+        query m_query;
+    };
+}
+
+
+#endif //SIFTER_EXAMPLES_SQL_HPP
@@ -26,9 +26,16 @@
 #ifdef SIFTER_USE_BOOST_VARIANT
 #include <boost/variant2/variant.hpp>
 #else
+#include <cstddef>
+#include <memory_resource>
 #include <variant>
 #endif
+#include <cstdint>
 #include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "hooks.hpp"
 
 namespace sifter
 {
@@ -37,7 +44,7 @@ namespace sifter
     using variant = boost::variant2::variant<T...>;
 
     template <typename T, typename... V>
-    constexpr T& get(const variant<V...> &v)
+    constexpr const T& get(const variant<V...> &v)
     {
         return boost::variant2::get<T>(v);
     }
@@ -47,12 +54,36 @@ namespace sifter
     {
         return boost::variant2::get<T>(v);
     }
+
+    template <typename T, typename... V>
+    constexpr bool holds_alternative(const variant<V...> &v)
+    {
+        return boost::variant2::holds_alternative<T>(v);
+    }
+
+    template <typename Visitor, typename... V>
+    auto visit(Visitor &&visitor, const variant<V...> &v)
+            -> decltype(boost::variant2::visit(std::forward<Visitor>(visitor),
+                                               v))
+    {
+        return boost::variant2::visit(std::forward<Visitor>(visitor), v);
+    }
+
+    template <typename Visitor, typename... V>
+    auto visit(Visitor &&visitor, variant<V...> &v)
+            -> decltype(boost::variant2::visit(std::forward<Visitor>(visitor),
+                                               v))
+    {
+        return boost::variant2::visit(std::forward<Visitor>(visitor), v);
+    }
+
+    using allocator_type = std::allocator<char>;
 #else
     template <typename... T>
     using variant = std::variant<T...>;
 
     template <typename T, typename... V>
-    constexpr T& get(const variant<V...> &v)
+    constexpr const T& get(const variant<V...> &v)
     {
         return std::get<T>(v);
     }
@@ -62,8 +93,323 @@ namespace sifter
     {
         return std::get<T>(v);
     }
+
+    template <typename T, typename... V>
+    constexpr bool holds_alternative(const variant<V...> &v)
+    {
+        return std::holds_alternative<T>(v);
+    }
+
+    template <typename Visitor, typename... V>
+    auto visit(Visitor &&visitor, const variant<V...> &v)
+            -> decltype(std::visit(std::forward<Visitor>(visitor), v))
+    {
+        return std::visit(std::forward<Visitor>(visitor), v);
+    }
+
+    template <typename Visitor, typename... V>
+    auto visit(Visitor &&visitor, variant<V...> &v)
+            -> decltype(std::visit(std::forward<Visitor>(visitor), v))
+    {
+        return std::visit(std::forward<Visitor>(visitor), v);
+    }
+
+    /*
+     * Allocator of filter nodes. Filter, constructed with allocator, uses it
+     * for all its nodes and for operands of allocator-aware types
+     * (e.g. std::pmr::string).
+     */
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
 #endif
 
+    namespace detail
+    {
+        template <typename Value>
+        class operand_copier
+        {
+        public:
+            explicit operand_copier(const allocator_type &a)
+                : m_allocator(a)
+            {
+            }
+
+            template <typename T>
+            Value operator()(const T &v) const
+            {
+                return copy(v, std::uses_allocator<T, allocator_type>());
+            }
+
+            template <typename T>
+            Value operator()(T &v) const
+            {
+                return move(v, std::uses_allocator<T, allocator_type>());
+            }
+
+        private:
+            template <typename T>
+            Value copy(const T &v, std::true_type) const
+            {
+                return Value(T(v, m_allocator));
+            }
+
+            template <typename T>
+            Value copy(const T &v, std::false_type) const
+            {
+                return Value(v);
+            }
+
+            template <typename T>
+            Value move(T &v, std::true_type) const
+            {
+                return Value(T(std::move(v), m_allocator));
+            }
+
+            template <typename T>
+            Value move(T &v, std::false_type) const
+            {
+                return Value(std::move(v));
+            }
+
+        private:
+            const allocator_type &m_allocator;
+        };
+
+        /*
+         * Allocator of the operand of allocator-aware type (e.g.
+         * std::pmr::string), default allocator for other types.
+         */
+        class operand_allocator
+        {
+        public:
+            explicit operand_allocator(bool &found)
+                : m_found(found)
+            {
+            }
+
+            template <typename T>
+            allocator_type operator()(const T &v) const
+            {
+                return get(v, std::uses_allocator<T, allocator_type>());
+            }
+
+        private:
+            template <typename T>
+            allocator_type get(const T &v, std::true_type) const
+            {
+                m_found = true;
+                return allocator_type(v.get_allocator());
+            }
+
+            template <typename T>
+            allocator_type get(const T &, std::false_type) const
+            {
+                return allocator_type();
+            }
+
+        private:
+            bool &m_found;
+        };
+
+        /*
+         * Keeps allocator. Unlike the allocator itself (e.g.
+         * std::pmr::polymorphic_allocator) it is always assignable.
+         */
+        template <typename Allocator,
+                bool empty = std::is_empty<Allocator>::value>
+        class allocator_holder
+        {
+        public:
+            allocator_holder() = default;
+
+            explicit allocator_holder(const Allocator &a)
+                : m_allocator(a)
+            {
+            }
+
+            allocator_holder(const allocator_holder &h) = default;
+
+            allocator_holder &operator=(const allocator_holder &h)
+            {
+                if (this != &h)
+                {
+                    m_allocator.~Allocator();
+                    ::new (static_cast<void *>(&m_allocator))
+                            Allocator(h.m_allocator);
+                }
+                return *this;
+            }
+
+            const Allocator &get() const
+            {
+                return m_allocator;
+            }
+
+        private:
+            Allocator m_allocator;
+        };
+
+        template <typename Allocator>
+        class allocator_holder<Allocator, true>
+        {
+        public:
+            allocator_holder() = default;
+
+            explicit allocator_holder(const Allocator &)
+            {
+            }
+
+            Allocator get() const
+            {
+                return Allocator();
+            }
+        };
+
+        template <typename T>
+        using node_traits = typename std::allocator_traits<
+                allocator_type>::template rebind_traits<T>;
+
+        /*
+         * Owning pointer to the condition or nested filter of a node. Unlike
+         * std::unique_ptr it keeps no deleter: the node, which owns the
+         * pointer, releases the object by its own allocator, so the
+         * allocator is stored once per node.
+         */
+        template <typename T>
+        class node_pointer
+        {
+        public:
+            node_pointer() = default;
+
+            node_pointer(std::nullptr_t) noexcept
+            {
+            }
+
+            explicit node_pointer(T *p) noexcept
+                : m_pointer(p)
+            {
+            }
+
+            node_pointer(node_pointer &&p) noexcept
+                : m_pointer(p.release())
+            {
+            }
+
+            node_pointer(const node_pointer &) = delete;
+            node_pointer &operator=(const node_pointer &) = delete;
+            node_pointer &operator=(node_pointer &&) = delete;
+
+            T *get() const noexcept
+            {
+                return m_pointer;
+            }
+
+            T *release() noexcept
+            {
+                T *p = m_pointer;
+                m_pointer = nullptr;
+                return p;
+            }
+
+            void swap(node_pointer &p) noexcept
+            {
+                T *tmp = m_pointer;
+                m_pointer = p.m_pointer;
+                p.m_pointer = tmp;
+            }
+
+            T &operator*() const
+            {
+                return *m_pointer;
+            }
+
+            T *operator->() const noexcept
+            {
+                return m_pointer;
+            }
+
+            explicit operator bool() const noexcept
+            {
+                return m_pointer != nullptr;
+            }
+
+            friend bool operator==(const node_pointer &lhs,
+                                   const node_pointer &rhs) noexcept
+            {
+                return lhs.m_pointer == rhs.m_pointer;
+            }
+
+            friend bool operator!=(const node_pointer &lhs,
+                                   const node_pointer &rhs) noexcept
+            {
+                return lhs.m_pointer != rhs.m_pointer;
+            }
+
+        private:
+            T *m_pointer = nullptr;
+        };
+
+        /*
+         * Allocates object, passing allocator to its constructor as the last
+         * argument.
+         */
+        template <typename T, typename... Args>
+        node_pointer<T> allocate_node(const allocator_type &a, Args &&... args)
+        {
+            typename node_traits<T>::allocator_type alloc(a);
+
+            T *p = node_traits<T>::allocate(alloc, 1);
+            try
+            {
+                ::new (static_cast<void *>(p))
+                        T(std::forward<Args>(args)..., a);
+            }
+            catch (...)
+            {
+                node_traits<T>::deallocate(alloc, p, 1);
+                throw;
+            }
+
+            T::hooks_type::on_allocate(*p, sizeof(T));
+            return node_pointer<T>(p);
+        }
+
+        /*
+         * Destroys object of the pointer, allocated by allocate_node with
+         * the equal allocator.
+         */
+        template <typename T>
+        void deallocate_node(const allocator_type &a,
+                             node_pointer<T> &p) noexcept
+        {
+            T *object = p.release();
+            if (!object)
+                return;
+
+            typename node_traits<T>::allocator_type alloc(a);
+            T::hooks_type::on_deallocate(*object, sizeof(T));
+            object->~T();
+            node_traits<T>::deallocate(alloc, object, 1);
+        }
+
+        /*
+         * Move assignment of the nodes doesn't throw, if it never copies
+         * them to another allocator.
+         */
+        using nothrow_move_assignment = std::integral_constant<bool,
+                std::allocator_traits<allocator_type>::
+                        propagate_on_container_move_assignment::value ||
+                std::allocator_traits<allocator_type>::
+                        is_always_equal::value>;
+
+        template <typename T>
+        allocator_type copy_allocator(const T &object)
+        {
+            return std::allocator_traits<allocator_type>::
+                    select_on_container_copy_construction(
+                            object.get_allocator());
+        }
+    }
+
     enum class operation
     {
         _none,
@@ -84,6 +430,8 @@ namespace sifter
         using value_type = std::variant<Types...>;
 #endif
         using filter_type = basic_filter<Comparison, def_value, Types...>;
+        using allocator_type = sifter::allocator_type;
+        using hooks_type = filter_hooks<filter_type>;
 
     public:
         explicit basic_condition(const value_type &lhs = value_type(),
@@ -100,6 +448,7 @@ namespace sifter
                   m_rhs(c.m_rhs),
                   m_operator(c.m_operator)
         {
+            hooks_type::on_copy(*this);
         }
 
         basic_condition(basic_condition &&c) noexcept
@@ -107,6 +456,23 @@ namespace sifter
                   m_rhs(std::move(c.m_rhs)),
                   m_operator(c.m_operator)
         {
+            hooks_type::on_move(*this);
+        }
+
+        basic_condition(const basic_condition &c, const allocator_type &a)
+                : m_lhs(sifter::visit(copier_type(a), c.m_lhs)),
+                  m_rhs(sifter::visit(copier_type(a), c.m_rhs)),
+                  m_operator(c.m_operator)
+        {
+            hooks_type::on_copy(*this);
+        }
+
+        basic_condition(basic_condition &&c, const allocator_type &a)
+                : m_lhs(sifter::visit(copier_type(a), c.m_lhs)),
+                  m_rhs(sifter::visit(copier_type(a), c.m_rhs)),
+                  m_operator(c.m_operator)
+        {
+            hooks_type::on_move(*this);
         }
 
         const value_type &lhs() const
@@ -141,12 +507,14 @@ namespace sifter
 
         bool operator==(const basic_condition &c) const
         {
+            hooks_type::on_compare(*this, c);
             return (m_lhs == c.m_lhs && m_rhs == c.m_rhs &&
                     m_operator == c.m_operator);
         }
 
         bool operator!=(const basic_condition &c) const
         {
+            hooks_type::on_compare(*this, c);
             return (m_lhs != c.m_lhs || m_rhs != c.m_rhs ||
                     m_operator != c.m_operator);
         }
@@ -156,29 +524,58 @@ namespace sifter
             m_lhs = c.m_lhs;
             m_rhs = c.m_rhs;
             m_operator = c.m_operator;
+            hooks_type::on_copy(*this);
             return *this;
         }
 
+        /*
+         * Condition with complement comparison, found by
+         * complement(Comparison).
+         */
+        basic_condition operator~() const
+        {
+            return basic_condition(m_lhs, m_rhs, complement(m_operator));
+        }
+
+        /*
+         * Allocator of the first allocator-aware operand, right one is
+         * checked first, since left one is usually the field. Composition
+         * of conditions builds the filter with this allocator.
+         */
+        allocator_type get_allocator() const
+        {
+            bool found = false;
+            allocator_type a = sifter::visit(
+                    detail::operand_allocator(found), m_rhs);
+            if (found)
+                return a;
+
+            return sifter::visit(detail::operand_allocator(found), m_lhs);
+        }
+
         filter_type operator&&(const basic_condition &c) const
         {
-            return (filter_type(*this) && c);
+            return (filter_type(*this, get_allocator()) && c);
         }
 
         filter_type operator&&(const filter_type &f) const
         {
-            return (filter_type(*this) && f);
+            return (filter_type(*this, f.get_allocator()) && f);
         }
 
         filter_type operator||(const basic_condition &c) const
         {
-            return (filter_type(*this) || c);
+            return (filter_type(*this, get_allocator()) || c);
         }
 
         filter_type operator||(const filter_type &f) const
         {
-            return (filter_type(*this) || f);
+            return (filter_type(*this, f.get_allocator()) || f);
         }
 
+    private:
+        using copier_type = detail::operand_copier<value_type>;
+
     private:
         value_type m_lhs;
         value_type m_rhs;
@@ -194,32 +591,70 @@ namespace sifter
     public:
         using condition_type = basic_condition<Comparison, def_value, Types...>;
         using node_type = basic_node<Comparison, def_value, Types...>;
+        using allocator_type = sifter::allocator_type;
+        using hooks_type = filter_hooks<basic_filter>;
 
     public:
         basic_filter() = default;
 
+        explicit basic_filter(const allocator_type &a)
+                : m_lhs(a),
+                  m_rhs(a)
+        {
+        }
+
         basic_filter(const basic_filter &f)
-                : m_lhs(f.m_lhs),
-                  m_rhs(f.m_rhs),
+                : basic_filter(f, detail::copy_allocator(f))
+        {
+        }
+
+        basic_filter(const basic_filter &f, const allocator_type &a)
+                : m_lhs(f.m_lhs, a),
+                  m_rhs(f.m_rhs, a),
                   m_operator(f.m_operator)
         {
+            update();
+            hooks_type::on_copy(*this);
         }
 
         basic_filter(basic_filter &&f) noexcept
                 : m_lhs(std::move(f.m_lhs)),
                   m_rhs(std::move(f.m_rhs)),
-                  m_operator(f.m_operator)
+                  m_operator(f.m_operator),
+                  m_nodes(f.m_nodes),
+                  m_conditions(f.m_conditions),
+                  m_depth(f.m_depth)
         {
+            f.reset_counters();
+            hooks_type::on_move(*this);
         }
 
-        explicit basic_filter(const condition_type &c)
-                : m_lhs(c)
+        basic_filter(basic_filter &&f, const allocator_type &a)
+                : m_lhs(std::move(f.m_lhs), a),
+                  m_rhs(std::move(f.m_rhs), a),
+                  m_operator(f.m_operator),
+                  m_nodes(f.m_nodes),
+                  m_conditions(f.m_conditions),
+                  m_depth(f.m_depth)
         {
+            f.reset_counters();
+            hooks_type::on_move(*this);
         }
 
-        explicit basic_filter(condition_type &&c)
-                : m_lhs(c)
+        explicit basic_filter(const condition_type &c,
+                              const allocator_type &a = allocator_type())
+                : m_lhs(c, a),
+                  m_rhs(a)
         {
+            update();
+        }
+
+        explicit basic_filter(condition_type &&c,
+                              const allocator_type &a = allocator_type())
+                : m_lhs(std::move(c), a),
+                  m_rhs(a)
+        {
+            update();
         }
 
         basic_filter &operator=(const basic_filter &f)
@@ -227,14 +662,23 @@ namespace sifter
             m_lhs = f.m_lhs;
             m_rhs = f.m_rhs;
             m_operator = f.m_operator;
+            reset_counters();
+            hooks_type::on_copy(*this);
             return *this;
         }
 
-        basic_filter &operator=(basic_filter &&f) noexcept
+        basic_filter &operator=(basic_filter &&f)
+                noexcept(detail::nothrow_move_assignment::value)
         {
             m_lhs = std::move(f.m_lhs);
             m_rhs = std::move(f.m_rhs);
             m_operator = f.m_operator;
+            if (f.exposed())
+                expose();
+            else
+                reset_counters();
+            f.reset_counters();
+            hooks_type::on_move(*this);
             return *this;
         }
 
@@ -243,6 +687,8 @@ namespace sifter
             m_lhs = c;
             m_rhs.reset();
             m_operator = operation::_none;
+            reset_counters();
+            return *this;
         }
 
         basic_filter &operator=(condition_type &&c)
@@ -250,10 +696,18 @@ namespace sifter
             m_lhs = std::move(c);
             m_rhs.reset();
             m_operator = operation::_none;
+            reset_counters();
+            return *this;
+        }
+
+        allocator_type get_allocator() const
+        {
+            return m_lhs.get_allocator();
         }
 
         bool operator==(const basic_filter &f) const
         {
+            hooks_type::on_compare(*this, f);
             return (
                     m_lhs == f.m_lhs &&
                     m_rhs == f.m_rhs &&
@@ -263,6 +717,7 @@ namespace sifter
 
         bool operator!=(const basic_filter &f) const
         {
+            hooks_type::on_compare(*this, f);
             return (
                     m_lhs != f.m_lhs ||
                     m_rhs != f.m_rhs ||
@@ -273,10 +728,12 @@ namespace sifter
         basic_filter &operator&=(const condition_type &rhs)
         {
             if (m_operator != operation::_none)
-                m_lhs = std::move(basic_filter(*this));
+                m_lhs = std::move(make_node(*this));
 
             m_rhs = rhs;
             m_operator = operation::_and;
+            update();
+            hooks_type::on_compose(*this);
             return *this;
         }
 
@@ -290,24 +747,44 @@ namespace sifter
 
             m_rhs = std::move(make_node(rhs));
             m_operator = operation::_and;
+            update();
+            hooks_type::on_compose(*this);
             return *this;
         }
 
+        /*
+         * Composition with the temporary operand moves it into the new node
+         * instead of copying.
+         */
+        basic_filter &operator&=(condition_type &&rhs)
+        {
+            return compose(std::move(rhs), operation::_and);
+        }
+
+        basic_filter &operator&=(basic_filter &&rhs)
+        {
+            return compose(std::move(rhs), operation::_and);
+        }
+
         basic_filter operator&&(const condition_type &c)
         {
-            basic_filter out;
+            basic_filter out(get_allocator());
             out.m_lhs = std::move(make_node(*this));
             out.m_rhs = c;
             out.m_operator = operation::_and;
+            out.update();
+            hooks_type::on_compose(out);
             return out;
         }
 
         basic_filter operator&&(const basic_filter &f)
         {
-            basic_filter out;
+            basic_filter out(get_allocator());
             out.m_lhs = std::move(make_node(*this));
             out.m_rhs = std::move(make_node(f));
             out.m_operator = operation::_and;
+            out.update();
+            hooks_type::on_compose(out);
             return out;
         }
 
@@ -318,6 +795,8 @@ namespace sifter
 
             m_rhs = rhs;
             m_operator = operation::_or;
+            update();
+            hooks_type::on_compose(*this);
             return *this;
         }
 
@@ -331,24 +810,62 @@ namespace sifter
 
             m_rhs = std::move(make_node(rhs));
             m_operator = operation::_or;
+            update();
+            hooks_type::on_compose(*this);
             return *this;
         }
 
+        basic_filter &operator|=(condition_type &&rhs)
+        {
+            return compose(std::move(rhs), operation::_or);
+        }
+
+        basic_filter &operator|=(basic_filter &&rhs)
+        {
+            return compose(std::move(rhs), operation::_or);
+        }
+
         basic_filter operator||(const condition_type &c)
         {
-            basic_filter out;
+            basic_filter out(get_allocator());
             out.m_lhs = std::move(make_node(*this));
             out.m_rhs = c;
             out.m_operator = operation::_or;
+            out.update();
+            hooks_type::on_compose(out);
             return out;
         }
 
         basic_filter operator||(const basic_filter &f)
         {
-            basic_filter out;
+            basic_filter out(get_allocator());
             out.m_lhs = std::move(make_node(*this));
             out.m_rhs = std::move(make_node(f));
             out.m_operator = operation::_or;
+            out.update();
+            hooks_type::on_compose(out);
+            return out;
+        }
+
+        /*
+         * Negation, pushed down to conditions by De Morgan's laws: the
+         * result has complement comparisons and swapped operations, so it
+         * contains no negated subtrees. Empty filter matches any record and
+         * can't be negated.
+         */
+        basic_filter operator~() const
+        {
+            if (!*this)
+                throw std::domain_error("Empty filter can't be negated");
+
+            basic_filter out(get_allocator());
+            out.m_lhs = negate(m_lhs);
+            out.m_rhs = negate(m_rhs);
+            out.m_operator = m_operator == operation::_and ? operation::_or
+                    : m_operator == operation::_or ? operation::_and
+                    : operation::_none;
+            out.update();
+            hooks_type::on_compose(out);
             return out;
         }
 
@@ -392,8 +909,13 @@ namespace sifter
             return *m_lhs.filter;
         }
 
+        /*
+         * Nested filter, which may be changed by the caller. Counters of
+         * this filter are calculated by the walk of the tree since then.
+         */
         basic_filter &left_filter()
         {
+            expose();
             return *m_lhs.filter;
         }
 
@@ -414,6 +936,7 @@ namespace sifter
 
         basic_filter &right_filter()
         {
+            expose();
             return *m_rhs.filter;
         }
 
@@ -422,112 +945,360 @@ namespace sifter
             return m_operator;
         }
 
+        /*
+         * Number of filter nodes: this filter and all nested ones.
+         */
+        std::size_t nodes() const
+        {
+            if (!exposed())
+                return m_nodes;
+
+            return 1 + (left_is_filter() ? left_filter().nodes() : 0) +
+                   (right_is_filter() ? right_filter().nodes() : 0);
+        }
+
+        /*
+         * Number of conditions in the whole tree.
+         */
+        std::size_t conditions() const
+        {
+            if (!exposed())
+                return m_conditions;
+
+            return (left_is_filter() ? left_filter().conditions() : 0) +
+                   (right_is_filter() ? right_filter().conditions() : 0) +
+                   (left_is_condition() ? 1 : 0) +
+                   (right_is_condition() ? 1 : 0);
+        }
+
+        /*
+         * Number of levels of the tree: 0 for empty filter, 1 for the filter
+         * of conditions only. Counters are kept up to date by construction,
+         * assignment and composition of the filter, so they are O(1). Once
+         * a nested filter is returned by non-const accessor, it may be
+         * changed behind this filter, so the counters are calculated by the
+         * walk of the tree until the filter is assigned.
+         */
+        std::size_t depth() const
+        {
+            if (!exposed())
+                return m_depth;
+
+            if (!*this)
+                return 0;
+
+            const std::size_t lhs = left_is_filter() ? left_filter().depth()
+                                                     : 0;
+            const std::size_t rhs = right_is_filter() ? right_filter().depth()
+                                                      : 0;
+            return 1 + (lhs < rhs ? rhs : lhs);
+        }
+
     private:
+        /*
+         * Marks the filter, whose nested filters are exposed: they may be
+         * changed without update of this filter. Zero number of nodes is
+         * never counted, so it is used as the mark.
+         */
+        void expose() noexcept
+        {
+            m_nodes = 0;
+        }
+
+        bool exposed() const noexcept
+        {
+            return m_nodes == 0;
+        }
+
+        /*
+         * Recalculates counters from the direct children, unless the
+         * filter is exposed.
+         */
+        void update() noexcept
+        {
+            if (exposed())
+                return;
+
+            const basic_filter *lhs = m_lhs.filter.get();
+            const basic_filter *rhs = m_rhs.filter.get();
+            const std::size_t lhs_depth = lhs ? lhs->depth() : 0;
+            const std::size_t rhs_depth = rhs ? rhs->depth() : 0;
+
+            m_nodes = static_cast<std::uint32_t>(
+                    1 + (lhs ? lhs->nodes() : 0) + (rhs ? rhs->nodes() : 0));
+            m_conditions = static_cast<std::uint32_t>(
+                    (lhs ? lhs->conditions() : 0) +
+                    (rhs ? rhs->conditions() : 0) +
+                    (m_lhs.condition ? 1 : 0) +
+                    (m_rhs.condition ? 1 : 0));
+            m_depth = static_cast<std::uint32_t>(
+                    *this ? 1 + (lhs_depth < rhs_depth ? rhs_depth : lhs_depth)
+                          : 0);
+        }
+
+        /*
+         * Recalculates counters after the whole tree is replaced.
+         */
+        void reset_counters() noexcept
+        {
+            m_nodes = 1;
+            update();
+        }
+
+        node_type negate(const node_type &n) const
+        {
+            if (n.condition)
+                return node_type(~*n.condition, get_allocator());
+
+            if (n.filter)
+                return node_type(~*n.filter, get_allocator());
+
+            return node_type(get_allocator());
+        }
+
         node_type make_node(const basic_filter &f)
         {
             if (f.oper() != operation::_none)
-                return node_type(f);
+                return node_type(f, get_allocator());
+
+            if (f.left_is_filter())
+                return node_type(f.left_filter(), get_allocator());
+
+            return node_type(f.left_condition(), get_allocator());
+        }
+
+        node_type make_node(basic_filter &&f)
+        {
+            if (f.oper() != operation::_none)
+                return node_type(std::move(f), get_allocator());
 
+            /*
+             * Members are used instead of non-const accessors, which would
+             * expose f.
+             */
             if (f.left_is_filter())
-                return node_type(f.left_filter());
+                return node_type(std::move(*f.m_lhs.filter), get_allocator());
+
+            return node_type(std::move(*f.m_lhs.condition), get_allocator());
+        }
+
+        /*
+         * Composition with the temporary operand: both this filter and the
+         * operand are moved into the new nodes instead of copying.
+         */
+        basic_filter &compose(condition_type &&rhs, operation oper)
+        {
+            if (m_operator != operation::_none)
+                m_lhs = make_node(std::move(*this));
 
-            return node_type(f.left_condition());
+            m_rhs = std::move(rhs);
+            m_operator = oper;
+            update();
+            hooks_type::on_compose(*this);
+            return *this;
+        }
+
+        basic_filter &compose(basic_filter &&rhs, operation oper)
+        {
+            if (!rhs)
+                return *this;
+
+            if (m_operator != operation::_none)
+                m_lhs = make_node(std::move(*this));
+
+            m_rhs = make_node(std::move(rhs));
+            m_operator = oper;
+            update();
+            hooks_type::on_compose(*this);
+            return *this;
         }
 
     private:
         node_type m_lhs;
         node_type m_rhs;
         operation m_operator = operation::_none;
+        std::uint32_t m_nodes = 1;
+        std::uint32_t m_conditions = 0;
+        std::uint32_t m_depth = 0;
     };
 
 
+    /*
+     * Node of filter: condition or nested filter. Both are allocated with the
+     * allocator of the node, which releases them on destruction.
+     */
     template<typename Comparison, Comparison def_value, typename... Types>
-    struct basic_node
+    struct basic_node : private detail::allocator_holder<allocator_type>
     {
         using condition_type = basic_condition<Comparison, def_value, Types...>;
         using filter_type = basic_filter<Comparison, def_value, Types...>;
+        using allocator_type = sifter::allocator_type;
 
         basic_node() = default;
 
+        explicit basic_node(const allocator_type &a)
+                : holder_type(a)
+        {
+        }
+
         basic_node(const basic_node &n)
-                : condition(
-                n.condition ? new condition_type(*n.condition) : nullptr),
-                  filter(n.filter ? new filter_type(*n.filter) : nullptr)
+                : basic_node(n, detail::copy_allocator(n))
         {
         }
 
+        basic_node(const basic_node &n, const allocator_type &a)
+                : basic_node(a)
+        {
+            if (n.condition)
+                set(condition, make_condition(*n.condition));
+
+            if (n.filter)
+                set(filter, make_filter(*n.filter));
+        }
+
         basic_node(basic_node &&n) noexcept
-                : condition(std::move(n.condition)),
+                : holder_type(static_cast<const holder_type &>(n)),
+                  condition(std::move(n.condition)),
                   filter(std::move(n.filter))
         {
         }
 
-        explicit basic_node(const condition_type &c)
-                : condition(new condition_type(c))
+        basic_node(basic_node &&n, const allocator_type &a)
+                : basic_node(a)
+        {
+            if (n.get_allocator() == a)
+            {
+                condition.swap(n.condition);
+                filter.swap(n.filter);
+                return;
+            }
+
+            if (n.condition)
+                set(condition, make_condition(std::move(*n.condition)));
+
+            if (n.filter)
+                set(filter, make_filter(std::move(*n.filter)));
+        }
+
+        explicit basic_node(const condition_type &c,
+                            const allocator_type &a = allocator_type())
+                : basic_node(a)
+        {
+            set(condition, make_condition(c));
+        }
+
+        explicit basic_node(condition_type &&c,
+                            const allocator_type &a = allocator_type())
+                : basic_node(a)
+        {
+            set(condition, make_condition(std::move(c)));
+        }
+
+        explicit basic_node(const filter_type &f,
+                            const allocator_type &a = allocator_type())
+                : basic_node(a)
         {
+            set(filter, make_filter(f));
         }
 
-        explicit basic_node(condition_type &&c)
-                : condition(new condition_type(std::move(c)))
+        explicit basic_node(filter_type &&f,
+                            const allocator_type &a = allocator_type())
+                : basic_node(a)
         {
+            set(filter, make_filter(std::move(f)));
         }
 
-        explicit basic_node(const filter_type &f)
-                : filter(new filter_type(f))
+        ~basic_node()
         {
+            reset();
         }
 
-        explicit basic_node(filter_type &&f)
-                : filter(new filter_type(std::move(f)))
+        allocator_type get_allocator() const
         {
+            return this->get();
         }
 
-        void reset()
+        void reset() noexcept
         {
-            filter.reset(nullptr);
-            condition.reset(nullptr);
+            detail::deallocate_node(get_allocator(), filter);
+            detail::deallocate_node(get_allocator(), condition);
         }
 
         basic_node &operator=(const basic_node &n)
         {
-            filter.reset(n.filter ? new filter_type(*n.filter) : nullptr);
-            condition.reset(
-                    n.condition ? new condition_type(*n.condition) : nullptr);
+            if (this == &n)
+                return *this;
+
+            /*
+             * Both copies are made before this node is changed, so it is
+             * kept on exception.
+             */
+            detail::node_pointer<filter_type> f = n.filter
+                    ? make_filter(*n.filter) : nullptr;
+            try
+            {
+                set(condition, n.condition ? make_condition(*n.condition)
+                                           : nullptr);
+            }
+            catch (...)
+            {
+                detail::deallocate_node(get_allocator(), f);
+                throw;
+            }
+            set(filter, std::move(f));
             return *this;
         }
 
-        basic_node &operator=(basic_node &&n) noexcept
+        /*
+         * Doesn't throw, unless the allocators may differ and are not
+         * propagated: then the objects are copied by the allocator of this
+         * node.
+         */
+        basic_node &operator=(basic_node &&n)
+                noexcept(detail::nothrow_move_assignment::value)
         {
-            filter = std::move(n.filter);
-            condition = std::move(n.condition);
+            if (this == &n)
+                return *this;
+
+            using traits_type = std::allocator_traits<allocator_type>;
+            const bool propagate =
+                    traits_type::propagate_on_container_move_assignment::value;
+            if (!propagate && get_allocator() != n.get_allocator())
+                return *this = static_cast<const basic_node &>(n);
+
+            reset();
+            if (propagate)
+                static_cast<holder_type &>(*this) = n;
+            filter.swap(n.filter);
+            condition.swap(n.condition);
             return *this;
         }
 
         basic_node &operator=(const condition_type &c)
         {
-            filter.reset();
-            condition.reset(new condition_type(c));
+            set(condition, make_condition(c));
+            detail::deallocate_node(get_allocator(), filter);
             return *this;
         }
 
         basic_node &operator=(condition_type &&c)
         {
-            filter.reset();
-            condition.reset(new condition_type(std::move(c)));
+            set(condition, make_condition(std::move(c)));
+            detail::deallocate_node(get_allocator(), filter);
             return *this;
         }
 
         basic_node &operator=(const filter_type &f)
         {
-            condition.reset();
-            filter.reset(new filter_type(f));
+            set(filter, make_filter(f));
+            detail::deallocate_node(get_allocator(), condition);
             return *this;
         }
 
         basic_node &operator=(filter_type &&f)
         {
-            condition.reset();
-            filter.reset(new filter_type(std::move(f)));
+            set(filter, make_filter(std::move(f)));
+            detail::deallocate_node(get_allocator(), condition);
             return *this;
         }
 
@@ -555,8 +1326,36 @@ namespace sifter
             return (static_cast<bool>(condition) || static_cast<bool>(filter));
         }
 
-        std::unique_ptr<condition_type> condition;
-        std::unique_ptr<filter_type> filter;
+        detail::node_pointer<condition_type> condition;
+        detail::node_pointer<filter_type> filter;
+
+    private:
+        using holder_type = detail::allocator_holder<allocator_type>;
+
+        /*
+         * Replaces the object of the pointer, releasing the previous one.
+         */
+        template <typename T>
+        void set(detail::node_pointer<T> &target,
+                 detail::node_pointer<T> &&p) noexcept
+        {
+            target.swap(p);
+            detail::deallocate_node(get_allocator(), p);
+        }
+
+        template <typename C>
+        detail::node_pointer<condition_type> make_condition(C &&c) const
+        {
+            return detail::allocate_node<condition_type>(get_allocator(),
+                                                         std::forward<C>(c));
+        }
+
+        template <typename F>
+        detail::node_pointer<filter_type> make_filter(F &&f) const
+        {
+            return detail::allocate_node<filter_type>(get_allocator(),
+                                                      std::forward<F>(f));
+        }
     };
 
 }
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_BITMAP_HPP
+#define SIFTER_BITMAP_HPP
+
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sifter
+{
+    /*
+     * Fixed-size set of bits, used as selection vector by batch evaluators.
+     */
+    class bitmap
+    {
+    public:
+        using word_type = std::uint64_t;
+        static const std::size_t word_bits = 64;
+
+    public:
+        explicit bitmap(std::size_t size = 0, bool value = false)
+            : m_words((size + word_bits - 1) / word_bits,
+                      value ? ~word_type(0) : word_type(0)),
+              m_size(size)
+        {
+            trim();
+        }
+
+        std::size_t size() const
+        {
+            return m_size;
+        }
+
+        bool test(std::size_t pos) const
+        {
+            return (m_words[pos / word_bits] >> (pos % word_bits)) & 1u;
+        }
+
+        void set(std::size_t pos, bool value = true)
+        {
+            const word_type mask = word_type(1) << (pos % word_bits);
+            if (value)
+                m_words[pos / word_bits] |= mask;
+            else
+                m_words[pos / word_bits] &= ~mask;
+        }
+
+        void reset(std::size_t pos)
+        {
+            set(pos, false);
+        }
+
+        /*
+         * Clears all bits, keeping the size and the storage.
+         */
+        void reset()
+        {
+            std::fill(m_words.begin(), m_words.end(), word_type(0));
+        }
+
+        std::size_t count() const
+        {
+            std::size_t out = 0;
+            for (const word_type w : m_words)
+                out += std::bitset<word_bits>(w).count();
+            return out;
+        }
+
+        bool any() const
+        {
+            for (const word_type w : m_words)
+            {
+                if (w)
+                    return true;
+            }
+            return false;
+        }
+
+        bool none() const
+        {
+            return !any();
+        }
+
+        bool all() const
+        {
+            return count() == m_size;
+        }
+
+        bitmap &flip()
+        {
+            for (word_type &w : m_words)
+                w = ~w;
+            trim();
+            return *this;
+        }
+
+        bitmap &operator&=(const bitmap &b)
+        {
+            for (std::size_t i = 0; i < m_words.size(); ++i)
+                m_words[i] &= b.m_words[i];
+            return *this;
+        }
+
+        bitmap &operator|=(const bitmap &b)
+        {
+            for (std::size_t i = 0; i < m_words.size(); ++i)
+                m_words[i] |= b.m_words[i];
+            return *this;
+        }
+
+        bool operator==(const bitmap &b) const
+        {
+            return m_size == b.m_size && m_words == b.m_words;
+        }
+
+        bool operator!=(const bitmap &b) const
+        {
+            return !(*this == b);
+        }
+
+        const std::vector<word_type> &words() const
+        {
+            return m_words;
+        }
+
+        std::vector<word_type> &words()
+        {
+            return m_words;
+        }
+
+        /*
+         * Position of the lowest set bit of non-zero word.
+         */
+        static std::size_t lowest_bit(word_type w)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<std::size_t>(__builtin_ctzll(w));
+#else
+            std::size_t out = 0;
+            while (!(w & 1u))
+            {
+                w >>= 1;
+                ++out;
+            }
+            return out;
+#endif
+        }
+
+        /*
+         * Calls f(pos) for each set bit in ascending order.
+         */
+        template <typename F>
+        void for_each(F f) const
+        {
+            for (std::size_t i = 0; i < m_words.size(); ++i)
+            {
+                word_type w = m_words[i];
+                while (w)
+                {
+                    f(i * word_bits + lowest_bit(w));
+                    w &= w - 1;
+                }
+            }
+        }
+
+    private:
+        void trim()
+        {
+            const std::size_t tail = m_size % word_bits;
+            if (tail && !m_words.empty())
+                m_words.back() &= (word_type(1) << tail) - 1;
+        }
+
+    private:
+        std::vector<word_type> m_words;
+        std::size_t m_size;
+    };
+}
+
+#endif //SIFTER_BITMAP_HPP
@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_BUFFER_DUMPER_HPP
+#define SIFTER_BUFFER_DUMPER_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "ostream.hpp"
+
+#if defined(__has_include) && __cplusplus >= 201703L
+#if __has_include(<charconv>)
+#include <charconv>
+#define SIFTER_HAS_CHARCONV
+#endif
+#endif
+
+namespace sifter
+{
+    namespace detail
+    {
+        /*
+         * Checks if there is non-member operator<< for the type. Unscoped
+         * enumerations without it are written by std::ostream as integers.
+         */
+        template <typename T, typename = void>
+        struct has_stream_operator : std::false_type
+        {
+        };
+
+        template <typename T>
+        struct has_stream_operator<T, decltype(static_cast<void>(operator<<(
+                std::declval<std::ostream &>(), std::declval<const T &>())))>
+                : std::true_type
+        {
+        };
+
+        /*
+         * Maximal length of text representation of an integer or floating
+         * point value.
+         */
+        const std::size_t integer_size = 32;
+        const std::size_t floating_size = 64;
+
+        template <typename T>
+        char *format_integer(char *text, T value)
+        {
+#ifdef SIFTER_HAS_CHARCONV
+            return std::to_chars(text, text + integer_size, value).ptr;
+#else
+            const int size = std::is_signed<T>::value
+                    ? std::snprintf(text, integer_size, "%lld",
+                                    static_cast<long long>(value))
+                    : std::snprintf(text, integer_size, "%llu",
+                                    static_cast<unsigned long long>(value));
+            return text + size;
+#endif
+        }
+
+        template <typename T>
+        char *format_floating(char *text, T value)
+        {
+#if defined(SIFTER_HAS_CHARCONV) && defined(__cpp_lib_to_chars)
+            return std::to_chars(text, text + floating_size, value,
+                                 std::chars_format::general, 6).ptr;
+#else
+            const int size = std::snprintf(text, floating_size, "%.6Lg",
+                                           static_cast<long double>(value));
+            return text + size;
+#endif
+        }
+
+        struct stream_tag
+        {
+        };
+
+        struct integer_tag
+        {
+        };
+
+        struct floating_tag
+        {
+        };
+
+        template <typename T>
+        using append_tag = typename std::conditional<
+                std::is_floating_point<T>::value,
+                floating_tag,
+                typename std::conditional<
+                        std::is_integral<T>::value ||
+                        (std::is_enum<T>::value &&
+                         std::is_convertible<T, long long>::value &&
+                         !has_stream_operator<T>::value),
+                        integer_tag,
+                        stream_tag>::type>::type;
+    }
+
+    /*
+     * Dumper, writing directly into the string buffer. Its output is the
+     * same as one of default_dumper, but it avoids std::ostream overhead.
+     * Text is collected in a small local chunk and appended to the buffer
+     * when the chunk is full, on flush() and on destruction.
+     */
+    class buffer_dumper
+    {
+    public:
+        explicit buffer_dumper(std::string &buffer);
+
+        buffer_dumper(const buffer_dumper &) = delete;
+
+        buffer_dumper &operator=(const buffer_dumper &) = delete;
+
+        ~buffer_dumper()
+        {
+            flush();
+        }
+
+        void flush()
+        {
+            m_buffer.append(m_chunk, m_used);
+            m_used = 0;
+        }
+
+        template <typename T>
+        void operator()(const T &value)
+        {
+            append(value, detail::append_tag<T>());
+        }
+
+        void operator()(const std::string &value)
+        {
+            write(value.data(), value.size());
+        }
+
+        void operator()(const char *value)
+        {
+            write(value, std::strlen(value));
+        }
+
+        void operator()(char value)
+        {
+            put(value);
+        }
+
+        void operator()(signed char value)
+        {
+            put(static_cast<char>(value));
+        }
+
+        void operator()(unsigned char value)
+        {
+            put(static_cast<char>(value));
+        }
+
+        void operator()(bool value)
+        {
+            put(value ? '1' : '0');
+        }
+
+        void operator()(special value)
+        {
+            (*this)(token(value));
+        }
+
+        void operator()(operation value)
+        {
+            (*this)(token(value));
+        }
+
+        void operator()(comparison value)
+        {
+            (*this)(token(value));
+        }
+
+    private:
+        static const std::size_t chunk_size = 256;
+
+        char *reserve(std::size_t size)
+        {
+            if (m_used + size > chunk_size)
+                flush();
+            return m_chunk + m_used;
+        }
+
+        void commit(const char *end)
+        {
+            m_used = static_cast<std::size_t>(end - m_chunk);
+        }
+
+        void put(char c)
+        {
+            *reserve(1) = c;
+            ++m_used;
+        }
+
+        void write(const char *text, std::size_t size)
+        {
+            if (size > chunk_size)
+            {
+                flush();
+                m_buffer.append(text, size);
+                return;
+            }
+            std::memcpy(reserve(size), text, size);
+            m_used += size;
+        }
+
+        template <typename T>
+        void append(const T &value, detail::integer_tag)
+        {
+            commit(detail::format_integer(reserve(detail::integer_size),
+                                          +value));
+        }
+
+        template <typename T>
+        void append(const T &value, detail::floating_tag)
+        {
+            commit(detail::format_floating(reserve(detail::floating_size),
+                                           value));
+        }
+
+        template <typename T>
+        void append(const T &value, detail::stream_tag)
+        {
+            std::ostringstream out;
+            out << value;
+            const std::string text = out.str();
+            write(text.data(), text.size());
+        }
+
+        std::string &m_buffer;
+        char m_chunk[chunk_size];
+        std::size_t m_used;
+    };
+
+    /*
+     * Appends text representation of the filter or condition to the buffer.
+     */
+    template <typename Comparison, Comparison def_value, typename... Types>
+    void dump(std::string &buffer,
+              const basic_filter<Comparison, def_value, Types...> &f)
+    {
+        buffer_dumper dumper(buffer);
+        basic_out<buffer_dumper, Comparison, def_value, Types...>(f)
+                .write(dumper);
+    }
+
+    template <typename Comparison, Comparison def_value, typename... Types>
+    void dump(std::string &buffer,
+              const basic_condition<Comparison, def_value, Types...> &c)
+    {
+        buffer_dumper dumper(buffer);
+        basic_out<buffer_dumper, Comparison, def_value, Types...>(c)
+                .write(dumper);
+    }
+}
+
+#endif //SIFTER_BUFFER_DUMPER_HPP
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_COST_HPP
+#define SIFTER_COST_HPP
+
+#include <string>
+#include <type_traits>
+#include "filter.hpp"
+
+namespace sifter
+{
+    namespace detail
+    {
+        struct is_string_visitor
+        {
+            template <typename T>
+            bool operator()(const T &) const
+            {
+                return std::is_same<T, std::string>::value;
+            }
+        };
+    }
+
+    /*
+     * Relative cost of the condition evaluation: "like" and "not like"
+     * are the most expensive, string comparison is more expensive than
+     * comparison of the other values.
+     */
+    struct default_cost
+    {
+        template <comparison def_value, typename... Types>
+        double operator()(
+                const basic_condition<comparison, def_value, Types...> &c)
+                const
+        {
+            const bool strings =
+                    sifter::visit(detail::is_string_visitor(), c.lhs()) ||
+                    sifter::visit(detail::is_string_visitor(), c.rhs());
+
+            if (c.comp() == like || c.comp() == not_like)
+                return 8.0;
+
+            return strings ? 2.0 : 1.0;
+        }
+    };
+
+    namespace detail
+    {
+        template <typename Filter, typename Cost>
+        class cost_orderer
+        {
+        public:
+            using condition_type = typename Filter::condition_type;
+
+        public:
+            explicit cost_orderer(const Cost &cost)
+                : m_cost(cost)
+            {
+            }
+
+            /*
+             * Returns reordered copy of the filter and its cost: the cost
+             * of all conditions, which is the worst case of evaluation.
+             */
+            Filter operator()(const Filter &f, double &cost) const
+            {
+                const bool has_lhs = f.left_is_filter() ||
+                                     f.left_is_condition();
+                const bool has_rhs = f.right_is_filter() ||
+                                     f.right_is_condition();
+
+                cost = 0.0;
+                if (!has_lhs && !has_rhs)
+                    return Filter(f.get_allocator());
+
+                if (!has_lhs)
+                    return right(f, cost);
+
+                if (!has_rhs || f.oper() == operation::_none)
+                    return left(f, cost);
+
+                double lhs_cost = 0.0;
+                double rhs_cost = 0.0;
+                Filter lhs = left(f, lhs_cost);
+                Filter rhs = right(f, rhs_cost);
+                cost = lhs_cost + rhs_cost;
+
+                if (rhs_cost < lhs_cost)
+                    swap(lhs, rhs);
+
+                append(lhs, f.oper(), rhs);
+                return lhs;
+            }
+
+        private:
+            Filter left(const Filter &f, double &cost) const
+            {
+                if (f.left_is_filter())
+                    return (*this)(f.left_filter(), cost);
+
+                cost = m_cost(f.left_condition());
+                return Filter(f.left_condition(), f.get_allocator());
+            }
+
+            Filter right(const Filter &f, double &cost) const
+            {
+                if (f.right_is_filter())
+                    return (*this)(f.right_filter(), cost);
+
+                cost = m_cost(f.right_condition());
+                return Filter(f.right_condition(), f.get_allocator());
+            }
+
+            static void swap(Filter &lhs, Filter &rhs)
+            {
+                Filter tmp(std::move(lhs));
+                lhs = std::move(rhs);
+                rhs = std::move(tmp);
+            }
+
+            /*
+             * Single condition is appended as is, without wrapping filter.
+             */
+            static void append(Filter &out, operation oper, const Filter &f)
+            {
+                const bool single = f.left_is_condition() &&
+                                    !f.right_is_filter() &&
+                                    !f.right_is_condition();
+
+                if (oper == operation::_and)
+                {
+                    if (single)
+                        out &= f.left_condition();
+                    else
+                        out &= f;
+                }
+                else
+                {
+                    if (single)
+                        out |= f.left_condition();
+                    else
+                        out |= f;
+                }
+            }
+
+            const Cost &m_cost;
+        };
+    }
+
+    /*
+     * Returns copy of the filter, where operands of each AND and OR are
+     * ordered by ascending cost, so short-circuit evaluation tries cheap
+     * conditions first. Result of the evaluation is not changed.
+     */
+    template <typename Comparison, Comparison def_value, typename... Types,
+            typename Cost>
+    basic_filter<Comparison, def_value, Types...> order_by_cost(
+            const basic_filter<Comparison, def_value, Types...> &f,
+            const Cost &cost)
+    {
+        double total = 0.0;
+        return detail::cost_orderer<basic_filter<Comparison, def_value,
+                Types...>, Cost>(cost)(f, total);
+    }
+
+    template <typename Comparison, Comparison def_value, typename... Types>
+    basic_filter<Comparison, def_value, Types...> order_by_cost(
+            const basic_filter<Comparison, def_value, Types...> &f)
+    {
+        return order_by_cost(f, default_cost());
+    }
+}
+
+#endif //SIFTER_COST_HPP
@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_DICTIONARY_HPP
+#define SIFTER_DICTIONARY_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "bitmap.hpp"
+#include "evaluate.hpp"
+
+namespace sifter
+{
+    /*
+     * Dictionary-encoded column: each row keeps the code of its value in the
+     * dictionary of distinct values.
+     */
+    template <typename Value>
+    class dictionary_column
+    {
+    public:
+        using value_type = Value;
+        using code_type = std::uint32_t;
+
+    public:
+        dictionary_column() = default;
+
+        dictionary_column(const std::vector<value_type> &dictionary,
+                          const std::vector<code_type> &codes)
+            : m_dictionary(dictionary),
+              m_codes(codes)
+        {
+            for (std::size_t i = 0; i < m_dictionary.size(); ++i)
+                m_index.emplace(m_dictionary[i], static_cast<code_type>(i));
+        }
+
+        code_type push_back(const value_type &value)
+        {
+            auto p = m_index.find(value);
+            if (p == m_index.end())
+            {
+                const auto code = static_cast<code_type>(m_dictionary.size());
+                p = m_index.emplace(value, code).first;
+                m_dictionary.push_back(value);
+            }
+
+            m_codes.push_back(p->second);
+            return p->second;
+        }
+
+        std::size_t size() const
+        {
+            return m_codes.size();
+        }
+
+        const value_type &operator[](std::size_t row) const
+        {
+            return m_dictionary[m_codes[row]];
+        }
+
+        const std::vector<value_type> &dictionary() const
+        {
+            return m_dictionary;
+        }
+
+        const std::vector<code_type> &codes() const
+        {
+            return m_codes;
+        }
+
+    private:
+        std::vector<value_type> m_dictionary;
+        std::vector<code_type> m_codes;
+        std::map<value_type, code_type> m_index;
+    };
+
+    namespace detail
+    {
+        template <typename Field, typename Columns, comparison def_value,
+                typename... Types>
+        class dictionary_scan
+        {
+        public:
+            using filter_type = basic_filter<comparison, def_value, Types...>;
+            using condition_type =
+                    basic_condition<comparison, def_value, Types...>;
+            using value_type = typename condition_type::value_type;
+            using column_type = dictionary_column<value_type>;
+            using code_type = typename column_type::code_type;
+
+        public:
+            dictionary_scan(const Columns &columns, std::size_t rows)
+                : m_columns(columns),
+                  m_rows(rows)
+            {
+            }
+
+            bitmap scan(const condition_type &c) const
+            {
+                const bool lhs_field =
+                        sifter::holds_alternative<Field>(c.lhs());
+                const bool rhs_field =
+                        sifter::holds_alternative<Field>(c.rhs());
+
+                if (!lhs_field && !rhs_field)
+                    return bitmap(m_rows, compare(c.comp(), c.lhs(), c.rhs()));
+
+                if (lhs_field && rhs_field)
+                    return scan_rows(c);
+
+                const column_type &column = m_columns(sifter::get<Field>(
+                        lhs_field ? c.lhs() : c.rhs()));
+                const std::vector<value_type> &dictionary = column.dictionary();
+
+                std::vector<unsigned char> table(dictionary.size());
+                for (std::size_t i = 0; i < dictionary.size(); ++i)
+                {
+                    table[i] = lhs_field
+                            ? compare(c.comp(), dictionary[i], c.rhs())
+                            : compare(c.comp(), c.lhs(), dictionary[i]);
+                }
+
+                return gather(column.codes(), table);
+            }
+
+            bitmap scan(const filter_type &f) const
+            {
+                const bool has_lhs =
+                        f.left_is_filter() || f.left_is_condition();
+                const bool has_rhs =
+                        f.right_is_filter() || f.right_is_condition();
+
+                if (!has_lhs && !has_rhs)
+                    return bitmap(m_rows, true);
+
+                if (!has_lhs)
+                    return scan_right(f);
+
+                bitmap out = f.left_is_filter() ? scan(f.left_filter())
+                                                : scan(f.left_condition());
+
+                if (!has_rhs || f.oper() == operation::_none)
+                    return out;
+
+                if (f.oper() == operation::_and)
+                {
+                    if (out.any())
+                        out &= scan_right(f);
+                }
+                else if (!out.all())
+                {
+                    out |= scan_right(f);
+                }
+
+                return out;
+            }
+
+        private:
+            bitmap scan_right(const filter_type &f) const
+            {
+                return f.right_is_filter() ? scan(f.right_filter())
+                                           : scan(f.right_condition());
+            }
+
+            bitmap scan_rows(const condition_type &c) const
+            {
+                const column_type &lhs = m_columns(sifter::get<Field>(c.lhs()));
+                const column_type &rhs = m_columns(sifter::get<Field>(c.rhs()));
+
+                bitmap out(m_rows);
+                for (std::size_t i = 0; i < m_rows; ++i)
+                    out.set(i, compare(c.comp(), lhs[i], rhs[i]));
+                return out;
+            }
+
+            bitmap gather(const std::vector<code_type> &codes,
+                          const std::vector<unsigned char> &table) const
+            {
+                bitmap out(m_rows);
+                std::vector<bitmap::word_type> &words = out.words();
+
+                for (std::size_t w = 0; w < words.size(); ++w)
+                {
+                    const std::size_t begin = w * bitmap::word_bits;
+                    const std::size_t end =
+                            std::min(begin + bitmap::word_bits, m_rows);
+
+                    bitmap::word_type word = 0;
+                    for (std::size_t i = begin; i < end; ++i)
+                    {
+                        word |= static_cast<bitmap::word_type>(
+                                table[codes[i]]) << (i - begin);
+                    }
+                    words[w] = word;
+                }
+
+                return out;
+            }
+
+        private:
+            const Columns &m_columns;
+            std::size_t m_rows;
+        };
+    }
+
+    /*
+     * Evaluates filter over the batch of dictionary-encoded columns and
+     * returns bitmap of matching rows. Each condition, comparing field with
+     * literal value, is evaluated once per dictionary entry; rows are then
+     * selected by their codes.
+     *
+     * columns(field) should return dictionary_column of the condition value
+     * type, containing at least rows elements.
+     */
+    template <typename Field, typename Columns, comparison def_value,
+            typename... Types>
+    bitmap evaluate_dictionary(
+            const basic_filter<comparison, def_value, Types...> &f,
+            const Columns &columns, std::size_t rows)
+    {
+        return detail::dictionary_scan<Field, Columns, def_value, Types...>(
+                columns, rows).scan(f);
+    }
+
+    template <typename Field, typename Columns, comparison def_value,
+            typename... Types>
+    bitmap evaluate_dictionary(
+            const basic_condition<comparison, def_value, Types...> &c,
+            const Columns &columns, std::size_t rows)
+    {
+        return detail::dictionary_scan<Field, Columns, def_value, Types...>(
+                columns, rows).scan(c);
+    }
+}
+
+#endif //SIFTER_DICTIONARY_HPP
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_EVALUATE_HPP
+#define SIFTER_EVALUATE_HPP
+
+#include <cstddef>
+#include <string>
+#include "filter.hpp"
+
+namespace sifter
+{
+    /*
+     * Matches text against SQL-like pattern: '%' matches any sequence of
+     * characters, '_' matches any single character.
+     */
+    bool like_match(const char *text, std::size_t text_size,
+                    const char *pattern, std::size_t pattern_size);
+
+    inline bool like_match(const std::string &text, const std::string &pattern)
+    {
+        return like_match(text.data(), text.size(),
+                          pattern.data(), pattern.size());
+    }
+
+    /*
+     * Convert members, compared by the generated code, to the types of the
+     * literals. Unlike static_cast, the call hides the range of the member
+     * type from the compiler, so comparisons with the limits of long long
+     * don't produce warnings.
+     */
+    template <typename T>
+    constexpr long long as_integer(T value)
+    {
+        return static_cast<long long>(value);
+    }
+
+    template <typename T>
+    constexpr double as_floating(T value)
+    {
+        return static_cast<double>(value);
+    }
+
+    namespace detail
+    {
+        template <typename T>
+        bool compare_ordered(comparison c, const T &lhs, const T &rhs)
+        {
+            switch (c)
+            {
+                case eq:
+                    return lhs == rhs;
+                case ne:
+                    return !(lhs == rhs);
+                case lt:
+                    return lhs < rhs;
+                case le:
+                    return !(rhs < lhs);
+                case gt:
+                    return rhs < lhs;
+                case ge:
+                    return !(lhs < rhs);
+                case like:
+                    break;
+                case not_like:
+                    return true;
+            }
+            return false;
+        }
+
+        template <typename T>
+        bool compare_values(comparison c, const T &lhs, const T &rhs)
+        {
+            return compare_ordered(c, lhs, rhs);
+        }
+
+        inline bool compare_values(comparison c, const std::string &lhs,
+                                   const std::string &rhs)
+        {
+            if (c == like)
+                return like_match(lhs, rhs);
+
+            if (c == not_like)
+                return !like_match(lhs, rhs);
+
+            return compare_ordered(c, lhs, rhs);
+        }
+
+        template <typename Value>
+        class value_comparer
+        {
+        public:
+            value_comparer(comparison c, const Value &rhs)
+                : m_comp(c),
+                  m_rhs(rhs)
+            {
+            }
+
+            template <typename T>
+            bool operator()(const T &lhs) const
+            {
+                return compare_values(m_comp, lhs, sifter::get<T>(m_rhs));
+            }
+
+        private:
+            comparison m_comp;
+            const Value &m_rhs;
+        };
+
+        template <typename Field, typename Record, typename Accessor,
+                typename Value>
+        const Value &resolve(const Value &operand, const Record &record,
+                             const Accessor &accessor, Value &buffer)
+        {
+            if (!sifter::holds_alternative<Field>(operand))
+                return operand;
+
+            buffer = accessor(record, sifter::get<Field>(operand));
+            return buffer;
+        }
+    }
+
+    /*
+     * Compares two values. Values holding different alternatives are
+     * considered as not equal and not ordered, "like" is applicable to
+     * strings only, "not like" is its negation.
+     */
+    template <typename... Types>
+    bool compare(comparison c, const variant<Types...> &lhs,
+                 const variant<Types...> &rhs)
+    {
+        if (lhs.index() != rhs.index())
+            return c == ne || c == not_like;
+
+        return sifter::visit(
+                detail::value_comparer<variant<Types...>>(c, rhs), lhs);
+    }
+
+    /*
+     * Evaluates condition against the record. Operands, holding value of
+     * Field type, are replaced by accessor(record, field) result, which
+     * should be convertible to the condition value type.
+     */
+    template <typename Field, typename Record, typename Accessor,
+            comparison def_value, typename... Types>
+    bool evaluate(const basic_condition<comparison, def_value, Types...> &c,
+                  const Record &record, const Accessor &accessor)
+    {
+        using value_type = typename basic_condition<comparison, def_value,
+                Types...>::value_type;
+
+        value_type lhs_buffer;
+        value_type rhs_buffer;
+        return compare(
+                c.comp(),
+                detail::resolve<Field>(c.lhs(), record, accessor, lhs_buffer),
+                detail::resolve<Field>(c.rhs(), record, accessor, rhs_buffer));
+    }
+
+    /*
+     * Evaluates filter against the record. Empty filter matches any record.
+     */
+    template <typename Field, typename Record, typename Accessor,
+            comparison def_value, typename... Types>
+    bool evaluate(const basic_filter<comparison, def_value, Types...> &f,
+                  const Record &record, const Accessor &accessor)
+    {
+        const bool has_lhs = f.left_is_filter() || f.left_is_condition();
+        const bool has_rhs = f.right_is_filter() || f.right_is_condition();
+
+        if (has_lhs)
+        {
+            const bool lhs = f.left_is_filter()
+                    ? evaluate<Field>(f.left_filter(), record, accessor)
+                    : evaluate<Field>(f.left_condition(), record, accessor);
+
+            if (!has_rhs || f.oper() == operation::_none)
+                return lhs;
+
+            if (f.oper() == operation::_and && !lhs)
+                return false;
+
+            if (f.oper() == operation::_or && lhs)
+                return true;
+        }
+
+        if (!has_rhs)
+            return true;
+
+        return f.right_is_filter()
+                ? evaluate<Field>(f.right_filter(), record, accessor)
+                : evaluate<Field>(f.right_condition(), record, accessor);
+    }
+
+    /*
+     * Predicate, evaluating the filter against the record. The filter is
+     * referenced, so it should outlive the predicate.
+     */
+    template <typename Field, typename Filter, typename Accessor>
+    class filter_predicate
+    {
+    public:
+        filter_predicate(const Filter &f, const Accessor &accessor)
+            : m_filter(&f),
+              m_accessor(accessor)
+        {
+        }
+
+        template <typename Record>
+        bool operator()(const Record &record) const
+        {
+            return evaluate<Field>(*m_filter, record, m_accessor);
+        }
+
+    private:
+        const Filter *m_filter;
+        Accessor m_accessor;
+    };
+}
+
+#endif //SIFTER_EVALUATE_HPP
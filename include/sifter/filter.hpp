@@ -36,9 +36,26 @@ namespace sifter
         le,
         gt,
         ge,
-        like
+        like,
+        not_like
     };
 
+    /*
+     * Comparison, which is true whenever c is false, provided that both
+     * operands hold the same alternative and are ordered (e.g. not NaN).
+     */
+    constexpr comparison complement(comparison c)
+    {
+        return c == eq ? ne
+                : c == ne ? eq
+                : c == lt ? ge
+                : c == le ? gt
+                : c == gt ? le
+                : c == ge ? lt
+                : c == like ? not_like
+                : like;
+    }
+
     template<typename... Types>
     class condition : public basic_condition<comparison, eq, Types...>
     {
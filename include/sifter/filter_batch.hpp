@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_FILTER_BATCH_HPP
+#define SIFTER_FILTER_BATCH_HPP
+
+#include <cstddef>
+#include <map>
+#include <vector>
+#include "bitmap.hpp"
+#include "evaluate.hpp"
+#include "flat.hpp"
+
+namespace sifter
+{
+    namespace detail
+    {
+        template <typename Condition>
+        struct condition_less
+        {
+            bool operator()(const Condition &lhs, const Condition &rhs) const
+            {
+                if (lhs.comp() != rhs.comp())
+                    return lhs.comp() < rhs.comp();
+                if (lhs.lhs() != rhs.lhs())
+                    return lhs.lhs() < rhs.lhs();
+                return lhs.rhs() < rhs.rhs();
+            }
+        };
+
+        /*
+         * Replaces conditions by indices in the shared table, adding new
+         * ones.
+         */
+        template <typename Condition>
+        class condition_indexer
+        {
+        public:
+            using index_type = std::map<Condition, std::size_t,
+                    condition_less<Condition>>;
+
+        public:
+            condition_indexer(index_type &index,
+                              std::vector<Condition> &conditions)
+                : m_index(&index),
+                  m_conditions(&conditions)
+            {
+            }
+
+            std::size_t operator()(const Condition &c) const
+            {
+                const auto p = m_index->insert(std::make_pair(
+                        c, m_conditions->size()));
+                if (p.second)
+                    m_conditions->push_back(c);
+                return p.first->second;
+            }
+
+        private:
+            index_type *m_index;
+            std::vector<Condition> *m_conditions;
+        };
+
+        /*
+         * Evaluates each condition of the table once per record, the known
+         * bitmap marks evaluated conditions and the values bitmap keeps
+         * their results.
+         */
+        template <typename Field, typename Condition, typename Record,
+                typename Accessor>
+        class memoized_test
+        {
+        public:
+            memoized_test(const std::vector<Condition> &conditions,
+                          const Record &record, const Accessor &accessor,
+                          bitmap &known, bitmap &values)
+                : m_conditions(conditions),
+                  m_record(record),
+                  m_accessor(accessor),
+                  m_known(known),
+                  m_values(values)
+            {
+            }
+
+            bool operator()(std::size_t i) const
+            {
+                if (!m_known.test(i))
+                {
+                    m_known.set(i);
+                    m_values.set(i, evaluate<Field>(m_conditions[i], m_record,
+                                                    m_accessor));
+                }
+                return m_values.test(i);
+            }
+
+        private:
+            const std::vector<Condition> &m_conditions;
+            const Record &m_record;
+            const Accessor &m_accessor;
+            bitmap &m_known;
+            bitmap &m_values;
+        };
+    }
+
+    /*
+     * Batch of filters, evaluated against the same record. Equal
+     * conditions of all filters are stored once, and each filter is
+     * flattened into the short-circuit program over the shared table, so
+     * every distinct condition is evaluated at most once per record and
+     * only if some filter needs it.
+     */
+    template <typename Field, typename Filter, typename Accessor>
+    class filter_batch
+    {
+    public:
+        using filter_type = Filter;
+        using condition_type = typename Filter::condition_type;
+
+        /*
+         * Per-thread state of match(), which may be reused between records,
+         * so matching doesn't allocate after the first record.
+         */
+        class scratch
+        {
+        private:
+            friend class filter_batch;
+
+            bitmap m_known;
+            bitmap m_values;
+        };
+
+    public:
+        explicit filter_batch(const std::vector<Filter> &filters,
+                              const Accessor &accessor = Accessor())
+            : m_accessor(accessor)
+        {
+            typename detail::condition_indexer<condition_type>::index_type
+                    index;
+            const detail::condition_indexer<condition_type> indexer(
+                    index, m_conditions);
+
+            m_programs.reserve(filters.size());
+            for (const Filter &f : filters)
+                m_programs.push_back(flatten(f, indexer));
+        }
+
+        /*
+         * Returns the set of filters, matching the record.
+         */
+        template <typename Record>
+        bitmap match(const Record &record) const
+        {
+            scratch s;
+            bitmap out;
+            match(record, s, out);
+            return out;
+        }
+
+        /*
+         * Writes the set of filters, matching the record, to out, reusing
+         * the scratch and the storage of out.
+         */
+        template <typename Record>
+        void match(const Record &record, scratch &s, bitmap &out) const
+        {
+            clear(s.m_known, m_conditions.size());
+            clear(out, m_programs.size());
+            if (s.m_values.size() != m_conditions.size())
+                s.m_values = bitmap(m_conditions.size());
+
+            const detail::memoized_test<Field, condition_type, Record,
+                    Accessor> test(m_conditions, record, m_accessor,
+                                   s.m_known, s.m_values);
+
+            for (std::size_t i = 0; i < m_programs.size(); ++i)
+            {
+                if (m_programs[i].run(test))
+                    out.set(i);
+            }
+        }
+
+        /*
+         * Number of filters.
+         */
+        std::size_t size() const
+        {
+            return m_programs.size();
+        }
+
+        /*
+         * Distinct conditions of all filters.
+         */
+        const std::vector<condition_type> &conditions() const
+        {
+            return m_conditions;
+        }
+
+    private:
+        static void clear(bitmap &b, std::size_t size)
+        {
+            if (b.size() == size)
+                b.reset();
+            else
+                b = bitmap(size);
+        }
+
+    private:
+        Accessor m_accessor;
+        std::vector<condition_type> m_conditions;
+        std::vector<flat_filter<std::size_t>> m_programs;
+    };
+}
+
+#endif //SIFTER_FILTER_BATCH_HPP
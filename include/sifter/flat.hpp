@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_FLAT_HPP
+#define SIFTER_FLAT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "filter.hpp"
+
+namespace sifter
+{
+    /*
+     * Filter, flattened into the short-circuit program. Each step tests one
+     * condition and jumps to another step, depending on the result, until
+     * it reaches accept or reject. Jumps go forward only, so the program
+     * has no loops.
+     */
+    template <typename Condition>
+    class flat_filter
+    {
+    public:
+        using condition_type = Condition;
+
+        static const std::size_t accept = static_cast<std::size_t>(-1);
+        static const std::size_t reject = static_cast<std::size_t>(-2);
+
+        struct step
+        {
+            Condition condition;
+            std::size_t on_true;
+            std::size_t on_false;
+        };
+
+    public:
+        flat_filter()
+            : m_entry(accept)
+        {
+        }
+
+        flat_filter(std::vector<step> steps, std::size_t entry)
+            : m_steps(std::move(steps)),
+              m_entry(entry)
+        {
+        }
+
+        /*
+         * Runs the program, test(condition) should return result of the
+         * condition. Empty program accepts anything.
+         */
+        template <typename Test>
+        bool run(const Test &test) const
+        {
+            std::size_t i = m_entry;
+            while (i < m_steps.size())
+            {
+                const step &s = m_steps[i];
+                i = test(s.condition) ? s.on_true : s.on_false;
+            }
+            return i == accept;
+        }
+
+        const std::vector<step> &steps() const
+        {
+            return m_steps;
+        }
+
+        std::size_t entry() const
+        {
+            return m_entry;
+        }
+
+        bool empty() const
+        {
+            return m_steps.empty();
+        }
+
+        std::size_t size() const
+        {
+            return m_steps.size();
+        }
+
+    private:
+        std::vector<step> m_steps;
+        std::size_t m_entry;
+    };
+
+    template <typename Condition>
+    const std::size_t flat_filter<Condition>::accept;
+
+    template <typename Condition>
+    const std::size_t flat_filter<Condition>::reject;
+
+    namespace detail
+    {
+        template <typename Condition, typename Transform>
+        class flat_compiler
+        {
+        public:
+            using flat_type = flat_filter<Condition>;
+            using step = typename flat_type::step;
+
+        public:
+            explicit flat_compiler(Transform &transform)
+                : m_transform(transform)
+            {
+            }
+
+            template <typename Filter>
+            flat_type operator()(const Filter &f)
+            {
+                const std::size_t entry = compile(f, flat_type::accept,
+                                                  flat_type::reject);
+
+                /*
+                 * Right sides are compiled first, since the left ones jump
+                 * to them. Reversing makes the entry first and the jumps
+                 * forward.
+                 */
+                for (step &s : m_steps)
+                {
+                    s.on_true = reversed(s.on_true);
+                    s.on_false = reversed(s.on_false);
+                }
+                std::reverse(m_steps.begin(), m_steps.end());
+                return flat_type(std::move(m_steps), reversed(entry));
+            }
+
+        private:
+            template <typename C>
+            std::size_t emit(const C &c, std::size_t on_true,
+                             std::size_t on_false)
+            {
+                m_steps.push_back(step{m_transform(c), on_true, on_false});
+                return m_steps.size() - 1;
+            }
+
+            template <typename Filter>
+            std::size_t compile_left(const Filter &f, std::size_t on_true,
+                                     std::size_t on_false)
+            {
+                return f.left_is_filter()
+                        ? compile(f.left_filter(), on_true, on_false)
+                        : emit(f.left_condition(), on_true, on_false);
+            }
+
+            template <typename Filter>
+            std::size_t compile_right(const Filter &f, std::size_t on_true,
+                                      std::size_t on_false)
+            {
+                return f.right_is_filter()
+                        ? compile(f.right_filter(), on_true, on_false)
+                        : emit(f.right_condition(), on_true, on_false);
+            }
+
+            /*
+             * Compiles the filter, continuing with on_true or on_false
+             * step, and returns its entry step.
+             */
+            template <typename Filter>
+            std::size_t compile(const Filter &f, std::size_t on_true,
+                                std::size_t on_false)
+            {
+                const bool has_lhs = f.left_is_filter() ||
+                                     f.left_is_condition();
+                const bool has_rhs = f.right_is_filter() ||
+                                     f.right_is_condition();
+
+                if (!has_lhs && !has_rhs)
+                    return on_true;
+
+                if (!has_lhs)
+                    return compile_right(f, on_true, on_false);
+
+                if (!has_rhs || f.oper() == operation::_none)
+                    return compile_left(f, on_true, on_false);
+
+                const std::size_t rhs = compile_right(f, on_true, on_false);
+                return f.oper() == operation::_and
+                        ? compile_left(f, rhs, on_false)
+                        : compile_left(f, on_true, rhs);
+            }
+
+            std::size_t reversed(std::size_t i) const
+            {
+                return i < m_steps.size() ? m_steps.size() - 1 - i : i;
+            }
+
+            Transform &m_transform;
+            std::vector<step> m_steps;
+        };
+
+        template <typename Filter, typename Transform>
+        using flat_condition_type = typename std::decay<decltype(
+                std::declval<Transform &>()(std::declval<
+                        const typename Filter::condition_type &>()))>::type;
+    }
+
+    /*
+     * Flattens the filter, converting each condition by transform.
+     */
+    template <typename Filter, typename Transform>
+    flat_filter<detail::flat_condition_type<Filter, Transform>>
+    flatten(const Filter &f, Transform transform)
+    {
+        return detail::flat_compiler<
+                detail::flat_condition_type<Filter, Transform>,
+                Transform>(transform)(f);
+    }
+}
+
+#endif //SIFTER_FLAT_HPP
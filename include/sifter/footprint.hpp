@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_FOOTPRINT_HPP
+#define SIFTER_FOOTPRINT_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include "basic_filter.hpp"
+
+namespace sifter
+{
+    namespace detail
+    {
+        /*
+         * Heap memory, owned by the operand. Short strings are kept in the
+         * string object itself, so they own nothing.
+         */
+        struct operand_footprint
+        {
+            template <typename Char, typename Traits, typename Allocator>
+            std::size_t operator()(
+                    const std::basic_string<Char, Traits, Allocator> &s) const
+            {
+                const std::less<const void *> less;
+                const void *data = s.data();
+
+                if (!less(data, &s) && less(data, &s + 1))
+                    return 0;
+
+                return (s.capacity() + 1) * sizeof(Char);
+            }
+
+            template <typename T>
+            std::size_t operator()(const T &) const
+            {
+                return 0;
+            }
+        };
+    }
+
+    /*
+     * Bytes, occupied by the condition and heap memory of its operands.
+     */
+    template <typename Comparison, Comparison def_value, typename... Types>
+    std::size_t footprint(
+            const basic_condition<Comparison, def_value, Types...> &c)
+    {
+        return sizeof(c) + sifter::visit(detail::operand_footprint(), c.lhs()) +
+               sifter::visit(detail::operand_footprint(), c.rhs());
+    }
+
+    /*
+     * Bytes, occupied by the filter, its nested filters and conditions, and
+     * heap memory of the operands. Unlike counters of the filter it walks
+     * the whole tree.
+     */
+    template <typename Comparison, Comparison def_value, typename... Types>
+    std::size_t footprint(
+            const basic_filter<Comparison, def_value, Types...> &f)
+    {
+        std::size_t out = sizeof(f);
+
+        if (f.left_is_filter())
+            out += footprint(f.left_filter());
+        else if (f.left_is_condition())
+            out += footprint(f.left_condition());
+
+        if (f.right_is_filter())
+            out += footprint(f.right_filter());
+        else if (f.right_is_condition())
+            out += footprint(f.right_condition());
+
+        return out;
+    }
+}
+
+#endif //SIFTER_FOOTPRINT_HPP
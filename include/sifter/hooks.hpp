@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_HOOKS_HPP
+#define SIFTER_HOOKS_HPP
+
+#include <cstddef>
+
+namespace sifter
+{
+    /*
+     * Hooks, which do nothing. Their calls are inlined away, so filters
+     * without custom hooks have no overhead. Custom hooks may derive from
+     * null_hooks and hide only the functions they need. Hooks are called
+     * from noexcept constructors, so they should not throw.
+     */
+    struct null_hooks
+    {
+        /*
+         * Condition or nested filter is allocated for the node of a filter.
+         */
+        template <typename T>
+        static void on_allocate(const T &, std::size_t)
+        {
+        }
+
+        /*
+         * Condition or nested filter is about to be deallocated.
+         */
+        template <typename T>
+        static void on_deallocate(const T &, std::size_t)
+        {
+        }
+
+        /*
+         * Condition or filter is copy constructed or assigned.
+         */
+        template <typename T>
+        static void on_copy(const T &)
+        {
+        }
+
+        /*
+         * Condition or filter is move constructed or assigned.
+         */
+        template <typename T>
+        static void on_move(const T &)
+        {
+        }
+
+        /*
+         * Filter is composed by &&, ||, &= or |=, or negated by ~: the
+         * negation composes a new filter for each node of the source.
+         */
+        template <typename Filter>
+        static void on_compose(const Filter &)
+        {
+        }
+
+        /*
+         * Conditions or filters are compared by == or !=.
+         */
+        template <typename T>
+        static void on_compare(const T &, const T &)
+        {
+        }
+    };
+
+    /*
+     * Hooks of the filter type and of its conditions. Specialize it in
+     * namespace sifter to trace construction of the filters, e.g. by
+     * counters, in a build without changing the headers:
+     *
+     *   namespace sifter
+     *   {
+     *       template <>
+     *       struct filter_hooks<my_filter> : my_hooks {};
+     *   }
+     *
+     * The specialization should be visible before the first use of the
+     * filter in every translation unit.
+     */
+    template <typename Filter>
+    struct filter_hooks : null_hooks
+    {
+    };
+}
+
+#endif //SIFTER_HOOKS_HPP
@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_IMPLICATION_HPP
+#define SIFTER_IMPLICATION_HPP
+
+#include <cstddef>
+#include "evaluate.hpp"
+
+namespace sifter
+{
+    /*
+     * Default number of steps, after which implication check gives up.
+     */
+    const std::size_t implication_budget = 4096;
+
+    namespace detail
+    {
+        template <typename Field, comparison def_value, typename... Types>
+        class implication_checker
+        {
+        public:
+            using filter_type = basic_filter<comparison, def_value, Types...>;
+            using condition_type =
+                    basic_condition<comparison, def_value, Types...>;
+            using value_type = typename condition_type::value_type;
+
+        public:
+            explicit implication_checker(std::size_t budget)
+                : m_budget(budget)
+            {
+            }
+
+            bool operator()(const filter_type &premise,
+                            const filter_type &conclusion)
+            {
+                return implies(term{&premise, nullptr},
+                               term{&conclusion, nullptr});
+            }
+
+        private:
+            enum class kind
+            {
+                any,
+                condition,
+                conjunction,
+                disjunction
+            };
+
+            /*
+             * Either filter or condition.
+             */
+            struct term
+            {
+                const filter_type *f;
+                const condition_type *c;
+            };
+
+            /*
+             * Condition, comparing field with the value.
+             */
+            struct atom
+            {
+                Field field;
+                comparison comp;
+                const value_type *value;
+            };
+
+            static term left(const filter_type &f)
+            {
+                return f.left_is_filter() ? term{&f.left_filter(), nullptr}
+                                          : term{nullptr, &f.left_condition()};
+            }
+
+            static term right(const filter_type &f)
+            {
+                return f.right_is_filter()
+                        ? term{&f.right_filter(), nullptr}
+                        : term{nullptr, &f.right_condition()};
+            }
+
+            /*
+             * Skips filters with one side only, empty filter matches any
+             * record.
+             */
+            static kind normalize(term &t)
+            {
+                while (t.f)
+                {
+                    const filter_type &f = *t.f;
+                    const bool has_lhs = f.left_is_filter() ||
+                                         f.left_is_condition();
+                    const bool has_rhs = f.right_is_filter() ||
+                                         f.right_is_condition();
+
+                    if (!has_lhs && !has_rhs)
+                        return kind::any;
+
+                    if (!has_lhs)
+                        t = right(f);
+                    else if (!has_rhs || f.oper() == operation::_none)
+                        t = left(f);
+                    else
+                        return f.oper() == operation::_and
+                                ? kind::conjunction
+                                : kind::disjunction;
+                }
+                return kind::condition;
+            }
+
+            /*
+             * Disjunctive premise and conjunctive conclusion are split
+             * exactly, the other cases try each side, so the result may be
+             * false for implication, which holds only for the combination
+             * of conditions.
+             */
+            bool implies(term a, term b)
+            {
+                if (m_budget == 0)
+                    return false;
+                --m_budget;
+
+                const kind ka = normalize(a);
+                const kind kb = normalize(b);
+
+                if (kb == kind::any)
+                    return true;
+
+                if (ka == kind::disjunction)
+                    return implies(left(*a.f), b) && implies(right(*a.f), b);
+
+                if (kb == kind::conjunction)
+                    return implies(a, left(*b.f)) && implies(a, right(*b.f));
+
+                if (ka == kind::conjunction &&
+                    (implies(left(*a.f), b) || implies(right(*a.f), b)))
+                    return true;
+
+                if (kb == kind::disjunction)
+                    return implies(a, left(*b.f)) || implies(a, right(*b.f));
+
+                if (kb == kind::condition && constant(*b.c, true))
+                    return true;
+
+                if (ka == kind::condition && constant(*a.c, false))
+                    return true;
+
+                return ka == kind::condition && kb == kind::condition &&
+                       implies(*a.c, *b.c);
+            }
+
+            bool implies(const condition_type &a,
+                         const condition_type &b) const
+            {
+                if (a == b)
+                    return true;
+
+                atom x;
+                atom y;
+                return make_atom(a, x) && make_atom(b, y) &&
+                       x.field == y.field && implies(x, y);
+            }
+
+            /*
+             * Conditions other than ne and not like are true only if the
+             * field holds the same alternative as the value.
+             */
+            static bool implies(const atom &x, const atom &y)
+            {
+                const value_type &v1 = *x.value;
+                const value_type &v2 = *y.value;
+
+                if (x.comp == ne || x.comp == not_like)
+                    return y.comp == x.comp && equal(v1, v2);
+
+                if (v1.index() != v2.index())
+                    return y.comp == ne || y.comp == not_like;
+
+                switch (x.comp)
+                {
+                    case eq:
+                        return compare(y.comp, v1, v2);
+                    case lt:
+                    case le:
+                        return below(x.comp == lt, v1, y, v2);
+                    case gt:
+                    case ge:
+                        return above(x.comp == gt, v1, y, v2);
+                    case ne:
+                    case like:
+                    case not_like:
+                        break;
+                }
+                return y.comp == like && equal(v1, v2);
+            }
+
+            /*
+             * field < v1 (strict) or field <= v1 implies y.
+             */
+            static bool below(bool strict, const value_type &v1,
+                              const atom &y, const value_type &v2)
+            {
+                switch (y.comp)
+                {
+                    case ne:
+                    case lt:
+                        return strict ? !less(v2, v1) : less(v1, v2);
+                    case le:
+                        return !less(v2, v1);
+                    case eq:
+                    case gt:
+                    case ge:
+                    case like:
+                    case not_like:
+                        break;
+                }
+                return false;
+            }
+
+            /*
+             * field > v1 (strict) or field >= v1 implies y.
+             */
+            static bool above(bool strict, const value_type &v1,
+                              const atom &y, const value_type &v2)
+            {
+                switch (y.comp)
+                {
+                    case ne:
+                    case gt:
+                        return strict ? !less(v1, v2) : less(v2, v1);
+                    case ge:
+                        return !less(v1, v2);
+                    case eq:
+                    case lt:
+                    case le:
+                    case like:
+                    case not_like:
+                        break;
+                }
+                return false;
+            }
+
+            static bool less(const value_type &lhs, const value_type &rhs)
+            {
+                return compare(lt, lhs, rhs);
+            }
+
+            static bool equal(const value_type &lhs, const value_type &rhs)
+            {
+                return compare(eq, lhs, rhs);
+            }
+
+            static bool constant(const condition_type &c, bool value)
+            {
+                return !sifter::holds_alternative<Field>(c.lhs()) &&
+                       !sifter::holds_alternative<Field>(c.rhs()) &&
+                       compare(c.comp(), c.lhs(), c.rhs()) == value;
+            }
+
+            /*
+             * Converts the condition to "field comp value" form, if it
+             * compares one field with a value.
+             */
+            static bool make_atom(const condition_type &c, atom &out)
+            {
+                const bool lhs_field = sifter::holds_alternative<Field>(
+                        c.lhs());
+                const bool rhs_field = sifter::holds_alternative<Field>(
+                        c.rhs());
+
+                if (lhs_field == rhs_field)
+                    return false;
+
+                if (lhs_field)
+                {
+                    out = atom{sifter::get<Field>(c.lhs()), c.comp(),
+                               &c.rhs()};
+                    return true;
+                }
+
+                out = atom{sifter::get<Field>(c.rhs()), mirrored(c.comp()),
+                           &c.lhs()};
+                return c.comp() != like && c.comp() != not_like;
+            }
+
+            static comparison mirrored(comparison c)
+            {
+                switch (c)
+                {
+                    case lt:
+                        return gt;
+                    case le:
+                        return ge;
+                    case gt:
+                        return lt;
+                    case ge:
+                        return le;
+                    case eq:
+                    case ne:
+                    case like:
+                    case not_like:
+                        break;
+                }
+                return c;
+            }
+
+            std::size_t m_budget;
+        };
+    }
+
+    /*
+     * Checks if every record, matching the premise, matches the
+     * conclusion too. The check is sound, but not complete: true is
+     * returned only if the implication follows from the filter structure
+     * and pairwise relations of the conditions on the same field, false
+     * means "not proven". The check gives up after budget steps.
+     */
+    template <typename Field, comparison def_value, typename... Types>
+    bool implies(
+            const basic_filter<comparison, def_value, Types...> &premise,
+            const basic_filter<comparison, def_value, Types...> &conclusion,
+            std::size_t budget = implication_budget)
+    {
+        return detail::implication_checker<Field, def_value, Types...>(
+                budget)(premise, conclusion);
+    }
+
+    /*
+     * Checks if both filters match the same records, see implies().
+     */
+    template <typename Field, comparison def_value, typename... Types>
+    bool equivalent(const basic_filter<comparison, def_value, Types...> &f1,
+                    const basic_filter<comparison, def_value, Types...> &f2,
+                    std::size_t budget = implication_budget)
+    {
+        return implies<Field>(f1, f2, budget) &&
+               implies<Field>(f2, f1, budget);
+    }
+}
+
+#endif //SIFTER_IMPLICATION_HPP
@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_INCREMENTAL_HPP
+#define SIFTER_INCREMENTAL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "evaluate.hpp"
+
+namespace sifter
+{
+    /*
+     * Change of the record match status, reported by incremental matcher.
+     */
+    enum class match_event
+    {
+        none,
+        enter,
+        leave
+    };
+
+    /*
+     * Keeps truth values of every condition and inner node of the filter
+     * for each record, so an update of one field re-evaluates only the
+     * conditions, referencing this field, and propagates changes up the
+     * tree until some node keeps its value. Records are identified by
+     * dense indices, e.g. positions in the container, and are passed to
+     * each call, the matcher doesn't keep them.
+     */
+    template <typename Field, typename Filter, typename Accessor>
+    class incremental_matcher
+    {
+    public:
+        using filter_type = Filter;
+        using condition_type = typename Filter::condition_type;
+
+        static const std::size_t npos = static_cast<std::size_t>(-1);
+
+    public:
+        explicit incremental_matcher(const Filter &f,
+                                     const Accessor &accessor = Accessor())
+            : m_accessor(accessor)
+        {
+            m_root = compile(f);
+            std::sort(m_dependents.begin(), m_dependents.end(),
+                      dependent_less());
+            m_dependents.erase(std::unique(m_dependents.begin(),
+                                           m_dependents.end()),
+                               m_dependents.end());
+        }
+
+        /*
+         * Evaluates the whole filter against the new record, returns enter
+         * if the record matches it.
+         */
+        template <typename Record>
+        match_event insert(std::size_t id, const Record &record)
+        {
+            if (id >= m_present.size())
+            {
+                m_present.resize(id + 1, 0);
+                m_values.resize((id + 1) * m_nodes.size(), 0);
+            }
+
+            const bool before = present(id) && value(id, m_root);
+            unsigned char *values = record_values(id);
+            for (std::size_t i = m_nodes.size(); i-- > 0;)
+                values[i] = compute(i, values, record);
+            m_present[id] = 1;
+
+            return event(before, value(id, m_root));
+        }
+
+        /*
+         * Re-evaluates conditions, referencing the changed field, against
+         * the updated record.
+         */
+        template <typename Record>
+        match_event update(std::size_t id, const Record &record,
+                           Field changed)
+        {
+            if (!present(id))
+                return insert(id, record);
+
+            const bool before = value(id, m_root);
+            unsigned char *values = record_values(id);
+
+            auto range = std::equal_range(
+                    m_dependents.begin(), m_dependents.end(),
+                    std::make_pair(changed, std::size_t(0)), field_less());
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                const std::size_t i = it->second;
+                const unsigned char v = compute(i, values, record);
+                if (v != values[i])
+                {
+                    values[i] = v;
+                    propagate(m_nodes[i].parent, values, record);
+                }
+            }
+
+            return event(before, value(id, m_root));
+        }
+
+        /*
+         * Forgets the record, returns leave if it matched the filter.
+         */
+        match_event erase(std::size_t id)
+        {
+            if (!present(id))
+                return match_event::none;
+
+            const bool before = value(id, m_root);
+            m_present[id] = 0;
+            return event(before, false);
+        }
+
+        bool contains(std::size_t id) const
+        {
+            return present(id);
+        }
+
+        /*
+         * Cached match status of the record, false for unknown records.
+         */
+        bool matches(std::size_t id) const
+        {
+            return present(id) && value(id, m_root);
+        }
+
+        /*
+         * Number of the conditions and inner nodes, cached per record.
+         */
+        std::size_t nodes() const
+        {
+            return m_nodes.size();
+        }
+
+    private:
+        enum class kind
+        {
+            condition,
+            conjunction,
+            disjunction
+        };
+
+        /*
+         * Children always follow their parent, so evaluating nodes from
+         * the last one to the first one computes children first.
+         */
+        struct node
+        {
+            kind type;
+            std::size_t parent;
+            std::size_t left;
+            std::size_t right;
+            std::size_t condition;
+        };
+
+        using dependent = std::pair<Field, std::size_t>;
+
+        struct dependent_less
+        {
+            bool operator()(const dependent &lhs, const dependent &rhs) const
+            {
+                return lhs.first < rhs.first ||
+                       (!(rhs.first < lhs.first) && lhs.second < rhs.second);
+            }
+        };
+
+        struct field_less
+        {
+            bool operator()(const dependent &lhs, const dependent &rhs) const
+            {
+                return lhs.first < rhs.first;
+            }
+        };
+
+        std::size_t add_node(kind type, std::size_t condition)
+        {
+            m_nodes.push_back(node{type, npos, npos, npos, condition});
+            return m_nodes.size() - 1;
+        }
+
+        void add_dependent(const typename condition_type::value_type &operand,
+                           std::size_t i)
+        {
+            if (sifter::holds_alternative<Field>(operand))
+                m_dependents.push_back(dependent(
+                        sifter::get<Field>(operand), i));
+        }
+
+        std::size_t compile(const condition_type &c)
+        {
+            const std::size_t i = add_node(kind::condition,
+                                           m_conditions.size());
+            m_conditions.push_back(c);
+            add_dependent(c.lhs(), i);
+            add_dependent(c.rhs(), i);
+            return i;
+        }
+
+        std::size_t compile_left(const Filter &f)
+        {
+            return f.left_is_filter() ? compile(f.left_filter())
+                                      : compile(f.left_condition());
+        }
+
+        std::size_t compile_right(const Filter &f)
+        {
+            return f.right_is_filter() ? compile(f.right_filter())
+                                       : compile(f.right_condition());
+        }
+
+        /*
+         * Returns index of the subtree root or npos for the empty filter,
+         * which matches any record.
+         */
+        std::size_t compile(const Filter &f)
+        {
+            const bool has_lhs = f.left_is_filter() || f.left_is_condition();
+            const bool has_rhs = f.right_is_filter() ||
+                                 f.right_is_condition();
+
+            if (!has_lhs && !has_rhs)
+                return npos;
+
+            if (!has_lhs)
+                return compile_right(f);
+
+            if (!has_rhs || f.oper() == operation::_none)
+                return compile_left(f);
+
+            const std::size_t i = add_node(
+                    f.oper() == operation::_and ? kind::conjunction
+                                                : kind::disjunction, npos);
+            const std::size_t left = compile_left(f);
+            const std::size_t right = compile_right(f);
+
+            m_nodes[i].left = left;
+            m_nodes[i].right = right;
+            if (left != npos)
+                m_nodes[left].parent = i;
+            if (right != npos)
+                m_nodes[right].parent = i;
+            return i;
+        }
+
+        template <typename Record>
+        unsigned char compute(std::size_t i, const unsigned char *values,
+                              const Record &record) const
+        {
+            const node &n = m_nodes[i];
+            switch (n.type)
+            {
+                case kind::condition:
+                    return evaluate<Field>(m_conditions[n.condition], record,
+                                           m_accessor);
+                case kind::conjunction:
+                    return child(n.left, values) && child(n.right, values);
+                case kind::disjunction:
+                    return child(n.left, values) || child(n.right, values);
+            }
+            return 0;
+        }
+
+        template <typename Record>
+        void propagate(std::size_t i, unsigned char *values,
+                       const Record &record) const
+        {
+            for (; i != npos; i = m_nodes[i].parent)
+            {
+                const unsigned char v = compute(i, values, record);
+                if (v == values[i])
+                    return;
+                values[i] = v;
+            }
+        }
+
+        static bool child(std::size_t i, const unsigned char *values)
+        {
+            return i == npos || values[i];
+        }
+
+        static match_event event(bool before, bool after)
+        {
+            if (before == after)
+                return match_event::none;
+            return after ? match_event::enter : match_event::leave;
+        }
+
+        bool present(std::size_t id) const
+        {
+            return id < m_present.size() && m_present[id];
+        }
+
+        bool value(std::size_t id, std::size_t i) const
+        {
+            return i == npos || m_values[id * m_nodes.size() + i];
+        }
+
+        unsigned char *record_values(std::size_t id)
+        {
+            return m_values.data() + id * m_nodes.size();
+        }
+
+        Accessor m_accessor;
+        std::vector<node> m_nodes;
+        std::vector<condition_type> m_conditions;
+        std::vector<dependent> m_dependents;
+        std::size_t m_root;
+        std::vector<unsigned char> m_present;
+        std::vector<unsigned char> m_values;
+    };
+
+    template <typename Field, typename Filter, typename Accessor>
+    const std::size_t incremental_matcher<Field, Filter, Accessor>::npos;
+}
+
+#endif //SIFTER_INCREMENTAL_HPP
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_INSTANTIATE_HPP
+#define SIFTER_INSTANTIATE_HPP
+
+#include "filter.hpp"
+#include "ostream.hpp"
+
+/*
+ * Explicit instantiation of the filter, condition, node and default output
+ * types for the operand types, e.g. SIFTER_FILTER_TYPES(template, field,
+ * int, std::string).
+ */
+#define SIFTER_FILTER_TYPES(prefix, ...)                                      \
+    prefix class sifter::basic_condition<sifter::comparison, sifter::eq,      \
+                                         __VA_ARGS__>;                        \
+    prefix class sifter::condition<__VA_ARGS__>;                              \
+    prefix class sifter::basic_filter<sifter::comparison, sifter::eq,         \
+                                      __VA_ARGS__>;                           \
+    prefix struct sifter::basic_node<sifter::comparison, sifter::eq,          \
+                                     __VA_ARGS__>;                            \
+    prefix class sifter::basic_out<sifter::default_dumper,                    \
+                                   sifter::comparison, sifter::eq,            \
+                                   __VA_ARGS__>;
+
+/*
+ * Declares, that the filter types are instantiated in another translation
+ * unit, so including ones don't instantiate their members again. It should
+ * follow declarations of the operand types in the header, included by the
+ * users of the filter.
+ */
+#define SIFTER_EXTERN_FILTER(...) SIFTER_FILTER_TYPES(extern template,       \
+                                                      __VA_ARGS__)
+
+/*
+ * Instantiates the filter types. It should be used in a single translation
+ * unit, see sifter_instantiate_filters() in SifterInstantiate.cmake.
+ */
+#define SIFTER_INSTANTIATE_FILTER(...) SIFTER_FILTER_TYPES(template,         \
+                                                           __VA_ARGS__)
+
+#endif //SIFTER_INSTANTIATE_HPP
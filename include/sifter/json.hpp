@@ -0,0 +1,659 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_JSON_HPP
+#define SIFTER_JSON_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "buffer_dumper.hpp"
+#include "operand.hpp"
+
+namespace sifter
+{
+    /*
+     * Thrown if the text is not valid JSON or doesn't describe a filter.
+     * Offset points to the byte, where the error was found.
+     */
+    class json_error : public std::invalid_argument
+    {
+    public:
+        json_error(const std::string &what, std::size_t offset);
+
+        std::size_t offset() const;
+
+    private:
+        std::size_t m_offset;
+    };
+
+    namespace detail
+    {
+        /*
+         * Maximal nesting of "and"/"or" objects, deeper texts are rejected
+         * instead of exhausting the stack.
+         */
+        const std::size_t json_depth = 128;
+
+        /*
+         * Maximal depth of the decoded filter. Array items are folded one
+         * level per item, so long flat arrays are limited too: the tree is
+         * destroyed and walked recursively, so deeper filters would exhaust
+         * the stack.
+         */
+        const std::size_t json_tree_depth = 1024;
+
+        /*
+         * Maximal length of escaped key, comparison or field name. Only
+         * escaped names are copied to the stack buffer of this size.
+         */
+        const std::size_t json_name_size = 256;
+
+        /*
+         * String in the source text without quotes. Escaped string has to
+         * be unescaped by json_unescape().
+         */
+        struct json_string
+        {
+            const char *data;
+            std::size_t size;
+            bool escaped;
+        };
+
+        /*
+         * Number without fraction and exponent, which fits long long, is
+         * integral. Floating value is set for all numbers.
+         */
+        struct json_number
+        {
+            bool integral;
+            long long integer;
+            double floating;
+        };
+
+        /*
+         * Single pass tokenizer. It doesn't copy the text: strings are
+         * returned as ranges of the source.
+         */
+        class json_reader
+        {
+        public:
+            json_reader(const char *data, std::size_t size);
+
+            /*
+             * Next character after whitespace or '\0' at the end.
+             */
+            char peek();
+
+            bool consume(char c);
+
+            void expect(char c);
+
+            json_string read_string();
+
+            json_number read_number();
+
+            bool read_bool();
+
+            /*
+             * Checks that nothing but whitespace is left.
+             */
+            void finish();
+
+            [[noreturn]] void fail(const char *what) const;
+
+        private:
+            void skip();
+
+            const char *m_begin;
+            const char *m_pos;
+            const char *m_end;
+        };
+
+        /*
+         * Writes unescaped string, validated by json_reader, to out and
+         * returns its size. Unescaped string is never longer than the source.
+         */
+        std::size_t json_unescape(const char *data, std::size_t size,
+                                  char *out);
+
+        /*
+         * Appends quoted and escaped string.
+         */
+        void json_escape(std::string &out, const char *data, std::size_t size);
+
+        /*
+         * Appends floating point number, which is read back as the same
+         * double and never as an integer.
+         */
+        void json_floating(std::string &out, double value);
+
+        bool json_comparison(const char *data, std::size_t size,
+                             comparison &out);
+
+        template <typename Field, typename Filter, typename FieldMap>
+        class json_decoder
+        {
+        public:
+            using condition_type = typename Filter::condition_type;
+            using value_type = typename condition_type::value_type;
+
+            json_decoder(const char *data, std::size_t size,
+                         const FieldMap &fields, const allocator_type &a)
+                : m_reader(data, size),
+                  m_fields(fields),
+                  m_allocator(a)
+            {
+            }
+
+            Filter decode()
+            {
+                Filter f(m_allocator);
+                item(f, operation::_none, 0);
+                m_reader.finish();
+                return f;
+            }
+
+        private:
+            using string_type = typename first_alternative<
+                    is_string_operand, value_type>::type;
+            using integer_type = typename first_alternative<
+                    is_integer_operand, value_type>::type;
+            using floating_type = typename first_alternative<
+                    std::is_floating_point, value_type>::type;
+            using bool_type = typename first_alternative<
+                    is_bool_operand, value_type>::type;
+
+            enum member
+            {
+                lhs_member = 1,
+                op_member = 2,
+                rhs_member = 4,
+                all_members = 7
+            };
+
+            /*
+             * Decodes filter or condition object and composes it with f,
+             * operation none replaces f.
+             */
+            void item(Filter &f, operation oper, std::size_t depth)
+            {
+                if (depth > json_depth)
+                    m_reader.fail("filter is nested too deep");
+
+                m_reader.expect('{');
+                if (m_reader.consume('}'))
+                {
+                    compose(f, Filter(m_allocator), oper);
+                    return;
+                }
+
+                char buffer[json_name_size];
+                json_string key = name(m_reader.read_string(), buffer);
+                m_reader.expect(':');
+
+                const bool is_and = equal(key, "and");
+                if (is_and || equal(key, "or"))
+                {
+                    Filter items(m_allocator);
+                    list(items, is_and ? operation::_and : operation::_or,
+                         depth + 1);
+                    m_reader.expect('}');
+                    compose(f, std::move(items), oper);
+                    return;
+                }
+
+                condition_type c;
+                int members = 0;
+                for (;;)
+                {
+                    members |= condition_member(c, key, members);
+                    if (!m_reader.consume(','))
+                        break;
+
+                    key = name(m_reader.read_string(), buffer);
+                    m_reader.expect(':');
+                }
+                m_reader.expect('}');
+
+                if (members != all_members)
+                    m_reader.fail("condition requires lhs, op and rhs");
+
+                compose(f, std::move(c), oper);
+            }
+
+            /*
+             * Folds array items left to right, so [a, b, c] is
+             * ((a oper b) oper c).
+             */
+            void list(Filter &f, operation oper, std::size_t depth)
+            {
+                m_reader.expect('[');
+                if (m_reader.consume(']'))
+                    return;
+
+                item(f, operation::_none, depth);
+                while (m_reader.consume(','))
+                {
+                    item(f, oper, depth);
+                    if (f.depth() > json_tree_depth)
+                        m_reader.fail("filter is too deep");
+                }
+
+                m_reader.expect(']');
+            }
+
+            int condition_member(condition_type &c, const json_string &key,
+                                 int members)
+            {
+                int current = 0;
+                if (equal(key, "lhs"))
+                    current = lhs_member;
+                else if (equal(key, "op"))
+                    current = op_member;
+                else if (equal(key, "rhs"))
+                    current = rhs_member;
+                else
+                    m_reader.fail("unknown condition member");
+
+                if (members & current)
+                    m_reader.fail("duplicate condition member");
+
+                if (current == op_member)
+                {
+                    char buffer[json_name_size];
+                    const json_string op = name(m_reader.read_string(),
+                                                buffer);
+                    comparison value;
+                    if (!json_comparison(op.data, op.size, value))
+                        m_reader.fail("unknown comparison");
+                    c.comp() = value;
+                }
+                else
+                {
+                    operand(current == lhs_member ? c.lhs() : c.rhs());
+                }
+                return current;
+            }
+
+            void operand(value_type &v)
+            {
+                switch (m_reader.peek())
+                {
+                    case '{':
+                        field(v);
+                        break;
+                    case '"':
+                        string(v, identity<string_type>());
+                        break;
+                    case 't':
+                    case 'f':
+                        boolean(v, identity<bool_type>());
+                        break;
+                    default:
+                        number(v, m_reader.read_number());
+                        break;
+                }
+            }
+
+            void field(value_type &v)
+            {
+                m_reader.expect('{');
+                char buffer[json_name_size];
+                if (!equal(name(m_reader.read_string(), buffer), "field"))
+                    m_reader.fail("field object requires field member");
+
+                m_reader.expect(':');
+                const json_string text = name(m_reader.read_string(), buffer);
+
+                Field f;
+                if (!m_fields(text.data, text.size, f))
+                    m_reader.fail("unknown field");
+
+                m_reader.expect('}');
+                v.template emplace<Field>(f);
+            }
+
+            void string(value_type &, identity<void>)
+            {
+                m_reader.fail("string operands are not supported");
+            }
+
+            template <typename String>
+            void string(value_type &v, identity<String>)
+            {
+                const json_string s = m_reader.read_string();
+                String text = make_string<String>(m_allocator);
+
+                if (s.escaped)
+                {
+                    text.resize(s.size);
+                    text.resize(json_unescape(s.data, s.size, &text[0]));
+                }
+                else
+                {
+                    text.assign(s.data, s.size);
+                }
+                v.template emplace<String>(std::move(text));
+            }
+
+            void boolean(value_type &, identity<void>)
+            {
+                m_reader.fail("boolean operands are not supported");
+            }
+
+            template <typename Bool>
+            void boolean(value_type &v, identity<Bool>)
+            {
+                v.template emplace<Bool>(m_reader.read_bool());
+            }
+
+            void number(value_type &v, const json_number &n)
+            {
+                if (!n.integral ||
+                    !integer(v, n.integer, identity<integer_type>()))
+                    floating(v, n.floating, identity<floating_type>());
+            }
+
+            bool integer(value_type &, long long, identity<void>)
+            {
+                return false;
+            }
+
+            template <typename Integer>
+            bool integer(value_type &v, long long value,
+                         identity<Integer>)
+            {
+                if (!fits<Integer>(value))
+                    return false;
+
+                v.template emplace<Integer>(static_cast<Integer>(value));
+                return true;
+            }
+
+            void floating(value_type &, double, identity<void>)
+            {
+                m_reader.fail("number can't be stored by any operand type");
+            }
+
+            template <typename Floating>
+            void floating(value_type &v, double value,
+                          identity<Floating>)
+            {
+                v.template emplace<Floating>(static_cast<Floating>(value));
+            }
+
+            json_string name(const json_string &s,
+                             char (&buffer)[json_name_size]) const
+            {
+                if (!s.escaped)
+                    return s;
+
+                if (s.size > json_name_size)
+                    m_reader.fail("escaped name is too long");
+
+                json_string out = {buffer,
+                                   json_unescape(s.data, s.size, buffer),
+                                   false};
+                return out;
+            }
+
+            static bool equal(const json_string &s, const char *text)
+            {
+                return s.size == std::strlen(text) &&
+                       std::memcmp(s.data, text, s.size) == 0;
+            }
+
+            static void compose(Filter &f, condition_type &&c, operation oper)
+            {
+                if (oper == operation::_and)
+                    f &= std::move(c);
+                else if (oper == operation::_or)
+                    f |= std::move(c);
+                else
+                    f = std::move(c);
+            }
+
+            static void compose(Filter &f, Filter &&items, operation oper)
+            {
+                if (oper == operation::_and)
+                    f &= std::move(items);
+                else if (oper == operation::_or)
+                    f |= std::move(items);
+                else
+                    f = std::move(items);
+            }
+
+            json_reader m_reader;
+            const FieldMap &m_fields;
+            const allocator_type &m_allocator;
+        };
+
+        struct json_field_tag
+        {
+        };
+
+        struct json_string_tag
+        {
+        };
+
+        struct json_bool_tag
+        {
+        };
+
+        struct json_integer_tag
+        {
+        };
+
+        struct json_floating_tag
+        {
+        };
+
+        template <typename Field, typename T>
+        using json_kind = typename std::conditional<
+                std::is_same<T, Field>::value, json_field_tag,
+                typename std::conditional<
+                        is_string_operand<T>::value, json_string_tag,
+                        typename std::conditional<
+                                is_bool_operand<T>::value, json_bool_tag,
+                                typename std::conditional<
+                                        is_integer_operand<T>::value,
+                                        json_integer_tag,
+                                        json_floating_tag>::type>::type>::type
+                >::type;
+
+        template <typename Field, typename Filter, typename FieldNames>
+        class json_encoder
+        {
+        public:
+            using condition_type = typename Filter::condition_type;
+
+            json_encoder(std::string &out, const FieldNames &names)
+                : m_out(out),
+                  m_names(names)
+            {
+            }
+
+            void encode(const Filter &f)
+            {
+                if (!f)
+                {
+                    m_out += "{}";
+                    return;
+                }
+
+                if (f.oper() == operation::_none)
+                {
+                    left(f);
+                    return;
+                }
+
+                m_out += f.oper() == operation::_and ? "{\"and\":["
+                                                     : "{\"or\":[";
+                items(f);
+                m_out += "]}";
+            }
+
+            void encode(const condition_type &c)
+            {
+                m_out += "{\"lhs\":";
+                sifter::visit(*this, c.lhs());
+                m_out += ",\"op\":\"";
+                m_out += token(c.comp());
+                m_out += "\",\"rhs\":";
+                sifter::visit(*this, c.rhs());
+                m_out += '}';
+            }
+
+            template <typename T>
+            void operator()(const T &value)
+            {
+                operand(value, json_kind<Field, T>());
+            }
+
+        private:
+            /*
+             * Left operands with the same operation are written to the same
+             * array, as the decoder folds arrays left to right.
+             */
+            void items(const Filter &f)
+            {
+                if (f.left_is_filter() && f.left_filter().oper() == f.oper())
+                    items(f.left_filter());
+                else
+                    left(f);
+
+                m_out += ',';
+                if (f.right_is_filter())
+                    encode(f.right_filter());
+                else if (f.right_is_condition())
+                    encode(f.right_condition());
+                else
+                    m_out += "{}";
+            }
+
+            void left(const Filter &f)
+            {
+                if (f.left_is_filter())
+                    encode(f.left_filter());
+                else if (f.left_is_condition())
+                    encode(f.left_condition());
+                else
+                    m_out += "{}";
+            }
+
+            template <typename T>
+            void operand(const T &value, json_field_tag)
+            {
+                m_out += "{\"field\":";
+                text(m_names(value));
+                m_out += '}';
+            }
+
+            template <typename T>
+            void operand(const T &value, json_string_tag)
+            {
+                json_escape(m_out, value.data(), value.size());
+            }
+
+            template <typename T>
+            void operand(const T &value, json_bool_tag)
+            {
+                m_out += value ? "true" : "false";
+            }
+
+            template <typename T>
+            void operand(const T &value, json_integer_tag)
+            {
+                char buffer[integer_size];
+                m_out.append(buffer, format_integer(buffer, +value));
+            }
+
+            template <typename T>
+            void operand(const T &value, json_floating_tag)
+            {
+                static_assert(std::is_floating_point<T>::value,
+                              "operand type can't be encoded to JSON");
+                json_floating(m_out, static_cast<double>(value));
+            }
+
+            void text(const char *name)
+            {
+                json_escape(m_out, name, std::strlen(name));
+            }
+
+            template <typename Text>
+            void text(const Text &name)
+            {
+                json_escape(m_out, name.data(), name.size());
+            }
+
+            std::string &m_out;
+            const FieldNames &m_names;
+        };
+    }
+
+    /*
+     * Builds filter from JSON text in a single pass without intermediate
+     * document. Filter is an object {"and": [...]} or {"or": [...]}, whose
+     * items are folded left to right, a condition
+     * {"lhs": operand, "op": "<", "rhs": operand} or {} for the empty
+     * filter. Operand is a string, number, boolean or field reference
+     * {"field": "name"}; it is stored as the first operand type of the
+     * matching kind, integers fall back to floating point type. Field map
+     * is called as bool(const char *name, std::size_t size, Field &out) and
+     * returns false for unknown names. Throws json_error.
+     */
+    template <typename Field, typename Filter, typename FieldMap>
+    Filter decode_json(const char *data, std::size_t size,
+                       const FieldMap &fields,
+                       const allocator_type &a = allocator_type())
+    {
+        return detail::json_decoder<Field, Filter, FieldMap>(
+                data, size, fields, a).decode();
+    }
+
+    template <typename Field, typename Filter, typename FieldMap>
+    Filter decode_json(const std::string &text, const FieldMap &fields,
+                       const allocator_type &a = allocator_type())
+    {
+        return decode_json<Field, Filter>(text.data(), text.size(), fields,
+                                          a);
+    }
+
+    /*
+     * Appends JSON representation of the filter, which is decoded by
+     * decode_json() to the equal filter. Field names are returned by
+     * names(Field) as const char * or string.
+     */
+    template <typename Field, typename Filter, typename FieldNames>
+    void encode_json(std::string &out, const Filter &f,
+                     const FieldNames &names)
+    {
+        detail::json_encoder<Field, Filter, FieldNames>(out, names).encode(f);
+    }
+}
+
+#endif //SIFTER_JSON_HPP
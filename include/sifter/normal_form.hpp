@@ -0,0 +1,364 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_NORMAL_FORM_HPP
+#define SIFTER_NORMAL_FORM_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include "filter.hpp"
+
+namespace sifter
+{
+    enum class normal_form_type
+    {
+        dnf,
+        cnf
+    };
+
+    /*
+     * Filter in disjunctive (OR of ANDs) or conjunctive (AND of ORs)
+     * normal form. Terms are sorted lists of indices in the conditions
+     * table. If the conversion exceeded the term limit, only a part of the
+     * filter is converted, and the filter is equal to the normal form AND
+     * the residual filter.
+     */
+    template <typename Filter>
+    struct normal_form
+    {
+        using filter_type = Filter;
+        using condition_type = typename Filter::condition_type;
+        using term_type = std::vector<std::size_t>;
+
+        normal_form_type type;
+        std::vector<condition_type> conditions;
+        std::vector<term_type> terms;
+        Filter residual;
+
+        bool complete() const
+        {
+            return !residual;
+        }
+
+        /*
+         * Builds the filter from terms and residual.
+         */
+        Filter to_filter() const
+        {
+            const bool dnf = type == normal_form_type::dnf;
+
+            Filter out;
+            for (const term_type &term : terms)
+            {
+                Filter f;
+                for (std::size_t i : term)
+                    join(f, Filter(conditions[i]), !dnf);
+                join(out, f, dnf);
+            }
+            join(out, residual, false);
+            return out;
+        }
+
+    private:
+        static void join(Filter &out, const Filter &f, bool disjunction)
+        {
+            if (!out)
+                out = f;
+            else if (disjunction)
+                out |= f;
+            else
+                out &= f;
+        }
+    };
+
+    /*
+     * Default limit of the number of terms in the normal form.
+     */
+    const std::size_t normal_form_limit = 256;
+
+    namespace detail
+    {
+        template <typename Filter>
+        class normal_form_converter
+        {
+        public:
+            using result_type = normal_form<Filter>;
+            using condition_type = typename Filter::condition_type;
+            using term_type = typename result_type::term_type;
+            using terms_type = std::vector<term_type>;
+
+        public:
+            normal_form_converter(normal_form_type type, std::size_t limit)
+                : m_type(type),
+                  m_limit(limit)
+            {
+            }
+
+            /*
+             * Converts top level conjuncts one by one, so the ones, which
+             * exceed the limit, go to the residual filter.
+             */
+            result_type operator()(const Filter &f)
+            {
+                std::vector<term> conjuncts;
+                collect_conjuncts(term{&f, nullptr}, conjuncts);
+
+                terms_type terms(m_type == normal_form_type::dnf ? 1 : 0);
+                Filter residual;
+
+                for (const term &t : conjuncts)
+                {
+                    terms_type converted;
+                    if (convert(t, converted) &&
+                        combine(terms, converted, operation::_and, terms))
+                        continue;
+
+                    const Filter part = t.f ? *t.f : Filter(*t.c);
+                    if (!residual)
+                        residual = part;
+                    else
+                        residual &= part;
+                }
+
+                return compact(terms, residual);
+            }
+
+        private:
+            enum class kind
+            {
+                any,
+                condition,
+                conjunction,
+                disjunction
+            };
+
+            struct term
+            {
+                const Filter *f;
+                const condition_type *c;
+            };
+
+            static term left(const Filter &f)
+            {
+                return f.left_is_filter() ? term{&f.left_filter(), nullptr}
+                                          : term{nullptr, &f.left_condition()};
+            }
+
+            static term right(const Filter &f)
+            {
+                return f.right_is_filter()
+                        ? term{&f.right_filter(), nullptr}
+                        : term{nullptr, &f.right_condition()};
+            }
+
+            static kind normalize(term &t)
+            {
+                while (t.f)
+                {
+                    const Filter &f = *t.f;
+                    const bool has_lhs = f.left_is_filter() ||
+                                         f.left_is_condition();
+                    const bool has_rhs = f.right_is_filter() ||
+                                         f.right_is_condition();
+
+                    if (!has_lhs && !has_rhs)
+                        return kind::any;
+
+                    if (!has_lhs)
+                        t = right(f);
+                    else if (!has_rhs || f.oper() == operation::_none)
+                        t = left(f);
+                    else
+                        return f.oper() == operation::_and
+                                ? kind::conjunction
+                                : kind::disjunction;
+                }
+                return kind::condition;
+            }
+
+            static void collect_conjuncts(term t, std::vector<term> &out)
+            {
+                const kind k = normalize(t);
+                if (k == kind::conjunction)
+                {
+                    collect_conjuncts(left(*t.f), out);
+                    collect_conjuncts(right(*t.f), out);
+                }
+                else if (k != kind::any)
+                {
+                    out.push_back(t);
+                }
+            }
+
+            /*
+             * Converts the subtree, returns false if it exceeds the limit.
+             */
+            bool convert(term t, terms_type &out)
+            {
+                switch (normalize(t))
+                {
+                    case kind::any:
+                        out.assign(m_type == normal_form_type::dnf ? 1 : 0,
+                                   term_type());
+                        return true;
+                    case kind::condition:
+                        out.assign(1, term_type(1, index(*t.c)));
+                        return true;
+                    case kind::conjunction:
+                    case kind::disjunction:
+                        break;
+                }
+
+                terms_type lhs;
+                terms_type rhs;
+                return convert(left(*t.f), lhs) &&
+                       convert(right(*t.f), rhs) &&
+                       combine(lhs, rhs, t.f->oper(), out);
+            }
+
+            /*
+             * In DNF the disjunction unites the terms and the conjunction
+             * multiplies them, in CNF vice versa. Sizes are checked before
+             * the product is built, so intermediate results never exceed
+             * the limit.
+             */
+            bool combine(const terms_type &lhs, const terms_type &rhs,
+                         operation oper, terms_type &out) const
+            {
+                const bool product = (oper == operation::_and) ==
+                                     (m_type == normal_form_type::dnf);
+
+                if (!product)
+                {
+                    if (lhs.size() + rhs.size() > m_limit)
+                        return false;
+
+                    terms_type terms(lhs);
+                    terms.insert(terms.end(), rhs.begin(), rhs.end());
+                    out.swap(terms);
+                    return true;
+                }
+
+                if (!lhs.empty() && rhs.size() > m_limit / lhs.size())
+                    return false;
+
+                terms_type terms;
+                terms.reserve(lhs.size() * rhs.size());
+                for (const term_type &a : lhs)
+                {
+                    for (const term_type &b : rhs)
+                    {
+                        term_type merged;
+                        merged.reserve(a.size() + b.size());
+                        std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                                       std::back_inserter(merged));
+                        terms.push_back(std::move(merged));
+                    }
+                }
+                out.swap(terms);
+                return true;
+            }
+
+            std::size_t index(const condition_type &c)
+            {
+                const auto it = std::find(m_conditions.begin(),
+                                          m_conditions.end(), c);
+                if (it != m_conditions.end())
+                    return static_cast<std::size_t>(it - m_conditions.begin());
+
+                m_conditions.push_back(c);
+                return m_conditions.size() - 1;
+            }
+
+            /*
+             * Drops duplicate terms and conditions of the conjuncts, which
+             * went to the residual filter. Empty term makes DNF always
+             * true.
+             */
+            result_type compact(terms_type &terms, Filter &residual) const
+            {
+                if (m_type == normal_form_type::dnf &&
+                    std::find(terms.begin(), terms.end(), term_type()) !=
+                    terms.end())
+                    terms.assign(1, term_type());
+
+                const std::size_t unused = static_cast<std::size_t>(-1);
+                std::vector<std::size_t> remap(m_conditions.size(), unused);
+
+                result_type out;
+                out.type = m_type;
+                for (term_type &t : terms)
+                {
+                    for (std::size_t &i : t)
+                    {
+                        if (remap[i] == unused)
+                        {
+                            remap[i] = out.conditions.size();
+                            out.conditions.push_back(m_conditions[i]);
+                        }
+                        i = remap[i];
+                    }
+                    std::sort(t.begin(), t.end());
+                }
+
+                std::sort(terms.begin(), terms.end());
+                terms.erase(std::unique(terms.begin(), terms.end()),
+                            terms.end());
+                out.terms.swap(terms);
+                out.residual = std::move(residual);
+                return out;
+            }
+
+            normal_form_type m_type;
+            std::size_t m_limit;
+            std::vector<condition_type> m_conditions;
+        };
+    }
+
+    /*
+     * Converts the filter to disjunctive normal form with at most limit
+     * terms. Empty filter gives one empty term.
+     */
+    template <typename Filter>
+    normal_form<Filter> to_dnf(const Filter &f,
+                               std::size_t limit = normal_form_limit)
+    {
+        return detail::normal_form_converter<Filter>(normal_form_type::dnf,
+                                                     limit)(f);
+    }
+
+    /*
+     * Converts the filter to conjunctive normal form with at most limit
+     * clauses. Empty filter gives no clauses.
+     */
+    template <typename Filter>
+    normal_form<Filter> to_cnf(const Filter &f,
+                               std::size_t limit = normal_form_limit)
+    {
+        return detail::normal_form_converter<Filter>(normal_form_type::cnf,
+                                                     limit)(f);
+    }
+}
+
+#endif //SIFTER_NORMAL_FORM_HPP
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_OPERAND_HPP
+#define SIFTER_OPERAND_HPP
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include "basic_filter.hpp"
+
+namespace sifter
+{
+    namespace detail
+    {
+        /*
+         * Operand kinds of text formats. Decoders store a value as the first
+         * operand type of its kind.
+         */
+        template <typename T>
+        struct identity
+        {
+            using type = T;
+        };
+
+        /*
+         * The first of Types, which satisfies Predicate, or void.
+         */
+        template <template <typename> class Predicate, typename... Types>
+        struct first_of : identity<void>
+        {
+        };
+
+        template <template <typename> class Predicate, typename T,
+                typename... Types>
+        struct first_of<Predicate, T, Types...>
+                : std::conditional<Predicate<T>::value, identity<T>,
+                                   first_of<Predicate, Types...>>::type
+        {
+        };
+
+        template <template <typename> class Predicate, typename Value>
+        struct first_alternative;
+
+        template <template <typename> class Predicate, typename... Types>
+        struct first_alternative<Predicate, variant<Types...>>
+                : first_of<Predicate, Types...>
+        {
+        };
+
+        template <typename T>
+        struct is_string_operand : std::false_type
+        {
+        };
+
+        template <typename Traits, typename Allocator>
+        struct is_string_operand<std::basic_string<char, Traits, Allocator>>
+                : std::true_type
+        {
+        };
+
+        template <typename T>
+        struct is_integer_operand
+                : std::integral_constant<bool,
+                                         std::is_integral<T>::value &&
+                                         !std::is_same<T, bool>::value>
+        {
+        };
+
+        template <typename T>
+        struct is_bool_operand : std::is_same<T, bool>
+        {
+        };
+
+        template <typename String>
+        String make_string(const allocator_type &a, std::true_type)
+        {
+            return String(a);
+        }
+
+        template <typename String>
+        String make_string(const allocator_type &, std::false_type)
+        {
+            return String();
+        }
+
+        /*
+         * Empty string operand, which uses the allocator if the string type
+         * is allocator-aware.
+         */
+        template <typename String>
+        String make_string(const allocator_type &a)
+        {
+            return make_string<String>(
+                    a, std::uses_allocator<String, allocator_type>());
+        }
+
+        /*
+         * Checks if the value is representable by integer type T.
+         */
+        template <typename T>
+        bool fits(long long value)
+        {
+            using limits = std::numeric_limits<T>;
+            return std::is_signed<T>::value
+                   ? value >= static_cast<long long>(limits::min()) &&
+                     value <= static_cast<long long>(limits::max())
+                   : value >= 0 &&
+                     static_cast<unsigned long long>(value) <=
+                     static_cast<unsigned long long>(limits::max());
+        }
+    }
+}
+
+#endif //SIFTER_OPERAND_HPP
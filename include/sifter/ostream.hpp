@@ -60,15 +60,18 @@ namespace sifter
         friend std::ostream& operator<<(std::ostream& out, const basic_out &o)
         {
             Dumper dumper(out);
-
-            if (o.m_filter)
-                dump(*o.m_filter, dumper);
-            else if (o.m_condition)
-                dump(*o.m_condition, dumper);
-
+            o.write(dumper);
             return out;
         }
 
+        void write(Dumper &dumper) const
+        {
+            if (m_filter)
+                dump(*m_filter, dumper);
+            else if (m_condition)
+                dump(*m_condition, dumper);
+        }
+
     private:
         static void dump(const condition_type &c, Dumper &dumper)
         {
@@ -124,6 +127,64 @@ namespace sifter
     template <typename Dumper, typename... Types>
     using out = basic_out<Dumper, comparison, eq, Types...>;
 
+    /*
+     * Text representation of special symbols, logic operators and
+     * comparisons, used by default and buffer dumpers. Defined inline, so
+     * the length of the returned literal is known at the call site.
+     */
+    inline const char *token(special value)
+    {
+        switch (value)
+        {
+            case special::filter_begin:
+                return "(";
+            case special::filter_end:
+                return ")";
+            case special::condition_begin:
+            case special::condition_end:
+                break;
+        }
+        return "";
+    }
+
+    inline const char *token(operation value)
+    {
+        switch (value)
+        {
+            case operation::_none:
+                break;
+            case operation::_and:
+                return "&&";
+            case operation::_or:
+                return "||";
+        }
+        return "";
+    }
+
+    inline const char *token(comparison value)
+    {
+        switch (value)
+        {
+            case eq:
+                return "==";
+            case ne:
+                return "!=";
+            case lt:
+                return "<";
+            case le:
+                return "<=";
+            case gt:
+                return ">";
+            case ge:
+                return ">=";
+            case like:
+                return "~";
+            case not_like:
+                return "!~";
+        }
+        return "";
+    }
+
     class default_dumper
     {
     public:
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_PARTIAL_HPP
+#define SIFTER_PARTIAL_HPP
+
+#include <map>
+#include "evaluate.hpp"
+
+namespace sifter
+{
+    enum class outcome
+    {
+        _false,
+        _true,
+        _residual
+    };
+
+    /*
+     * Result of partial evaluation: constant value or residual filter,
+     * containing conditions, which could not be decided.
+     */
+    template <typename Filter>
+    struct partial_result
+    {
+        outcome value;
+        Filter residual;
+    };
+
+    namespace detail
+    {
+        template <typename Field, comparison def_value, typename... Types>
+        class partial_evaluator
+        {
+        public:
+            using filter_type = basic_filter<comparison, def_value, Types...>;
+            using condition_type =
+                    basic_condition<comparison, def_value, Types...>;
+            using value_type = typename condition_type::value_type;
+            using result_type = partial_result<filter_type>;
+            using bindings_type = std::map<Field, value_type>;
+
+        public:
+            explicit partial_evaluator(const bindings_type &bindings)
+                : m_bindings(bindings)
+            {
+            }
+
+            result_type evaluate(const condition_type &c) const
+            {
+                condition_type out(c);
+                const bool lhs_known = substitute(out.lhs());
+                const bool rhs_known = substitute(out.rhs());
+
+                if (lhs_known && rhs_known)
+                {
+                    return constant(compare(out.comp(), out.lhs(),
+                                            out.rhs()));
+                }
+
+                return {outcome::_residual, filter_type(std::move(out))};
+            }
+
+            result_type evaluate(const filter_type &f) const
+            {
+                const bool has_lhs =
+                        f.left_is_filter() || f.left_is_condition();
+                const bool has_rhs =
+                        f.right_is_filter() || f.right_is_condition();
+
+                if (!has_lhs && !has_rhs)
+                    return constant(true);
+
+                if (!has_lhs)
+                    return evaluate_right(f);
+
+                result_type lhs = f.left_is_filter()
+                        ? evaluate(f.left_filter())
+                        : evaluate(f.left_condition());
+
+                if (!has_rhs || f.oper() == operation::_none)
+                    return lhs;
+
+                const bool is_and = f.oper() == operation::_and;
+                const outcome absorbing = is_and ? outcome::_false
+                                                 : outcome::_true;
+
+                if (lhs.value == absorbing)
+                    return lhs;
+
+                result_type rhs = evaluate_right(f);
+                if (rhs.value == absorbing)
+                    return rhs;
+
+                if (lhs.value != outcome::_residual)
+                    return rhs;
+
+                if (rhs.value != outcome::_residual)
+                    return lhs;
+
+                if (is_and)
+                    lhs.residual &= rhs.residual;
+                else
+                    lhs.residual |= rhs.residual;
+
+                return lhs;
+            }
+
+        private:
+            static result_type constant(bool value)
+            {
+                return {value ? outcome::_true : outcome::_false,
+                        filter_type()};
+            }
+
+            result_type evaluate_right(const filter_type &f) const
+            {
+                return f.right_is_filter() ? evaluate(f.right_filter())
+                                           : evaluate(f.right_condition());
+            }
+
+            bool substitute(value_type &operand) const
+            {
+                if (!sifter::holds_alternative<Field>(operand))
+                    return true;
+
+                const auto p = m_bindings.find(sifter::get<Field>(operand));
+                if (p == m_bindings.end())
+                    return false;
+
+                operand = p->second;
+                return true;
+            }
+
+        private:
+            const bindings_type &m_bindings;
+        };
+    }
+
+    /*
+     * Substitutes known field values into the filter, folds decided
+     * conditions and prunes dead branches. Returns constant value, if the
+     * filter is decided completely, or residual filter otherwise.
+     */
+    template <typename Field, comparison def_value, typename... Types>
+    partial_result<basic_filter<comparison, def_value, Types...>>
+    partially_evaluate(
+            const basic_filter<comparison, def_value, Types...> &f,
+            const std::map<Field, variant<Types...>> &bindings)
+    {
+        return detail::partial_evaluator<Field, def_value, Types...>(bindings)
+                .evaluate(f);
+    }
+
+    template <typename Field, comparison def_value, typename... Types>
+    partial_result<basic_filter<comparison, def_value, Types...>>
+    partially_evaluate(
+            const basic_condition<comparison, def_value, Types...> &c,
+            const std::map<Field, variant<Types...>> &bindings)
+    {
+        return detail::partial_evaluator<Field, def_value, Types...>(bindings)
+                .evaluate(c);
+    }
+}
+
+#endif //SIFTER_PARTIAL_HPP
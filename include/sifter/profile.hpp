@@ -0,0 +1,545 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_PROFILE_HPP
+#define SIFTER_PROFILE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "evaluate.hpp"
+#include "ostream.hpp"
+#include "thread_index.hpp"
+
+namespace sifter
+{
+    /*
+     * Counters of the filter node over the sampled evaluations: visits,
+     * visits with true result and inclusive time.
+     */
+    struct node_stats
+    {
+        std::uint64_t visits;
+        std::uint64_t passes;
+        std::uint64_t nanoseconds;
+    };
+
+    namespace detail
+    {
+        /*
+         * Numbers filter nodes and conditions in preorder, sizes[i] is
+         * the number of nodes in the subtree of i-th node.
+         */
+        template <typename Filter>
+        void number_nodes(const Filter &f, std::vector<std::size_t> &sizes)
+        {
+            const std::size_t id = sizes.size();
+            sizes.push_back(0);
+
+            if (f.left_is_filter())
+                number_nodes(f.left_filter(), sizes);
+            else if (f.left_is_condition())
+                sizes.push_back(1);
+
+            if (f.right_is_filter())
+                number_nodes(f.right_filter(), sizes);
+            else if (f.right_is_condition())
+                sizes.push_back(1);
+
+            sizes[id] = sizes.size() - id;
+        }
+    }
+
+    /*
+     * Per-node evaluation counters of one filter. Only each sample_period-th
+     * evaluation is instrumented, others only decrement the countdown, so
+     * the profile may be kept enabled in production. Counters are sharded by
+     * thread and updated by relaxed atomic operations, so concurrent
+     * evaluations don't lock and rarely share cache lines.
+     */
+    class evaluation_profile
+    {
+    public:
+        static const std::size_t default_period = 256;
+        static const std::size_t default_shards = 16;
+
+    public:
+        template <typename Filter>
+        explicit evaluation_profile(const Filter &f,
+                                    std::size_t sample_period = default_period,
+                                    std::size_t shards = default_shards)
+            : m_period(sample_period ? sample_period : 1),
+              m_shards(shards ? shards : 1)
+        {
+            detail::number_nodes(f, m_sizes);
+            m_stride = (header + fields * m_sizes.size() + line - 1) /
+                       line * line;
+            m_counters = std::vector<counter_type>(m_stride * m_shards);
+            reset();
+        }
+
+        evaluation_profile(const evaluation_profile &) = delete;
+
+        evaluation_profile &operator=(const evaluation_profile &) = delete;
+
+        std::size_t nodes() const
+        {
+            return m_sizes.size();
+        }
+
+        std::size_t subtree_size(std::size_t node) const
+        {
+            return m_sizes[node];
+        }
+
+        std::size_t sample_period() const
+        {
+            return m_period;
+        }
+
+        /*
+         * Number of the instrumented evaluations.
+         */
+        std::uint64_t samples() const
+        {
+            std::uint64_t out = 0;
+            for (std::size_t s = 0; s < m_shards; ++s)
+                out += m_counters[s * m_stride].load(
+                        std::memory_order_relaxed);
+            return out;
+        }
+
+        /*
+         * Sum of the node counters over all shards.
+         */
+        node_stats stats(std::size_t node) const
+        {
+            node_stats out = {0, 0, 0};
+            for (std::size_t s = 0; s < m_shards; ++s)
+            {
+                const counter_type *c = &m_counters[s * m_stride + header +
+                                                    node * fields];
+                out.visits += c[0].load(std::memory_order_relaxed);
+                out.passes += c[1].load(std::memory_order_relaxed);
+                out.nanoseconds += c[2].load(std::memory_order_relaxed);
+            }
+            return out;
+        }
+
+        void reset()
+        {
+            for (counter_type &c : m_counters)
+                c.store(0, std::memory_order_relaxed);
+        }
+
+        /*
+         * Returns node counters of the calling thread's shard, if this
+         * evaluation should be instrumented, and nullptr otherwise. The
+         * countdown is not decremented atomically: threads, sharing the
+         * shard, may only shift the sampling a bit.
+         */
+        std::atomic<std::uint64_t> *begin()
+        {
+            counter_type *shard = &m_counters[
+                    detail::thread_index() % m_shards * m_stride];
+            const std::uint64_t countdown = shard[1].load(
+                    std::memory_order_relaxed);
+            if (countdown)
+            {
+                shard[1].store(countdown - 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            shard[1].store(m_period - 1, std::memory_order_relaxed);
+            shard[0].fetch_add(1, std::memory_order_relaxed);
+            return shard + header;
+        }
+
+    private:
+        using counter_type = std::atomic<std::uint64_t>;
+
+        /*
+         * Shard starts with the number of samples and the countdown to the
+         * next one, followed by three counters per node, and is padded to
+         * the cache line.
+         */
+        static const std::size_t header = 2;
+        static const std::size_t fields = 3;
+        static const std::size_t line = 64 / sizeof(std::uint64_t);
+
+        std::size_t m_period;
+        std::size_t m_shards;
+        std::size_t m_stride;
+        std::vector<std::size_t> m_sizes;
+        std::vector<counter_type> m_counters;
+    };
+
+    /*
+     * Profile, which doesn't count anything: evaluation with it compiles
+     * to the plain evaluation.
+     */
+    struct null_profile
+    {
+        null_profile()
+        {
+        }
+
+        template <typename Filter>
+        explicit null_profile(const Filter &, std::size_t = 0,
+                              std::size_t = 0)
+        {
+        }
+    };
+
+    /*
+     * Profile type, selected by SIFTER_PROFILING macro.
+     */
+#ifdef SIFTER_PROFILING
+    using profile = evaluation_profile;
+#else
+    using profile = null_profile;
+#endif
+
+    namespace detail
+    {
+        template <typename Field, typename Record, typename Accessor,
+                typename Filter>
+        class profiled_evaluator
+        {
+        public:
+            using condition_type = typename Filter::condition_type;
+            using clock = std::chrono::steady_clock;
+
+        public:
+            profiled_evaluator(const Record &record, const Accessor &accessor,
+                               const evaluation_profile &profile,
+                               std::atomic<std::uint64_t> *counters)
+                : m_record(record),
+                  m_accessor(accessor),
+                  m_profile(profile),
+                  m_counters(counters)
+            {
+            }
+
+            bool evaluate(const Filter &f, std::size_t id)
+            {
+                const clock::time_point start = clock::now();
+                const std::size_t lhs_id = id + 1;
+                const std::size_t rhs_id = f.left_is_filter() ||
+                                           f.left_is_condition()
+                        ? lhs_id + m_profile.subtree_size(lhs_id)
+                        : lhs_id;
+
+                return record(id, evaluate_node(f, lhs_id, rhs_id), start);
+            }
+
+            bool evaluate(const condition_type &c, std::size_t id)
+            {
+                const clock::time_point start = clock::now();
+                return record(id, sifter::evaluate<Field>(c, m_record,
+                                                          m_accessor),
+                              start);
+            }
+
+        private:
+            /*
+             * Same as evaluate() of the filter, but with node numbers.
+             */
+            bool evaluate_node(const Filter &f, std::size_t lhs_id,
+                               std::size_t rhs_id)
+            {
+                const bool has_lhs = f.left_is_filter() ||
+                                     f.left_is_condition();
+                const bool has_rhs = f.right_is_filter() ||
+                                     f.right_is_condition();
+
+                if (has_lhs)
+                {
+                    const bool lhs = f.left_is_filter()
+                            ? evaluate(f.left_filter(), lhs_id)
+                            : evaluate(f.left_condition(), lhs_id);
+
+                    if (!has_rhs || f.oper() == operation::_none)
+                        return lhs;
+
+                    if (f.oper() == operation::_and && !lhs)
+                        return false;
+
+                    if (f.oper() == operation::_or && lhs)
+                        return true;
+                }
+
+                if (!has_rhs)
+                    return true;
+
+                return f.right_is_filter()
+                        ? evaluate(f.right_filter(), rhs_id)
+                        : evaluate(f.right_condition(), rhs_id);
+            }
+
+            bool record(std::size_t id, bool result, clock::time_point start)
+            {
+                const auto elapsed = std::chrono::duration_cast<
+                        std::chrono::nanoseconds>(clock::now() - start);
+
+                std::atomic<std::uint64_t> *c = m_counters + id * 3;
+                c[0].fetch_add(1, std::memory_order_relaxed);
+                if (result)
+                    c[1].fetch_add(1, std::memory_order_relaxed);
+                c[2].fetch_add(static_cast<std::uint64_t>(elapsed.count()),
+                               std::memory_order_relaxed);
+                return result;
+            }
+
+            const Record &m_record;
+            const Accessor &m_accessor;
+            const evaluation_profile &m_profile;
+            std::atomic<std::uint64_t> *m_counters;
+        };
+
+        inline void write_stats(std::ostream &out, const node_stats &s)
+        {
+            out << " visits=" << s.visits << " passes=" << s.passes;
+            if (s.visits)
+                out << " time=" << s.nanoseconds / s.visits << "ns";
+        }
+
+        inline void write_json_string(std::ostream &out,
+                                      const std::string &text)
+        {
+            static const char digits[] = "0123456789abcdef";
+
+            out << '"';
+            for (const char c : text)
+            {
+                const auto u = static_cast<unsigned char>(c);
+                if (c == '"' || c == '\\')
+                    out << '\\' << c;
+                else if (u < 0x20)
+                    out << "\\u00" << digits[u >> 4] << digits[u & 0xf];
+                else
+                    out << c;
+            }
+            out << '"';
+        }
+
+        inline void write_json_stats(std::ostream &out, const node_stats &s)
+        {
+            out << ",\"visits\":" << s.visits
+                << ",\"passes\":" << s.passes
+                << ",\"nanoseconds\":" << s.nanoseconds;
+        }
+
+        /*
+         * Writes filter tree with node counters as indented text or JSON.
+         */
+        template <comparison def_value, typename... Types>
+        class profile_writer
+        {
+        public:
+            using filter_type = basic_filter<comparison, def_value, Types...>;
+            using condition_type =
+                    basic_condition<comparison, def_value, Types...>;
+
+        public:
+            profile_writer(std::ostream &out,
+                           const evaluation_profile &profile)
+                : m_out(out),
+                  m_profile(profile)
+            {
+            }
+
+            void text(const filter_type &f, std::size_t id,
+                      std::size_t depth)
+            {
+                indent(depth);
+                const char *label = token(f.oper());
+                m_out << (*label ? label : "filter");
+                write_stats(m_out, m_profile.stats(id));
+                m_out << '\n';
+
+                std::size_t child = id + 1;
+                if (f.left_is_filter())
+                    text(f.left_filter(), child, depth + 1);
+                else if (f.left_is_condition())
+                    text(f.left_condition(), child, depth + 1);
+
+                if (f.left_is_filter() || f.left_is_condition())
+                    child += m_profile.subtree_size(child);
+
+                if (f.right_is_filter())
+                    text(f.right_filter(), child, depth + 1);
+                else if (f.right_is_condition())
+                    text(f.right_condition(), child, depth + 1);
+            }
+
+            void text(const condition_type &c, std::size_t id,
+                      std::size_t depth)
+            {
+                indent(depth);
+                m_out << condition_text(c);
+                write_stats(m_out, m_profile.stats(id));
+                m_out << '\n';
+            }
+
+            void json(const filter_type &f, std::size_t id)
+            {
+                const char *label = token(f.oper());
+                m_out << "{\"node\":";
+                write_json_string(m_out, *label ? label : "filter");
+                write_json_stats(m_out, m_profile.stats(id));
+                m_out << ",\"children\":[";
+
+                std::size_t child = id + 1;
+                if (f.left_is_filter())
+                    json(f.left_filter(), child);
+                else if (f.left_is_condition())
+                    json(f.left_condition(), child);
+
+                const bool has_lhs = f.left_is_filter() ||
+                                     f.left_is_condition();
+                if (has_lhs)
+                    child += m_profile.subtree_size(child);
+
+                if (has_lhs && (f.right_is_filter() ||
+                                f.right_is_condition()))
+                    m_out << ',';
+
+                if (f.right_is_filter())
+                    json(f.right_filter(), child);
+                else if (f.right_is_condition())
+                    json(f.right_condition(), child);
+
+                m_out << "]}";
+            }
+
+            void json(const condition_type &c, std::size_t id)
+            {
+                m_out << "{\"condition\":";
+                write_json_string(m_out, condition_text(c));
+                write_json_stats(m_out, m_profile.stats(id));
+                m_out << '}';
+            }
+
+        private:
+            static std::string condition_text(const condition_type &c)
+            {
+                std::ostringstream out;
+                out << basic_out<default_dumper, comparison, def_value,
+                        Types...>(c);
+                return out.str();
+            }
+
+            void indent(std::size_t depth)
+            {
+                for (std::size_t i = 0; i < depth; ++i)
+                    m_out << "    ";
+            }
+
+            std::ostream &m_out;
+            const evaluation_profile &m_profile;
+        };
+    }
+
+    /*
+     * Evaluates filter. If the evaluation is sampled, visits, passes and
+     * time of each node are counted in the profile, which should be built
+     * from the same filter.
+     */
+    template <typename Field, typename Record, typename Accessor,
+            comparison def_value, typename... Types>
+    bool evaluate(const basic_filter<comparison, def_value, Types...> &f,
+                  const Record &record, const Accessor &accessor,
+                  evaluation_profile &profile)
+    {
+        std::atomic<std::uint64_t> *counters = profile.begin();
+        if (!counters)
+            return evaluate<Field>(f, record, accessor);
+
+        return detail::profiled_evaluator<Field, Record, Accessor,
+                basic_filter<comparison, def_value, Types...>>(
+                record, accessor, profile, counters).evaluate(f, 0);
+    }
+
+    template <typename Field, typename Record, typename Accessor,
+            comparison def_value, typename... Types>
+    bool evaluate(const basic_filter<comparison, def_value, Types...> &f,
+                  const Record &record, const Accessor &accessor,
+                  null_profile &)
+    {
+        return evaluate<Field>(f, record, accessor);
+    }
+
+    /*
+     * Writes the number of samples and the sample period, then the filter
+     * tree, annotated by the node counters, one node per line. The counters
+     * cover the sampled evaluations only.
+     */
+    template <comparison def_value, typename... Types>
+    void explain(std::ostream &out,
+                 const basic_filter<comparison, def_value, Types...> &f,
+                 const evaluation_profile &profile)
+    {
+        out << "samples=" << profile.samples()
+            << " sample_period=" << profile.sample_period() << '\n';
+        detail::profile_writer<def_value, Types...>(out, profile).text(f, 0,
+                                                                       0);
+    }
+
+    template <comparison def_value, typename... Types>
+    void explain(std::ostream &,
+                 const basic_filter<comparison, def_value, Types...> &,
+                 const null_profile &)
+    {
+    }
+
+    /*
+     * Writes JSON object with the number of samples, the sample period and
+     * the annotated filter tree.
+     */
+    template <comparison def_value, typename... Types>
+    void explain_json(std::ostream &out,
+                      const basic_filter<comparison, def_value, Types...> &f,
+                      const evaluation_profile &profile)
+    {
+        out << "{\"samples\":" << profile.samples()
+            << ",\"sample_period\":" << profile.sample_period()
+            << ",\"tree\":";
+        detail::profile_writer<def_value, Types...>(out, profile).json(f, 0);
+        out << '}';
+    }
+
+    template <comparison def_value, typename... Types>
+    void explain_json(std::ostream &out,
+                      const basic_filter<comparison, def_value, Types...> &,
+                      const null_profile &)
+    {
+        out << "null";
+    }
+}
+
+#endif //SIFTER_PROFILE_HPP
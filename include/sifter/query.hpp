@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_QUERY_HPP
+#define SIFTER_QUERY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "filter.hpp"
+#include "operand.hpp"
+
+#ifdef SIFTER_USE_BOOST_VARIANT
+#include <boost/utility/string_view.hpp>
+#else
+#include <string_view>
+#endif
+
+namespace sifter
+{
+#ifdef SIFTER_USE_BOOST_VARIANT
+    using string_view = boost::string_view;
+#else
+    using string_view = std::string_view;
+#endif
+
+    /*
+     * Thrown if the query string doesn't describe a filter. Offset points to
+     * the byte of the query, where the error was found.
+     */
+    class query_error : public std::invalid_argument
+    {
+    public:
+        query_error(const std::string &what, std::size_t offset);
+
+        std::size_t offset() const;
+
+    private:
+        std::size_t m_offset;
+    };
+
+    namespace detail
+    {
+        /*
+         * Escaped components are decoded to the stack buffer of this size,
+         * longer ones are rejected. Components without escapes are not
+         * limited.
+         */
+        const std::size_t query_buffer_size = 1024;
+
+        /*
+         * Maximal depth of the decoded filter. Terms and alternatives are
+         * joined one level per item, and the tree is destroyed and walked
+         * recursively, so longer queries are rejected instead of exhausting
+         * the stack.
+         */
+        const std::size_t query_tree_depth = 1024;
+
+        bool query_escaped(const char *data, std::size_t size);
+
+        /*
+         * Writes percent-decoded text ('+' is decoded to space) to out, which
+         * should have at least size characters. Returns false for malformed
+         * escape.
+         */
+        bool query_unescape(const char *data, std::size_t size, char *out,
+                            std::size_t &out_size);
+
+        bool query_comparison(const char *data, std::size_t size,
+                              comparison &out);
+
+        bool query_integer(const char *data, std::size_t size,
+                           long long &out);
+
+        bool query_floating(const char *data, std::size_t size, double &out);
+    }
+
+    /*
+     * Default value map of decode_query(): the text is stored as the first
+     * integer operand type if it is an integer, then as floating point,
+     * boolean ("true" or "false") and string type. The field is ignored.
+     */
+    template <typename Filter>
+    class query_values
+    {
+    public:
+        using value_type = typename Filter::condition_type::value_type;
+
+        explicit query_values(const allocator_type &a = allocator_type())
+            : m_allocator(a)
+        {
+        }
+
+        template <typename Field>
+        bool operator()(Field, string_view text, value_type &out) const
+        {
+            return integer(text, out, detail::identity<integer_type>()) ||
+                   floating(text, out, detail::identity<floating_type>()) ||
+                   boolean(text, out, detail::identity<bool_type>()) ||
+                   string(text, out, detail::identity<string_type>());
+        }
+
+    private:
+        using string_type = typename detail::first_alternative<
+                detail::is_string_operand, value_type>::type;
+        using integer_type = typename detail::first_alternative<
+                detail::is_integer_operand, value_type>::type;
+        using floating_type = typename detail::first_alternative<
+                std::is_floating_point, value_type>::type;
+        using bool_type = typename detail::first_alternative<
+                detail::is_bool_operand, value_type>::type;
+
+        static bool integer(string_view, value_type &, detail::identity<void>)
+        {
+            return false;
+        }
+
+        template <typename Integer>
+        static bool integer(string_view text, value_type &out,
+                            detail::identity<Integer>)
+        {
+            long long value = 0;
+            if (!detail::query_integer(text.data(), text.size(), value) ||
+                !detail::fits<Integer>(value))
+                return false;
+
+            out.template emplace<Integer>(static_cast<Integer>(value));
+            return true;
+        }
+
+        static bool floating(string_view, value_type &,
+                             detail::identity<void>)
+        {
+            return false;
+        }
+
+        template <typename Floating>
+        static bool floating(string_view text, value_type &out,
+                             detail::identity<Floating>)
+        {
+            double value = 0;
+            if (!detail::query_floating(text.data(), text.size(), value))
+                return false;
+
+            out.template emplace<Floating>(static_cast<Floating>(value));
+            return true;
+        }
+
+        static bool boolean(string_view, value_type &, detail::identity<void>)
+        {
+            return false;
+        }
+
+        template <typename Bool>
+        static bool boolean(string_view text, value_type &out,
+                            detail::identity<Bool>)
+        {
+            if (text != "true" && text != "false")
+                return false;
+
+            out.template emplace<Bool>(text == "true");
+            return true;
+        }
+
+        bool string(string_view, value_type &, detail::identity<void>) const
+        {
+            return false;
+        }
+
+        template <typename String>
+        bool string(string_view text, value_type &out,
+                    detail::identity<String>) const
+        {
+            String s = detail::make_string<String>(m_allocator);
+            s.assign(text.data(), text.size());
+            out.template emplace<String>(std::move(s));
+            return true;
+        }
+
+        allocator_type m_allocator;
+    };
+
+    namespace detail
+    {
+        template <typename Field, typename Filter, typename FieldMap,
+                typename ValueMap>
+        class query_decoder
+        {
+        public:
+            using condition_type = typename Filter::condition_type;
+
+            query_decoder(string_view query, const FieldMap &fields,
+                          const ValueMap &values, const allocator_type &a)
+                : m_begin(query.data()),
+                  m_end(query.data() + query.size()),
+                  m_fields(fields),
+                  m_values(values),
+                  m_allocator(a)
+            {
+            }
+
+            Filter decode()
+            {
+                Filter f(m_allocator);
+
+                const char *begin = m_begin;
+                if (begin != m_end && *begin == '?')
+                    ++begin;
+
+                while (begin != m_end)
+                {
+                    const char *end = std::find(begin, m_end, '&');
+                    if (end != begin)
+                        term(f, begin, end);
+
+                    if (f.depth() > query_tree_depth)
+                        fail(begin, "filter is too deep");
+
+                    begin = end == m_end ? end : end + 1;
+                }
+                return f;
+            }
+
+        private:
+            /*
+             * Term "field=[comparison:]value" or "or=alternative,...".
+             */
+            void term(Filter &f, const char *begin, const char *end)
+            {
+                const char *eq = std::find(begin, end, '=');
+                if (eq == end)
+                    fail(end, "'=' expected");
+
+                const string_view key = text(begin, eq);
+                if (key == "or")
+                {
+                    Filter any(m_allocator);
+                    alternatives(any, eq + 1, end);
+                    compose(f, std::move(any));
+                    return;
+                }
+
+                condition_type c;
+                condition(c, key, begin, eq + 1, end);
+                compose(f, std::move(c));
+            }
+
+            /*
+             * Alternatives "field:[comparison:]value", separated by comma.
+             */
+            void alternatives(Filter &f, const char *begin, const char *end)
+            {
+                while (begin != end)
+                {
+                    const char *alternative_end = std::find(begin, end, ',');
+                    const char *colon = std::find(begin, alternative_end, ':');
+                    if (colon == alternative_end)
+                        fail(alternative_end, "':' expected");
+
+                    condition_type c;
+                    condition(c, text(begin, colon), begin, colon + 1,
+                              alternative_end);
+                    if (!f)
+                        f = std::move(c);
+                    else
+                        f |= std::move(c);
+
+                    if (f.depth() > query_tree_depth)
+                        fail(begin, "filter is too deep");
+
+                    begin = alternative_end == end ? end : alternative_end + 1;
+                }
+            }
+
+            void condition(condition_type &c, string_view key,
+                           const char *key_begin, const char *begin,
+                           const char *end)
+            {
+                Field field;
+                if (!m_fields(key, field))
+                    fail(key_begin, "unknown field");
+
+                comparison comp = eq;
+                const char *colon = std::find(begin, end, ':');
+                if (colon != end &&
+                    query_comparison(begin, static_cast<std::size_t>(
+                            colon - begin), comp))
+                    begin = colon + 1;
+
+                c.lhs().template emplace<Field>(field);
+                c.comp() = comp;
+                if (!m_values(field, text(begin, end), c.rhs()))
+                    fail(begin, "invalid value");
+            }
+
+            /*
+             * Decoded component: the source range itself, if it has no
+             * escapes, otherwise the buffer, valid until the next call.
+             */
+            string_view text(const char *begin, const char *end)
+            {
+                const auto size = static_cast<std::size_t>(end - begin);
+                if (!query_escaped(begin, size))
+                    return string_view(begin, size);
+
+                if (size > query_buffer_size)
+                    fail(begin, "escaped component is too long");
+
+                std::size_t out_size = 0;
+                if (!query_unescape(begin, size, m_buffer, out_size))
+                    fail(begin, "invalid escape");
+
+                return string_view(m_buffer, out_size);
+            }
+
+            static void compose(Filter &f, condition_type &&c)
+            {
+                if (!f)
+                    f = std::move(c);
+                else
+                    f &= std::move(c);
+            }
+
+            static void compose(Filter &f, Filter &&any)
+            {
+                if (!f)
+                    f = std::move(any);
+                else
+                    f &= std::move(any);
+            }
+
+            [[noreturn]] void fail(const char *at, const char *what) const
+            {
+                throw query_error(what, static_cast<std::size_t>(at - m_begin));
+            }
+
+            const char *m_begin;
+            const char *m_end;
+            const FieldMap &m_fields;
+            const ValueMap &m_values;
+            const allocator_type &m_allocator;
+            char m_buffer[query_buffer_size];
+        };
+    }
+
+    /*
+     * Builds filter from the URL query string, e.g.
+     * "age=gt:20&name=like:J%25&or=id:1,id:lt:0". Terms, separated by '&',
+     * are joined by AND: "field=value" is a condition, "or=" term joins
+     * "field:value" alternatives, separated by ',', by OR. Value may be
+     * prefixed by the comparison: "eq:" (default), "ne:", "lt:", "le:",
+     * "gt:", "ge:", "like:" or "nlike:". Components are percent-decoded
+     * after splitting, so '&', ',' and '=' in values should be escaped.
+     * Escaped components are decoded to the stack buffer and may not be
+     * longer than 1024 bytes, so the decoder allocates only filter nodes.
+     * Field map is called as bool(string_view name, Field &out), value map -
+     * as bool(Field, string_view text, value_type &out); both return false
+     * to reject the text. Throws query_error.
+     */
+    template <typename Field, typename Filter, typename FieldMap,
+            typename ValueMap>
+    Filter decode_query(string_view query, const FieldMap &fields,
+                        const ValueMap &values,
+                        const allocator_type &a = allocator_type())
+    {
+        return detail::query_decoder<Field, Filter, FieldMap, ValueMap>(
+                query, fields, values, a).decode();
+    }
+
+    template <typename Field, typename Filter, typename FieldMap>
+    Filter decode_query(string_view query, const FieldMap &fields)
+    {
+        return decode_query<Field, Filter>(query, fields,
+                                           query_values<Filter>());
+    }
+}
+
+#endif //SIFTER_QUERY_HPP
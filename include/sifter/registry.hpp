@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_REGISTRY_HPP
+#define SIFTER_REGISTRY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "thread_index.hpp"
+
+namespace sifter
+{
+    /*
+     * Named immutable values, e.g. filters, flattened filters or bound
+     * predicates, which are read concurrently and replaced at runtime.
+     *
+     * Every change publishes new version of the map by single atomic
+     * exchange. Readers take snapshot of the current version without locks
+     * and waits: they only increment the counter of the current epoch parity
+     * in their shard. The replaced version is retired instead of waiting for
+     * its readers. A reader of the retired version has incremented its
+     * counter before the exchange, so once the counters of both parities are
+     * seen zero after the exchange, nobody can see it and it is deleted (RCU
+     * grace period). Retired versions are checked without waiting by later
+     * updates and by reclaim(), the epoch is flipped to let the counter, new
+     * readers come to, drain. Values, which are not changed, are shared
+     * between versions, so a version costs one map of pointers. Writers are
+     * serialized by mutex, so a batch of changes should be published by
+     * single update().
+     */
+    template <typename Key, typename Value>
+    class registry
+    {
+    public:
+        using map_type = std::map<Key, std::shared_ptr<const Value>>;
+
+    public:
+        /*
+         * Version of the registry, which stays valid until the snapshot is
+         * destroyed. Snapshot should not outlive the registry. Writers don't
+         * wait for it, but the versions, retired while it is held, are kept
+         * until it is released.
+         */
+        class snapshot
+        {
+        public:
+            snapshot(snapshot &&s) noexcept
+                : m_map(s.m_map),
+                  m_readers(s.m_readers)
+            {
+                s.m_readers = nullptr;
+            }
+
+            snapshot(const snapshot &) = delete;
+
+            snapshot &operator=(const snapshot &) = delete;
+
+            ~snapshot()
+            {
+                if (m_readers)
+                    m_readers->fetch_sub(1, std::memory_order_release);
+            }
+
+            const Value *find(const Key &key) const
+            {
+                const auto it = m_map->find(key);
+                return it == m_map->end() ? nullptr : it->second.get();
+            }
+
+            const map_type &items() const
+            {
+                return *m_map;
+            }
+
+            std::size_t size() const
+            {
+                return m_map->size();
+            }
+
+        private:
+            friend class registry;
+
+            snapshot(const map_type *map, std::atomic<std::size_t> *readers)
+                : m_map(map),
+                  m_readers(readers)
+            {
+            }
+
+            const map_type *m_map;
+            std::atomic<std::size_t> *m_readers;
+        };
+
+    public:
+        registry()
+            : m_current(new map_type()),
+              m_epoch(0)
+        {
+            for (shard &s : m_shards)
+            {
+                s.readers[0].store(0);
+                s.readers[1].store(0);
+            }
+        }
+
+        registry(const registry &) = delete;
+
+        registry &operator=(const registry &) = delete;
+
+        /*
+         * Deletes the current and all retired versions, so snapshots should
+         * be released before.
+         */
+        ~registry()
+        {
+            delete m_current.load();
+        }
+
+        snapshot read() const
+        {
+            shard &s = m_shards[detail::thread_index() % shards];
+            std::atomic<std::size_t> &readers = s.readers[m_epoch.load() & 1];
+            readers.fetch_add(1);
+            return snapshot(m_current.load(), &readers);
+        }
+
+        void set(const Key &key, Value value)
+        {
+            std::shared_ptr<const Value> p =
+                    std::make_shared<const Value>(std::move(value));
+            update(setter{key, p});
+        }
+
+        void erase(const Key &key)
+        {
+            update(eraser{key});
+        }
+
+        /*
+         * Calls updater with the copy of the current map and publishes it.
+         * The replaced version is retired and deleted later, so update
+         * doesn't wait for readers and may be called by the thread, which
+         * holds a snapshot.
+         */
+        template <typename Updater>
+        void update(Updater updater)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::unique_ptr<map_type> next(new map_type(*m_current.load()));
+            updater(*next);
+
+            m_retired.reserve(m_retired.size() + 1);
+            m_retired.push_back(retired_version{
+                    std::unique_ptr<map_type>(m_current.exchange(
+                            next.release())), 0});
+            ++m_retired_total;
+            collect();
+        }
+
+        /*
+         * Deletes retired versions, which can't be seen by readers anymore,
+         * without waiting. It may be called periodically, e.g. by a
+         * background thread, if updates are rare. Returns number of versions,
+         * which are still retired.
+         */
+        std::size_t reclaim()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            collect();
+            return m_retired.size();
+        }
+
+        /*
+         * Waits until all versions, retired before the call, are deleted.
+         * The mutex is not held while waiting, so writers are not blocked,
+         * but the calling thread should not hold a snapshot.
+         */
+        void synchronize()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            const std::size_t target = m_retired_total;
+            for (;;)
+            {
+                collect();
+                if (m_reclaimed_total >= target)
+                    return;
+
+                lock.unlock();
+                std::this_thread::yield();
+                lock.lock();
+            }
+        }
+
+    private:
+        static const std::size_t shards = 16;
+
+        struct shard
+        {
+            alignas(64) std::atomic<std::size_t> readers[2];
+        };
+
+        struct setter
+        {
+            const Key &key;
+            std::shared_ptr<const Value> &value;
+
+            void operator()(map_type &map) const
+            {
+                map[key] = std::move(value);
+            }
+        };
+
+        struct eraser
+        {
+            const Key &key;
+
+            void operator()(map_type &map) const
+            {
+                map.erase(key);
+            }
+        };
+
+        /*
+         * Replaced version and the parities, whose counters were seen zero
+         * since it was replaced.
+         */
+        struct retired_version
+        {
+            std::unique_ptr<map_type> map;
+            unsigned quiet;
+        };
+
+        /*
+         * Marks parities without readers and deletes versions, quiet in
+         * both parities. Reader might read the epoch long before the
+         * exchange, so readers of both parities might see a version. Older
+         * versions are marked by all checks of the newer ones, so they are
+         * deleted in order of retirement. Called under the mutex.
+         */
+        void collect()
+        {
+            const unsigned quiet = (readers(0) ? 0u : 1u) |
+                                   (readers(1) ? 0u : 2u);
+
+            std::size_t deleted = 0;
+            for (retired_version &r : m_retired)
+            {
+                r.quiet |= quiet;
+                if (r.quiet == 3)
+                    ++deleted;
+            }
+            m_retired.erase(m_retired.begin(), m_retired.begin() +
+                    static_cast<std::ptrdiff_t>(deleted));
+            m_reclaimed_total += deleted;
+
+            /*
+             * New readers come to the current parity, so it may be never
+             * quiet: flip the epoch to let it drain.
+             */
+            const unsigned current = 1u << (m_epoch.load() & 1);
+            if (!m_retired.empty() && !(m_retired.back().quiet & current))
+                m_epoch.fetch_add(1);
+        }
+
+        std::size_t readers(std::size_t parity) const
+        {
+            std::size_t out = 0;
+            for (const shard &s : m_shards)
+                out += s.readers[parity].load();
+            return out;
+        }
+
+        std::atomic<map_type *> m_current;
+        std::atomic<std::size_t> m_epoch;
+        mutable shard m_shards[shards];
+        std::mutex m_mutex;
+        std::vector<retired_version> m_retired;
+        std::size_t m_retired_total = 0;
+        std::size_t m_reclaimed_total = 0;
+    };
+}
+
+#endif //SIFTER_REGISTRY_HPP
@@ -0,0 +1,551 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_SCHEMA_HPP
+#define SIFTER_SCHEMA_HPP
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include "flat.hpp"
+#include "static_filter.hpp"
+
+namespace sifter
+{
+    /*
+     * Thrown if the filter can't be bound to the schema: it uses unknown
+     * field, the operand type differs from the member type, or "like" is
+     * applied to non-string member.
+     */
+    class schema_error : public std::invalid_argument
+    {
+    public:
+        explicit schema_error(const std::string &what)
+            : std::invalid_argument(what)
+        {
+        }
+    };
+
+    /*
+     * Condition, bound to the record type. It calls the test, instantiated
+     * for the member type and comparison, so there is no variant dispatch.
+     */
+    template <typename Record>
+    class bound_condition
+    {
+    public:
+        using test_type = bool (*)(const void *, const Record &);
+
+    public:
+        bound_condition()
+            : m_test(nullptr)
+        {
+        }
+
+        bound_condition(test_type test, std::shared_ptr<const void> data)
+            : m_test(test),
+              m_data(std::move(data))
+        {
+        }
+
+        bool operator()(const Record &record) const
+        {
+            return m_test(m_data.get(), record);
+        }
+
+    private:
+        test_type m_test;
+        std::shared_ptr<const void> m_data;
+    };
+
+    namespace detail
+    {
+        template <typename Record>
+        class bound_test
+        {
+        public:
+            explicit bound_test(const Record &record)
+                : m_record(record)
+            {
+            }
+
+            bool operator()(const bound_condition<Record> &c) const
+            {
+                return c(m_record);
+            }
+
+        private:
+            const Record &m_record;
+        };
+    }
+
+    /*
+     * Filter, bound to the record type by schema.
+     */
+    template <typename Record>
+    class bound_filter
+    {
+    public:
+        using record_type = Record;
+        using condition_type = bound_condition<Record>;
+        using program_type = flat_filter<condition_type>;
+
+    public:
+        bound_filter() = default;
+
+        explicit bound_filter(program_type program)
+            : m_program(std::move(program))
+        {
+        }
+
+        bool operator()(const Record &record) const
+        {
+            return m_program.run(detail::bound_test<Record>(record));
+        }
+
+        const program_type &program() const
+        {
+            return m_program;
+        }
+
+    private:
+        program_type m_program;
+    };
+
+    namespace detail
+    {
+        enum class operand_order
+        {
+            field_value,
+            value_field,
+            field_field
+        };
+
+        template <typename Record, typename T>
+        struct member_value
+        {
+            member_value(T Record::*m, const T &v)
+                : member(m),
+                  value(v)
+            {
+            }
+
+            T Record::*member;
+            T value;
+        };
+
+        template <typename Record, typename T>
+        struct member_pair
+        {
+            member_pair(T Record::*l, T Record::*r)
+                : lhs(l),
+                  rhs(r)
+            {
+            }
+
+            T Record::*lhs;
+            T Record::*rhs;
+        };
+
+        template <typename Record>
+        bool bound_true(const void *, const Record &)
+        {
+            return true;
+        }
+
+        template <typename Record>
+        bool bound_false(const void *, const Record &)
+        {
+            return false;
+        }
+
+        /*
+         * Tests for the member type, instantiated for each comparison and
+         * order of operands.
+         */
+        template <typename Record, typename T>
+        class bound_tests
+        {
+        public:
+            using test_type = typename bound_condition<Record>::test_type;
+
+        public:
+            static test_type select(comparison c, operand_order o)
+            {
+                switch (c)
+                {
+                    case eq:
+                        return select<eq>(o);
+                    case ne:
+                        return select<ne>(o);
+                    case lt:
+                        return select<lt>(o);
+                    case le:
+                        return select<le>(o);
+                    case gt:
+                        return select<gt>(o);
+                    case ge:
+                        return select<ge>(o);
+                    case like:
+                    case not_like:
+                        return select_like(c, o,
+                                           std::is_same<T, std::string>());
+                }
+                return nullptr;
+            }
+
+        private:
+            template <comparison c>
+            static bool field_value(const void *data, const Record &record)
+            {
+                const auto &d = *static_cast<const member_value<Record, T> *>(
+                        data);
+                return static_compare(comparison_tag<c>(),
+                                      record.*d.member, d.value);
+            }
+
+            template <comparison c>
+            static bool value_field(const void *data, const Record &record)
+            {
+                const auto &d = *static_cast<const member_value<Record, T> *>(
+                        data);
+                return static_compare(comparison_tag<c>(),
+                                      d.value, record.*d.member);
+            }
+
+            template <comparison c>
+            static bool field_field(const void *data, const Record &record)
+            {
+                const auto &d = *static_cast<const member_pair<Record, T> *>(
+                        data);
+                return static_compare(comparison_tag<c>(),
+                                      record.*d.lhs, record.*d.rhs);
+            }
+
+            template <comparison c>
+            static test_type select(operand_order o)
+            {
+                switch (o)
+                {
+                    case operand_order::field_value:
+                        return &field_value<c>;
+                    case operand_order::value_field:
+                        return &value_field<c>;
+                    case operand_order::field_field:
+                        return &field_field<c>;
+                }
+                return nullptr;
+            }
+
+            static test_type select_like(comparison c, operand_order o,
+                                         std::true_type)
+            {
+                return c == like ? select<like>(o) : select<not_like>(o);
+            }
+
+            static test_type select_like(comparison, operand_order,
+                                         std::false_type)
+            {
+                return nullptr;
+            }
+        };
+
+        template <typename Record, typename T>
+        typename bound_tests<Record, T>::test_type select_test(
+                comparison c, operand_order o)
+        {
+            const auto test = bound_tests<Record, T>::select(c, o);
+            if (!test)
+                throw schema_error("\"like\" is applicable to strings only");
+
+            return test;
+        }
+
+        /*
+         * Calls visitor with the schema field, having the identifier.
+         */
+        template <typename... Fields>
+        struct field_finder;
+
+        template <>
+        struct field_finder<>
+        {
+            template <typename Id, typename Visitor>
+            static void apply(Id, Visitor &)
+            {
+                throw schema_error("field is not in the schema");
+            }
+        };
+
+        template <typename Field, typename... Fields>
+        struct field_finder<Field, Fields...>
+        {
+            template <typename Id, typename Visitor>
+            static void apply(Id id, Visitor &visitor)
+            {
+                if (Field::key() == id)
+                    visitor(Field());
+                else
+                    field_finder<Fields...>::apply(id, visitor);
+            }
+        };
+
+        /*
+         * Binds value operand to the member, if the value holds alternative
+         * of the member type.
+         */
+        template <typename Record, typename T>
+        class value_binder
+        {
+        public:
+            value_binder(T Record::*member, comparison c, operand_order o)
+                : m_member(member),
+                  m_comp(c),
+                  m_order(o)
+            {
+            }
+
+            template <typename U>
+            bound_condition<Record> operator()(const U &value) const
+            {
+                return bind(value, std::is_same<U, T>());
+            }
+
+        private:
+            bound_condition<Record> bind(const T &value, std::true_type) const
+            {
+                return bound_condition<Record>(
+                        select_test<Record, T>(m_comp, m_order),
+                        std::make_shared<const member_value<Record, T>>(
+                                m_member, value));
+            }
+
+            template <typename U>
+            bound_condition<Record> bind(const U &, std::false_type) const
+            {
+                throw schema_error("operand type differs from field type");
+            }
+
+            T Record::*m_member;
+            comparison m_comp;
+            operand_order m_order;
+        };
+
+        template <typename Record, typename Value>
+        class field_value_binder
+        {
+        public:
+            field_value_binder(const Value &value, comparison c,
+                               operand_order o)
+                : m_value(value),
+                  m_comp(c),
+                  m_order(o)
+            {
+            }
+
+            template <typename Field>
+            void operator()(Field)
+            {
+                using value_type = typename Field::value_type;
+
+                result = sifter::visit(value_binder<Record, value_type>(
+                        Field::pointer(), m_comp, m_order), m_value);
+            }
+
+            bound_condition<Record> result;
+
+        private:
+            const Value &m_value;
+            comparison m_comp;
+            operand_order m_order;
+        };
+
+        template <typename Record, typename Lhs>
+        class second_field_binder
+        {
+        public:
+            explicit second_field_binder(comparison c)
+                : m_comp(c)
+            {
+            }
+
+            template <typename Rhs>
+            void operator()(Rhs)
+            {
+                bind<Rhs>(std::is_same<typename Lhs::value_type,
+                        typename Rhs::value_type>());
+            }
+
+            bound_condition<Record> result;
+
+        private:
+            template <typename Rhs>
+            void bind(std::true_type)
+            {
+                using value_type = typename Lhs::value_type;
+
+                result = bound_condition<Record>(
+                        select_test<Record, value_type>(
+                                m_comp, operand_order::field_field),
+                        std::make_shared<const member_pair<Record, value_type>>(
+                                Lhs::pointer(), Rhs::pointer()));
+            }
+
+            template <typename Rhs>
+            void bind(std::false_type)
+            {
+                throw schema_error("compared fields have different types");
+            }
+
+            comparison m_comp;
+        };
+
+        template <typename Record, typename Id, typename... Fields>
+        class field_field_binder
+        {
+        public:
+            field_field_binder(Id rhs, comparison c)
+                : m_rhs(rhs),
+                  m_comp(c)
+            {
+            }
+
+            template <typename Lhs>
+            void operator()(Lhs)
+            {
+                second_field_binder<Record, Lhs> binder(m_comp);
+                field_finder<Fields...>::apply(m_rhs, binder);
+                result = binder.result;
+            }
+
+            bound_condition<Record> result;
+
+        private:
+            Id m_rhs;
+            comparison m_comp;
+        };
+
+        /*
+         * Converts conditions of the filter to bound ones.
+         */
+        template <typename Record, typename Id, typename... Fields>
+        class condition_binder
+        {
+        public:
+            template <comparison def_value, typename... Types>
+            bound_condition<Record> operator()(
+                    const basic_condition<comparison, def_value, Types...> &c)
+                    const
+            {
+                const bool lhs_field = sifter::holds_alternative<Id>(c.lhs());
+                const bool rhs_field = sifter::holds_alternative<Id>(c.rhs());
+
+                if (lhs_field && rhs_field)
+                {
+                    field_field_binder<Record, Id, Fields...> binder(
+                            sifter::get<Id>(c.rhs()), c.comp());
+                    field_finder<Fields...>::apply(sifter::get<Id>(c.lhs()),
+                                                   binder);
+                    return binder.result;
+                }
+
+                if (lhs_field)
+                    return bind_value(sifter::get<Id>(c.lhs()), c.rhs(),
+                                      c.comp(), operand_order::field_value);
+
+                if (rhs_field)
+                    return bind_value(sifter::get<Id>(c.rhs()), c.lhs(),
+                                      c.comp(), operand_order::value_field);
+
+                return bound_condition<Record>(
+                        compare(c.comp(), c.lhs(), c.rhs())
+                                ? &bound_true<Record> : &bound_false<Record>,
+                        nullptr);
+            }
+
+        private:
+            template <typename Value>
+            static bound_condition<Record> bind_value(Id id,
+                                                      const Value &value,
+                                                      comparison c,
+                                                      operand_order o)
+            {
+                field_value_binder<Record, Value> binder(value, c, o);
+                field_finder<Fields...>::apply(id, binder);
+                return binder.result;
+            }
+        };
+
+        template <typename Record, typename... Fields>
+        struct fields_of_record;
+
+        template <typename Record>
+        struct fields_of_record<Record> : std::true_type
+        {
+        };
+
+        template <typename Record, typename Field, typename... Fields>
+        struct fields_of_record<Record, Field, Fields...>
+                : std::integral_constant<bool,
+                        std::is_base_of<typename Field::record_type,
+                                Record>::value &&
+                        fields_of_record<Record, Fields...>::value>
+        {
+        };
+    }
+
+    /*
+     * Schema, binding field identifiers to the members of the record.
+     * Fields are declared by SIFTER_FIELD macro:
+     *
+     * using person_schema = sifter::schema<person,
+     *         SIFTER_FIELD(id, &person::id),
+     *         SIFTER_FIELD(name, &person::name)>;
+     *
+     * Binding checks types of the filter operands once and produces the
+     * filter, which tests members of the record directly.
+     */
+    template <typename Record, typename... Fields>
+    class schema
+    {
+    public:
+        using record_type = Record;
+        using field_type = typename std::tuple_element<0,
+                std::tuple<Fields...>>::type::field_type;
+
+        static_assert(detail::fields_of_record<Record, Fields...>::value,
+                      "fields should be members of the record");
+
+    public:
+        template <typename Filter>
+        static bound_filter<Record> bind(const Filter &f)
+        {
+            return bound_filter<Record>(flatten(
+                    f, detail::condition_binder<Record, field_type,
+                            Fields...>()));
+        }
+    };
+}
+
+#endif //SIFTER_SCHEMA_HPP
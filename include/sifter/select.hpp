@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_SELECT_HPP
+#define SIFTER_SELECT_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <vector>
+#include "evaluate.hpp"
+#include "thread_pool.hpp"
+
+namespace sifter
+{
+    const std::size_t no_limit = std::numeric_limits<std::size_t>::max();
+
+    namespace detail
+    {
+        /*
+         * Number of elements, evaluated by worker at once. Workers claim
+         * chunks by the shared cursor, so faster ones take more chunks.
+         */
+        const std::size_t select_chunk = 4096;
+
+        /*
+         * Number of elements, after which worker checks if the rest of the
+         * chunk is still needed in limit mode.
+         */
+        const std::size_t select_check = 64;
+
+        inline void atomic_max(std::atomic<std::size_t> &target,
+                               std::size_t value)
+        {
+            std::size_t current = target.load();
+            while (current < value &&
+                   !target.compare_exchange_weak(current, value))
+            {
+            }
+        }
+
+        inline void atomic_min(std::atomic<std::size_t> &target,
+                               std::size_t value)
+        {
+            std::size_t current = target.load();
+            while (value < current &&
+                   !target.compare_exchange_weak(current, value))
+            {
+            }
+        }
+
+        template <typename Iterator, typename Predicate>
+        class selector
+        {
+        public:
+            selector(Iterator begin, std::size_t size,
+                     const Predicate &predicate, std::size_t limit)
+                : m_begin(begin),
+                  m_size(size),
+                  m_predicate(predicate),
+                  m_limit(limit),
+                  m_chunks((size + select_chunk - 1) / select_chunk),
+                  m_cursor(0),
+                  m_found(0),
+                  m_last_done(0),
+                  m_cutoff(no_limit)
+            {
+            }
+
+            void operator()(std::size_t)
+            {
+                std::vector<std::size_t> matches;
+
+                for (;;)
+                {
+                    const std::size_t chunk = m_cursor.fetch_add(
+                            1, std::memory_order_relaxed);
+                    if (chunk >= m_chunks.size() || !needed(chunk))
+                        return;
+
+                    const std::size_t first = chunk * select_chunk;
+                    const std::size_t last = std::min(first + select_chunk,
+                                                      m_size);
+
+                    if (m_limit == no_limit)
+                    {
+                        scan(first, last, matches);
+                    }
+                    else if (!scan_limited(chunk, first, last, matches))
+                    {
+                        matches.clear();
+                        continue;
+                    }
+
+                    const std::size_t count = matches.size();
+                    m_chunks[chunk].swap(matches);
+                    matches.clear();
+
+                    if (m_limit != no_limit)
+                        complete(chunk, count);
+                }
+            }
+
+            std::vector<std::size_t> result() const
+            {
+                std::size_t size = 0;
+                for (const auto &chunk : m_chunks)
+                    size += chunk.size();
+
+                std::vector<std::size_t> out;
+                out.reserve(std::min(size, m_limit));
+                for (const auto &chunk : m_chunks)
+                {
+                    const std::size_t count = std::min(
+                            chunk.size(), m_limit - out.size());
+                    out.insert(out.end(), chunk.begin(),
+                               chunk.begin() + count);
+                }
+                return out;
+            }
+
+        private:
+            /*
+             * Chunks after the cutoff can't contain any of the first limit
+             * matches.
+             */
+            bool needed(std::size_t chunk) const
+            {
+                return chunk <= m_cutoff.load(std::memory_order_relaxed);
+            }
+
+            void scan(std::size_t first, std::size_t last,
+                      std::vector<std::size_t> &matches) const
+            {
+                Iterator it = m_begin + first;
+                for (std::size_t i = first; i < last; ++i, ++it)
+                {
+                    if (m_predicate(*it))
+                        matches.push_back(i);
+                }
+            }
+
+            /*
+             * Scans the chunk until limit matches are found in it, returns
+             * false if the chunk is not needed anymore.
+             */
+            bool scan_limited(std::size_t chunk, std::size_t first,
+                              std::size_t last,
+                              std::vector<std::size_t> &matches) const
+            {
+                Iterator it = m_begin + first;
+                for (std::size_t block = first; block < last;
+                     block += select_check)
+                {
+                    if (!needed(chunk))
+                        return false;
+
+                    const std::size_t end = std::min(block + select_check,
+                                                     last);
+                    for (std::size_t i = block; i < end; ++i, ++it)
+                    {
+                        if (m_predicate(*it))
+                        {
+                            matches.push_back(i);
+                            if (matches.size() == m_limit)
+                                return true;
+                        }
+                    }
+                }
+                return true;
+            }
+
+            /*
+             * Every counted chunk updates the last completed chunk before
+             * the counter, so once the counter reaches limit, the chunks
+             * up to the last completed one contain the first limit matches.
+             */
+            void complete(std::size_t chunk, std::size_t count)
+            {
+                atomic_max(m_last_done, chunk);
+                if (m_found.fetch_add(count) + count >= m_limit)
+                    atomic_min(m_cutoff, m_last_done.load());
+            }
+
+            Iterator m_begin;
+            std::size_t m_size;
+            const Predicate &m_predicate;
+            std::size_t m_limit;
+            std::vector<std::vector<std::size_t>> m_chunks;
+            std::atomic<std::size_t> m_cursor;
+            std::atomic<std::size_t> m_found;
+            std::atomic<std::size_t> m_last_done;
+            std::atomic<std::size_t> m_cutoff;
+        };
+    }
+
+    /*
+     * Evaluates predicate over the random access range in parallel and
+     * returns ascending indices of the matching elements. If limit is set,
+     * only the first limit indices are returned and workers stop taking new
+     * chunks as soon as they are found.
+     */
+    template <typename Range, typename Predicate, typename Executor>
+    std::vector<std::size_t> select_if(const Range &range,
+                                       const Predicate &predicate,
+                                       Executor &executor,
+                                       std::size_t limit = no_limit)
+    {
+        using std::begin;
+        using std::end;
+        using iterator = decltype(begin(range));
+
+        if (limit == 0)
+            return std::vector<std::size_t>();
+
+        const auto first = begin(range);
+        detail::selector<iterator, Predicate> selector(
+                first, static_cast<std::size_t>(std::distance(first,
+                                                              end(range))),
+                predicate, limit);
+
+        executor.run(std::function<void(std::size_t)>(std::ref(selector)));
+        return selector.result();
+    }
+
+    /*
+     * Evaluates filter over the random access range in parallel, see
+     * evaluate() and select_if().
+     */
+    template <typename Field, typename Range, typename Filter,
+            typename Accessor, typename Executor>
+    std::vector<std::size_t> select(const Range &range, const Filter &f,
+                                    const Accessor &accessor,
+                                    Executor &executor,
+                                    std::size_t limit = no_limit)
+    {
+        return select_if(range, filter_predicate<Field, Filter, Accessor>(
+                f, accessor), executor, limit);
+    }
+}
+
+#endif //SIFTER_SELECT_HPP
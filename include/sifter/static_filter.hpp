@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_STATIC_FILTER_HPP
+#define SIFTER_STATIC_FILTER_HPP
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include "evaluate.hpp"
+
+/*
+ * Declares static field type, binding field identifier to the member of the
+ * record, e.g. SIFTER_FIELD(age, &person::age).
+ */
+#define SIFTER_FIELD(id, member) \
+    ::sifter::member_field<decltype(id), id, decltype(member), member>
+
+namespace sifter
+{
+    template <typename Member>
+    struct member_traits;
+
+    template <typename Record, typename T>
+    struct member_traits<T Record::*>
+    {
+        using record_type = Record;
+        using value_type = T;
+    };
+
+    /*
+     * Base of the statically typed expressions. Expression is a predicate
+     * over the record, which may be converted to runtime filter.
+     */
+    template <typename Derived>
+    class static_expression
+    {
+    public:
+        const Derived &derived() const
+        {
+            return static_cast<const Derived &>(*this);
+        }
+    };
+
+    namespace detail
+    {
+        template <comparison c>
+        using comparison_tag = std::integral_constant<comparison, c>;
+
+        inline bool static_like(const std::string &text, const char *pattern)
+        {
+            return like_match(text.data(), text.size(),
+                              pattern, std::strlen(pattern));
+        }
+
+        inline bool static_like(const std::string &text,
+                                const std::string &pattern)
+        {
+            return like_match(text, pattern);
+        }
+
+        template <typename T, typename V>
+        bool static_compare(comparison_tag<eq>, const T &lhs, const V &rhs)
+        {
+            return lhs == rhs;
+        }
+
+        template <typename T, typename V>
+        bool static_compare(comparison_tag<ne>, const T &lhs, const V &rhs)
+        {
+            return lhs != rhs;
+        }
+
+        template <typename T, typename V>
+        bool static_compare(comparison_tag<lt>, const T &lhs, const V &rhs)
+        {
+            return lhs < rhs;
+        }
+
+        template <typename T, typename V>
+        bool static_compare(comparison_tag<le>, const T &lhs, const V &rhs)
+        {
+            return lhs <= rhs;
+        }
+
+        template <typename T, typename V>
+        bool static_compare(comparison_tag<gt>, const T &lhs, const V &rhs)
+        {
+            return lhs > rhs;
+        }
+
+        template <typename T, typename V>
+        bool static_compare(comparison_tag<ge>, const T &lhs, const V &rhs)
+        {
+            return lhs >= rhs;
+        }
+
+        template <typename T, typename V>
+        bool static_compare(comparison_tag<like>, const T &lhs, const V &rhs)
+        {
+            return static_like(lhs, rhs);
+        }
+
+        template <typename T, typename V>
+        bool static_compare(comparison_tag<not_like>, const T &lhs,
+                            const V &rhs)
+        {
+            return !static_like(lhs, rhs);
+        }
+    }
+
+    template <typename Field, comparison c, typename Value>
+    class static_condition
+            : public static_expression<static_condition<Field, c, Value>>
+    {
+    public:
+        using field_type = Field;
+        using record_type = typename Field::record_type;
+        using value_type = Value;
+
+    public:
+        explicit static_condition(const value_type &value)
+            : m_value(value)
+        {
+        }
+
+        bool operator()(const record_type &record) const
+        {
+            return detail::static_compare(detail::comparison_tag<c>(),
+                                          Field::get(record), m_value);
+        }
+
+        static comparison comp()
+        {
+            return c;
+        }
+
+        const value_type &value() const
+        {
+            return m_value;
+        }
+
+    private:
+        value_type m_value;
+    };
+
+    template <typename Lhs, typename Rhs>
+    class static_and : public static_expression<static_and<Lhs, Rhs>>
+    {
+    public:
+        using record_type = typename Lhs::record_type;
+
+    public:
+        static_and(const Lhs &lhs, const Rhs &rhs)
+            : m_lhs(lhs),
+              m_rhs(rhs)
+        {
+        }
+
+        bool operator()(const record_type &record) const
+        {
+            return m_lhs(record) && m_rhs(record);
+        }
+
+        const Lhs &lhs() const
+        {
+            return m_lhs;
+        }
+
+        const Rhs &rhs() const
+        {
+            return m_rhs;
+        }
+
+    private:
+        Lhs m_lhs;
+        Rhs m_rhs;
+    };
+
+    template <typename Lhs, typename Rhs>
+    class static_or : public static_expression<static_or<Lhs, Rhs>>
+    {
+    public:
+        using record_type = typename Lhs::record_type;
+
+    public:
+        static_or(const Lhs &lhs, const Rhs &rhs)
+            : m_lhs(lhs),
+              m_rhs(rhs)
+        {
+        }
+
+        bool operator()(const record_type &record) const
+        {
+            return m_lhs(record) || m_rhs(record);
+        }
+
+        const Lhs &lhs() const
+        {
+            return m_lhs;
+        }
+
+        const Rhs &rhs() const
+        {
+            return m_rhs;
+        }
+
+    private:
+        Lhs m_lhs;
+        Rhs m_rhs;
+    };
+
+    template <typename Lhs, typename Rhs>
+    static_and<Lhs, Rhs> operator&&(const static_expression<Lhs> &lhs,
+                                    const static_expression<Rhs> &rhs)
+    {
+        return static_and<Lhs, Rhs>(lhs.derived(), rhs.derived());
+    }
+
+    template <typename Lhs, typename Rhs>
+    static_or<Lhs, Rhs> operator||(const static_expression<Lhs> &lhs,
+                                   const static_expression<Rhs> &rhs)
+    {
+        return static_or<Lhs, Rhs>(lhs.derived(), rhs.derived());
+    }
+
+    /*
+     * Type of the negated expression: complement comparisons, swapped
+     * operations.
+     */
+    template <typename Expression>
+    struct static_negation;
+
+    template <typename Field, comparison c, typename Value>
+    struct static_negation<static_condition<Field, c, Value>>
+    {
+        using type = static_condition<Field, complement(c), Value>;
+    };
+
+    template <typename Lhs, typename Rhs>
+    struct static_negation<static_and<Lhs, Rhs>>
+    {
+        using type = static_or<typename static_negation<Lhs>::type,
+                typename static_negation<Rhs>::type>;
+    };
+
+    template <typename Lhs, typename Rhs>
+    struct static_negation<static_or<Lhs, Rhs>>
+    {
+        using type = static_and<typename static_negation<Lhs>::type,
+                typename static_negation<Rhs>::type>;
+    };
+
+    template <typename Field, comparison c, typename Value>
+    typename static_negation<static_condition<Field, c, Value>>::type
+    operator~(const static_condition<Field, c, Value> &e)
+    {
+        return typename static_negation<static_condition<Field, c, Value>>
+                ::type(e.value());
+    }
+
+    template <typename Lhs, typename Rhs>
+    typename static_negation<static_and<Lhs, Rhs>>::type
+    operator~(const static_and<Lhs, Rhs> &e)
+    {
+        return typename static_negation<static_and<Lhs, Rhs>>::type(
+                ~e.lhs(), ~e.rhs());
+    }
+
+    template <typename Lhs, typename Rhs>
+    typename static_negation<static_or<Lhs, Rhs>>::type
+    operator~(const static_or<Lhs, Rhs> &e)
+    {
+        return typename static_negation<static_or<Lhs, Rhs>>::type(
+                ~e.lhs(), ~e.rhs());
+    }
+
+    /*
+     * Field, bound to the member of the record. Comparison operators build
+     * static conditions, e.g. SIFTER_FIELD(age, &person::age)() > 20.
+     */
+    template <typename Field, Field id, typename Member, Member member>
+    class member_field
+    {
+    public:
+        using field_type = Field;
+        using record_type = typename member_traits<Member>::record_type;
+        using value_type = typename member_traits<Member>::value_type;
+        using member_type = Member;
+
+        template <comparison c, typename V>
+        using condition_type = static_condition<member_field, c,
+                typename std::decay<const V>::type>;
+
+    public:
+        static constexpr Field key()
+        {
+            return id;
+        }
+
+        static constexpr Member pointer()
+        {
+            return member;
+        }
+
+        static const value_type &get(const record_type &record)
+        {
+            return record.*member;
+        }
+
+        template <typename V>
+        condition_type<eq, V> operator==(const V &value) const
+        {
+            return condition_type<eq, V>(value);
+        }
+
+        template <typename V>
+        condition_type<ne, V> operator!=(const V &value) const
+        {
+            return condition_type<ne, V>(value);
+        }
+
+        template <typename V>
+        condition_type<lt, V> operator<(const V &value) const
+        {
+            return condition_type<lt, V>(value);
+        }
+
+        template <typename V>
+        condition_type<le, V> operator<=(const V &value) const
+        {
+            return condition_type<le, V>(value);
+        }
+
+        template <typename V>
+        condition_type<gt, V> operator>(const V &value) const
+        {
+            return condition_type<gt, V>(value);
+        }
+
+        template <typename V>
+        condition_type<ge, V> operator>=(const V &value) const
+        {
+            return condition_type<ge, V>(value);
+        }
+
+        template <typename V>
+        condition_type<like, V> operator%(const V &value) const
+        {
+            return condition_type<like, V>(value);
+        }
+    };
+
+    /*
+     * Converts static expression to runtime filter.
+     */
+    template <typename Filter, typename Field, comparison c, typename Value>
+    Filter to_filter(const static_condition<Field, c, Value> &e)
+    {
+        using condition_type = typename Filter::condition_type;
+        using value_type = typename condition_type::value_type;
+
+        return Filter(condition_type(value_type(Field::key()),
+                                     value_type(e.value()), c));
+    }
+
+    template <typename Filter, typename Lhs, typename Rhs>
+    Filter to_filter(const static_and<Lhs, Rhs> &e)
+    {
+        return to_filter<Filter>(e.lhs()) && to_filter<Filter>(e.rhs());
+    }
+
+    template <typename Filter, typename Lhs, typename Rhs>
+    Filter to_filter(const static_or<Lhs, Rhs> &e)
+    {
+        return to_filter<Filter>(e.lhs()) || to_filter<Filter>(e.rhs());
+    }
+}
+
+#endif //SIFTER_STATIC_FILTER_HPP
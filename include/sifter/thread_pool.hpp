@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_THREAD_POOL_HPP
+#define SIFTER_THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "thread_index.hpp"
+
+namespace sifter
+{
+    /*
+     * Executor runs task(worker) for each worker in [0, size()) concurrently
+     * and waits for all of them. Calling thread is worker 0, the others are
+     * persistent threads of the pool. The first exception, thrown by the
+     * task, is rethrown by run().
+     */
+    class thread_pool
+    {
+    public:
+        using task_type = std::function<void(std::size_t)>;
+
+    public:
+        explicit thread_pool(std::size_t size = default_size());
+
+        thread_pool(const thread_pool &) = delete;
+
+        thread_pool &operator=(const thread_pool &) = delete;
+
+        ~thread_pool();
+
+        std::size_t size() const
+        {
+            return m_threads.size() + 1;
+        }
+
+        void run(const task_type &task);
+
+        static std::size_t default_size();
+
+    private:
+        void work(std::size_t worker);
+
+        void fail();
+
+        std::vector<std::thread> m_threads;
+        std::mutex m_run_mutex;
+        std::mutex m_mutex;
+        std::condition_variable m_start;
+        std::condition_variable m_done;
+        const task_type *m_task;
+        std::size_t m_generation;
+        std::size_t m_running;
+        bool m_stop;
+        std::exception_ptr m_error;
+    };
+
+    /*
+     * Executor with the only worker, the calling thread.
+     */
+    class inline_executor
+    {
+    public:
+        std::size_t size() const
+        {
+            return 1;
+        }
+
+        template <typename Task>
+        void run(const Task &task)
+        {
+            task(0);
+        }
+    };
+}
+
+#endif //SIFTER_THREAD_POOL_HPP
@@ -0,0 +1,454 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_VIEW_HPP
+#define SIFTER_VIEW_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "bitmap.hpp"
+#include "evaluate.hpp"
+
+namespace sifter
+{
+    /*
+     * Base of the lazy views. Views are stored by value in other views,
+     * while the other ranges are referenced and should outlive the view.
+     */
+    class view_base
+    {
+    };
+
+    namespace detail
+    {
+        template <typename Range>
+        using is_view = std::is_base_of<view_base, Range>;
+
+        template <typename Range>
+        using stored_range = typename std::conditional<is_view<Range>::value,
+                Range, const Range &>::type;
+
+        template <typename Range>
+        using range_iterator = decltype(std::begin(
+                std::declval<const Range &>()));
+
+        template <typename Iterator>
+        using is_forward_iterator = std::is_base_of<
+                std::forward_iterator_tag,
+                typename std::iterator_traits<Iterator>::iterator_category>;
+
+        /*
+         * Where view evaluates the chunk ahead of the iterator and walks
+         * it again, so the range should be multi-pass.
+         */
+        template <typename Range>
+        using forward_range = typename std::enable_if<
+                is_forward_iterator<range_iterator<Range>>::value>::type;
+
+        template <typename Range>
+        using temporary_range = typename std::enable_if<
+                !is_view<Range>::value &&
+                !std::is_reference<Range>::value>::type;
+
+        /*
+         * Number of elements, evaluated by where view at once.
+         */
+        const std::size_t where_chunk = 64;
+
+        template <typename Iterator>
+        using prefetch_tag = std::integral_constant<bool,
+                std::is_base_of<std::random_access_iterator_tag,
+                        typename std::iterator_traits<Iterator>::
+                                iterator_category>::value &&
+                std::is_lvalue_reference<typename std::iterator_traits<
+                        Iterator>::reference>::value>;
+
+        /*
+         * Prefetches the first element of the next chunk, while the current
+         * one is evaluated.
+         */
+        template <typename Iterator>
+        void prefetch_chunk(Iterator it, Iterator end, std::true_type)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            if (static_cast<std::size_t>(end - it) > where_chunk)
+                __builtin_prefetch(std::addressof(*(it + where_chunk)));
+#else
+            static_cast<void>(it);
+            static_cast<void>(end);
+#endif
+        }
+
+        template <typename Iterator>
+        void prefetch_chunk(Iterator, Iterator, std::false_type)
+        {
+        }
+    }
+
+    /*
+     * Iterator over the elements, satisfying the predicate. Predicate is
+     * evaluated for the chunk of elements at once, the matches are kept
+     * in the bit mask. The base iterator should be forward one at least.
+     */
+    template <typename Iterator, typename Predicate>
+    class where_iterator
+    {
+        static_assert(detail::is_forward_iterator<Iterator>::value,
+                      "where view requires forward iterators");
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using difference_type =
+                typename std::iterator_traits<Iterator>::difference_type;
+        using pointer = typename std::iterator_traits<Iterator>::pointer;
+        using reference = typename std::iterator_traits<Iterator>::reference;
+
+    public:
+        where_iterator()
+            : m_predicate(nullptr),
+              m_mask(0)
+        {
+        }
+
+        where_iterator(Iterator begin, Iterator end,
+                       const Predicate *predicate)
+            : m_current(begin),
+              m_chunk_end(begin),
+              m_end(end),
+              m_predicate(predicate),
+              m_mask(0)
+        {
+            if (m_predicate)
+                fill();
+        }
+
+        reference operator*() const
+        {
+            return *m_current;
+        }
+
+        Iterator operator->() const
+        {
+            return m_current;
+        }
+
+        where_iterator &operator++()
+        {
+            /*
+             * The lowest bit of the mask is the current element.
+             */
+            m_mask >>= 1;
+            ++m_current;
+
+            if (m_mask)
+            {
+                skip();
+            }
+            else
+            {
+                m_current = m_chunk_end;
+                fill();
+            }
+            return *this;
+        }
+
+        where_iterator operator++(int)
+        {
+            where_iterator out = *this;
+            ++*this;
+            return out;
+        }
+
+        const Iterator &base() const
+        {
+            return m_current;
+        }
+
+        friend bool operator==(const where_iterator &lhs,
+                               const where_iterator &rhs)
+        {
+            return lhs.m_current == rhs.m_current;
+        }
+
+        friend bool operator!=(const where_iterator &lhs,
+                               const where_iterator &rhs)
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        void skip()
+        {
+            const std::size_t offset = bitmap::lowest_bit(m_mask);
+            std::advance(m_current, offset);
+            m_mask >>= offset;
+        }
+
+        void fill()
+        {
+            while (m_current != m_end)
+            {
+                detail::prefetch_chunk(m_current, m_end,
+                                       detail::prefetch_tag<Iterator>());
+
+                Iterator it = m_current;
+                for (std::size_t i = 0; i < detail::where_chunk &&
+                                        it != m_end; ++i, ++it)
+                    m_mask |= static_cast<std::uint64_t>(
+                            (*m_predicate)(*it) ? 1u : 0u) << i;
+                m_chunk_end = it;
+
+                if (m_mask)
+                {
+                    skip();
+                    return;
+                }
+                m_current = m_chunk_end;
+            }
+        }
+
+        Iterator m_current;
+        Iterator m_chunk_end;
+        Iterator m_end;
+        const Predicate *m_predicate;
+        std::uint64_t m_mask;
+    };
+
+    /*
+     * Lazy view of the range elements, satisfying the predicate.
+     */
+    template <typename Range, typename Predicate>
+    class where_view : public view_base
+    {
+    public:
+        using iterator = where_iterator<detail::range_iterator<Range>,
+                Predicate>;
+        using const_iterator = iterator;
+
+    public:
+        where_view(const Range &range, const Predicate &predicate)
+            : m_range(range),
+              m_predicate(predicate)
+        {
+        }
+
+        iterator begin() const
+        {
+            return iterator(std::begin(m_range), std::end(m_range),
+                            &m_predicate);
+        }
+
+        iterator end() const
+        {
+            return iterator(std::end(m_range), std::end(m_range), nullptr);
+        }
+
+    private:
+        detail::stored_range<Range> m_range;
+        Predicate m_predicate;
+    };
+
+    /*
+     * Iterator over at most count elements of the range. It is single-pass,
+     * if the base iterator is.
+     */
+    template <typename Iterator>
+    class take_iterator
+    {
+    public:
+        using iterator_category = typename std::conditional<
+                detail::is_forward_iterator<Iterator>::value,
+                std::forward_iterator_tag, std::input_iterator_tag>::type;
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using difference_type =
+                typename std::iterator_traits<Iterator>::difference_type;
+        using pointer = typename std::iterator_traits<Iterator>::pointer;
+        using reference = typename std::iterator_traits<Iterator>::reference;
+
+    public:
+        take_iterator()
+            : m_count(0)
+        {
+        }
+
+        take_iterator(Iterator it, Iterator end, std::size_t count)
+            : m_it(count ? it : end),
+              m_end(end),
+              m_count(count)
+        {
+        }
+
+        reference operator*() const
+        {
+            return *m_it;
+        }
+
+        Iterator operator->() const
+        {
+            return m_it;
+        }
+
+        /*
+         * The underlying iterator is not advanced after the last element,
+         * so the view does not look further than needed.
+         */
+        take_iterator &operator++()
+        {
+            if (--m_count == 0)
+                m_it = m_end;
+            else
+                ++m_it;
+            return *this;
+        }
+
+        take_iterator operator++(int)
+        {
+            take_iterator out = *this;
+            ++*this;
+            return out;
+        }
+
+        const Iterator &base() const
+        {
+            return m_it;
+        }
+
+        friend bool operator==(const take_iterator &lhs,
+                               const take_iterator &rhs)
+        {
+            return lhs.m_it == rhs.m_it;
+        }
+
+        friend bool operator!=(const take_iterator &lhs,
+                               const take_iterator &rhs)
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        Iterator m_it;
+        Iterator m_end;
+        std::size_t m_count;
+    };
+
+    /*
+     * Lazy view of at most count first elements of the range.
+     */
+    template <typename Range>
+    class take_view : public view_base
+    {
+    public:
+        using iterator = take_iterator<detail::range_iterator<Range>>;
+        using const_iterator = iterator;
+
+    public:
+        take_view(const Range &range, std::size_t count)
+            : m_range(range),
+              m_count(count)
+        {
+        }
+
+        iterator begin() const
+        {
+            return iterator(std::begin(m_range), std::end(m_range), m_count);
+        }
+
+        iterator end() const
+        {
+            return iterator(std::end(m_range), std::end(m_range), 0);
+        }
+
+    private:
+        detail::stored_range<Range> m_range;
+        std::size_t m_count;
+    };
+
+    template <typename Predicate>
+    struct where_adaptor
+    {
+        Predicate predicate;
+    };
+
+    struct take_adaptor
+    {
+        std::size_t count;
+    };
+
+    /*
+     * Adaptor, selecting elements of the range, which satisfy predicate,
+     * e.g. records | sifter::where_if(person_schema::bind(f)).
+     */
+    template <typename Predicate>
+    where_adaptor<Predicate> where_if(const Predicate &predicate)
+    {
+        return where_adaptor<Predicate>{predicate};
+    }
+
+    /*
+     * Adaptor, selecting elements of the range, which satisfy filter, e.g.
+     * records | sifter::where<field>(f, accessor) | sifter::take(100).
+     * The filter is referenced and should outlive the view.
+     */
+    template <typename Field, typename Filter, typename Accessor>
+    where_adaptor<filter_predicate<Field, Filter, Accessor>> where(
+            const Filter &f, const Accessor &accessor)
+    {
+        return where_if(filter_predicate<Field, Filter, Accessor>(f,
+                                                                  accessor));
+    }
+
+    template <typename Field, typename Filter, typename Accessor>
+    void where(const Filter &&f, const Accessor &accessor) = delete;
+
+    inline take_adaptor take(std::size_t count)
+    {
+        return take_adaptor{count};
+    }
+
+    template <typename Range, typename Predicate,
+            typename = detail::forward_range<Range>>
+    where_view<Range, Predicate> operator|(const Range &range,
+                                           const where_adaptor<Predicate> &a)
+    {
+        return where_view<Range, Predicate>(range, a.predicate);
+    }
+
+    template <typename Range, typename Predicate,
+            typename = detail::temporary_range<Range>>
+    void operator|(Range &&range, const where_adaptor<Predicate> &a) = delete;
+
+    template <typename Range>
+    take_view<Range> operator|(const Range &range, const take_adaptor &a)
+    {
+        return take_view<Range>(range, a.count);
+    }
+
+    template <typename Range, typename = detail::temporary_range<Range>>
+    void operator|(Range &&range, const take_adaptor &a) = delete;
+}
+
+#endif //SIFTER_VIEW_HPP
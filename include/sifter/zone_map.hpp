@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_ZONE_MAP_HPP
+#define SIFTER_ZONE_MAP_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include "evaluate.hpp"
+
+namespace sifter
+{
+    /*
+     * Result of filter evaluation against block statistics.
+     */
+    enum class block_match
+    {
+        never,
+        always,
+        maybe
+    };
+
+    /*
+     * Statistics of a column within a block of rows. Null values never
+     * satisfy any condition. may_contain is an optional distinct-value sketch
+     * (e.g. bloom filter): it should return false only if the value
+     * definitely does not occur in the block.
+     */
+    template <typename Value>
+    struct column_stats
+    {
+        Value min;
+        Value max;
+        std::size_t rows = 0;
+        std::size_t nulls = 0;
+        std::function<bool(const Value &)> may_contain;
+    };
+
+    namespace detail
+    {
+        inline block_match to_block_match(bool value)
+        {
+            return value ? block_match::always : block_match::never;
+        }
+
+        inline comparison mirror(comparison c)
+        {
+            switch (c)
+            {
+                case lt:
+                    return gt;
+                case le:
+                    return ge;
+                case gt:
+                    return lt;
+                case ge:
+                    return le;
+                default:
+                    return c;
+            }
+        }
+
+        /*
+         * Checks if there are strings, matching the pattern, between min and
+         * max, using the literal prefix of the pattern.
+         */
+        template <typename Value>
+        class like_range
+        {
+        public:
+            like_range(const Value &min, const Value &max)
+                : m_min(min),
+                  m_max(max)
+            {
+            }
+
+            template <typename T>
+            block_match operator()(const T &) const
+            {
+                return block_match::never;
+            }
+
+            block_match operator()(const std::string &pattern) const
+            {
+                const std::string &min = sifter::get<std::string>(m_min);
+                const std::string &max = sifter::get<std::string>(m_max);
+
+                std::string prefix =
+                        pattern.substr(0, pattern.find_first_of("%_"));
+                if (max < prefix)
+                    return block_match::never;
+
+                while (!prefix.empty() &&
+                       static_cast<unsigned char>(prefix.back()) == 0xff)
+                {
+                    prefix.pop_back();
+                }
+
+                if (prefix.empty())
+                    return block_match::maybe;
+
+                prefix.back() = static_cast<char>(
+                        static_cast<unsigned char>(prefix.back()) + 1);
+                return min < prefix ? block_match::maybe : block_match::never;
+            }
+
+        private:
+            const Value &m_min;
+            const Value &m_max;
+        };
+
+        template <typename Value>
+        block_match match_range(comparison c, const column_stats<Value> &stats,
+                                const Value &v)
+        {
+            if (stats.min.index() != v.index() ||
+                stats.max.index() != v.index())
+            {
+                return to_block_match(compare(c, stats.min, v));
+            }
+
+            if (stats.min == stats.max)
+                return to_block_match(compare(c, stats.min, v));
+
+            switch (c)
+            {
+                case eq:
+                case ne:
+                {
+                    const bool absent =
+                            compare(lt, v, stats.min) ||
+                            compare(gt, v, stats.max) ||
+                            (stats.may_contain && !stats.may_contain(v));
+                    if (absent)
+                        return to_block_match(c == ne);
+                    return block_match::maybe;
+                }
+                case lt:
+                    if (compare(lt, stats.max, v))
+                        return block_match::always;
+                    return compare(ge, stats.min, v) ? block_match::never
+                                                     : block_match::maybe;
+                case le:
+                    if (compare(le, stats.max, v))
+                        return block_match::always;
+                    return compare(gt, stats.min, v) ? block_match::never
+                                                     : block_match::maybe;
+                case gt:
+                    if (compare(gt, stats.min, v))
+                        return block_match::always;
+                    return compare(le, stats.max, v) ? block_match::never
+                                                     : block_match::maybe;
+                case ge:
+                    if (compare(ge, stats.min, v))
+                        return block_match::always;
+                    return compare(lt, stats.max, v) ? block_match::never
+                                                     : block_match::maybe;
+                case like:
+                    return sifter::visit(
+                            like_range<Value>(stats.min, stats.max), v);
+                case not_like:
+                    return sifter::visit(
+                            like_range<Value>(stats.min, stats.max), v) ==
+                           block_match::never ? block_match::always
+                                              : block_match::maybe;
+            }
+
+            return block_match::maybe;
+        }
+
+        template <typename Value>
+        block_match match_column(comparison c,
+                                 const column_stats<Value> *stats,
+                                 const Value &v)
+        {
+            if (!stats)
+                return block_match::maybe;
+
+            if (stats->rows && stats->nulls >= stats->rows)
+                return block_match::never;
+
+            const block_match out = match_range(c, *stats, v);
+            if (out == block_match::always && stats->nulls)
+                return block_match::maybe;
+
+            return out;
+        }
+    }
+
+    /*
+     * Evaluates condition against block statistics: stats(field) should
+     * return pointer to column_stats of the condition value type or nullptr,
+     * if statistics of the field are not available.
+     */
+    template <typename Field, typename Statistics, comparison def_value,
+            typename... Types>
+    block_match match_block(
+            const basic_condition<comparison, def_value, Types...> &c,
+            const Statistics &stats)
+    {
+        const bool lhs_field = sifter::holds_alternative<Field>(c.lhs());
+        const bool rhs_field = sifter::holds_alternative<Field>(c.rhs());
+
+        if (!lhs_field && !rhs_field)
+            return detail::to_block_match(compare(c.comp(), c.lhs(), c.rhs()));
+
+        if (lhs_field && rhs_field)
+            return block_match::maybe;
+
+        if (lhs_field)
+            return detail::match_column(
+                    c.comp(), stats(sifter::get<Field>(c.lhs())), c.rhs());
+
+        if (c.comp() == like || c.comp() == not_like)
+            return block_match::maybe;
+
+        return detail::match_column(detail::mirror(c.comp()),
+                                    stats(sifter::get<Field>(c.rhs())),
+                                    c.lhs());
+    }
+
+    /*
+     * Evaluates filter against block statistics. Blocks answering
+     * block_match::never may be skipped, blocks answering block_match::always
+     * may be taken without per-row checks.
+     */
+    template <typename Field, typename Statistics, comparison def_value,
+            typename... Types>
+    block_match match_block(
+            const basic_filter<comparison, def_value, Types...> &f,
+            const Statistics &stats)
+    {
+        const bool has_lhs = f.left_is_filter() || f.left_is_condition();
+        const bool has_rhs = f.right_is_filter() || f.right_is_condition();
+
+        block_match lhs = block_match::always;
+        if (has_lhs)
+        {
+            lhs = f.left_is_filter()
+                    ? match_block<Field>(f.left_filter(), stats)
+                    : match_block<Field>(f.left_condition(), stats);
+
+            if (!has_rhs || f.oper() == operation::_none)
+                return lhs;
+
+            if (f.oper() == operation::_and && lhs == block_match::never)
+                return lhs;
+
+            if (f.oper() == operation::_or && lhs == block_match::always)
+                return lhs;
+        }
+
+        if (!has_rhs)
+            return block_match::always;
+
+        const block_match rhs = f.right_is_filter()
+                ? match_block<Field>(f.right_filter(), stats)
+                : match_block<Field>(f.right_condition(), stats);
+
+        if (!has_lhs || lhs == rhs)
+            return rhs;
+
+        if (f.oper() == operation::_and)
+            return rhs == block_match::never ? rhs : block_match::maybe;
+
+        return rhs == block_match::always ? rhs : block_match::maybe;
+    }
+}
+
+#endif //SIFTER_ZONE_MAP_HPP
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <sifter/evaluate.hpp>
+
+bool sifter::like_match(const char *text, std::size_t text_size,
+                        const char *pattern, std::size_t pattern_size)
+{
+    std::size_t t = 0;
+    std::size_t p = 0;
+    std::size_t percent = pattern_size;
+    std::size_t resume = 0;
+
+    while (t < text_size)
+    {
+        if (p < pattern_size && pattern[p] == '%')
+        {
+            percent = p++;
+            resume = t;
+        }
+        else if (p < pattern_size &&
+                 (pattern[p] == '_' || pattern[p] == text[t]))
+        {
+            ++p;
+            ++t;
+        }
+        else if (percent != pattern_size)
+        {
+            p = percent + 1;
+            t = ++resume;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (p < pattern_size && pattern[p] == '%')
+        ++p;
+
+    return p == pattern_size;
+}
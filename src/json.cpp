@@ -0,0 +1,447 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sifter/json.hpp>
+
+namespace
+{
+    bool is_digit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    int hex_value(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    unsigned read_hex(const char *text)
+    {
+        unsigned value = 0;
+        for (int i = 0; i < 4; ++i)
+            value = value * 16 + static_cast<unsigned>(hex_value(text[i]));
+        return value;
+    }
+
+    bool is_high_surrogate(unsigned code)
+    {
+        return code >= 0xd800 && code < 0xdc00;
+    }
+
+    bool is_low_surrogate(unsigned code)
+    {
+        return code >= 0xdc00 && code < 0xe000;
+    }
+
+    char *write_utf8(char *out, unsigned long code)
+    {
+        if (code < 0x80)
+        {
+            *out++ = static_cast<char>(code);
+        }
+        else if (code < 0x800)
+        {
+            *out++ = static_cast<char>(0xc0 | (code >> 6));
+            *out++ = static_cast<char>(0x80 | (code & 0x3f));
+        }
+        else if (code < 0x10000)
+        {
+            *out++ = static_cast<char>(0xe0 | (code >> 12));
+            *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (code & 0x3f));
+        }
+        else
+        {
+            *out++ = static_cast<char>(0xf0 | (code >> 18));
+            *out++ = static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+            *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (code & 0x3f));
+        }
+        return out;
+    }
+
+    /*
+     * Longest number, which is accepted by the reader. Numbers are copied
+     * to the null terminated stack buffer for strtoll() and strtod().
+     */
+    const std::size_t number_size = 64;
+}
+
+sifter::json_error::json_error(const std::string &what, std::size_t offset)
+    : std::invalid_argument(what + " at position " + std::to_string(offset)),
+      m_offset(offset)
+{
+}
+
+std::size_t sifter::json_error::offset() const
+{
+    return m_offset;
+}
+
+sifter::detail::json_reader::json_reader(const char *data, std::size_t size)
+    : m_begin(data),
+      m_pos(data),
+      m_end(data + size)
+{
+}
+
+char sifter::detail::json_reader::peek()
+{
+    skip();
+    return m_pos == m_end ? '\0' : *m_pos;
+}
+
+bool sifter::detail::json_reader::consume(char c)
+{
+    if (peek() != c)
+        return false;
+
+    ++m_pos;
+    return true;
+}
+
+void sifter::detail::json_reader::expect(char c)
+{
+    if (!consume(c))
+        fail((std::string("'") + c + "' expected").c_str());
+}
+
+sifter::detail::json_string sifter::detail::json_reader::read_string()
+{
+    expect('"');
+
+    json_string out = {m_pos, 0, false};
+    while (m_pos != m_end && *m_pos != '"')
+    {
+        const auto c = static_cast<unsigned char>(*m_pos);
+        if (c < 0x20)
+            fail("control character in string");
+
+        if (c != '\\')
+        {
+            ++m_pos;
+            continue;
+        }
+
+        out.escaped = true;
+        if (++m_pos == m_end)
+            break;
+
+        switch (*m_pos++)
+        {
+            case '"':
+            case '\\':
+            case '/':
+            case 'b':
+            case 'f':
+            case 'n':
+            case 'r':
+            case 't':
+                break;
+            case 'u':
+            {
+                if (m_end - m_pos < 4 || hex_value(m_pos[0]) < 0 ||
+                    hex_value(m_pos[1]) < 0 || hex_value(m_pos[2]) < 0 ||
+                    hex_value(m_pos[3]) < 0)
+                    fail("invalid unicode escape");
+
+                const unsigned code = read_hex(m_pos);
+                m_pos += 4;
+
+                if (is_low_surrogate(code))
+                    fail("unpaired surrogate");
+
+                if (is_high_surrogate(code))
+                {
+                    if (m_end - m_pos < 6 || m_pos[0] != '\\' ||
+                        m_pos[1] != 'u' || hex_value(m_pos[2]) < 0 ||
+                        hex_value(m_pos[3]) < 0 || hex_value(m_pos[4]) < 0 ||
+                        hex_value(m_pos[5]) < 0 ||
+                        !is_low_surrogate(read_hex(m_pos + 2)))
+                        fail("unpaired surrogate");
+
+                    m_pos += 6;
+                }
+                break;
+            }
+            default:
+                --m_pos;
+                fail("invalid escape");
+        }
+    }
+
+    if (m_pos == m_end)
+        fail("unterminated string");
+
+    out.size = static_cast<std::size_t>(m_pos - out.data);
+    ++m_pos;
+    return out;
+}
+
+sifter::detail::json_number sifter::detail::json_reader::read_number()
+{
+    skip();
+
+    const char *begin = m_pos;
+    bool integral = true;
+
+    if (m_pos != m_end && *m_pos == '-')
+        ++m_pos;
+
+    if (m_pos == m_end || !is_digit(*m_pos))
+        fail("unexpected character");
+
+    if (*m_pos == '0')
+    {
+        ++m_pos;
+    }
+    else
+    {
+        while (m_pos != m_end && is_digit(*m_pos))
+            ++m_pos;
+    }
+
+    if (m_pos != m_end && *m_pos == '.')
+    {
+        integral = false;
+        if (++m_pos == m_end || !is_digit(*m_pos))
+            fail("invalid number");
+
+        while (m_pos != m_end && is_digit(*m_pos))
+            ++m_pos;
+    }
+
+    if (m_pos != m_end && (*m_pos == 'e' || *m_pos == 'E'))
+    {
+        integral = false;
+        if (++m_pos != m_end && (*m_pos == '+' || *m_pos == '-'))
+            ++m_pos;
+
+        if (m_pos == m_end || !is_digit(*m_pos))
+            fail("invalid number");
+
+        while (m_pos != m_end && is_digit(*m_pos))
+            ++m_pos;
+    }
+
+    const auto size = static_cast<std::size_t>(m_pos - begin);
+    if (size >= number_size)
+    {
+        m_pos = begin;
+        fail("number is too long");
+    }
+
+    char text[number_size];
+    std::memcpy(text, begin, size);
+    text[size] = '\0';
+
+    json_number out = {false, 0, 0.0};
+    if (integral)
+    {
+        errno = 0;
+        out.integer = std::strtoll(text, nullptr, 10);
+        out.integral = errno != ERANGE;
+    }
+    out.floating = out.integral ? static_cast<double>(out.integer)
+                                : std::strtod(text, nullptr);
+    return out;
+}
+
+bool sifter::detail::json_reader::read_bool()
+{
+    skip();
+
+    const auto left = static_cast<std::size_t>(m_end - m_pos);
+    if (left >= 4 && std::memcmp(m_pos, "true", 4) == 0)
+    {
+        m_pos += 4;
+        return true;
+    }
+
+    if (left >= 5 && std::memcmp(m_pos, "false", 5) == 0)
+    {
+        m_pos += 5;
+        return false;
+    }
+
+    fail("unexpected character");
+}
+
+void sifter::detail::json_reader::finish()
+{
+    if (peek() != '\0' || m_pos != m_end)
+        fail("unexpected character after filter");
+}
+
+void sifter::detail::json_reader::fail(const char *what) const
+{
+    throw json_error(what, static_cast<std::size_t>(m_pos - m_begin));
+}
+
+void sifter::detail::json_reader::skip()
+{
+    while (m_pos != m_end && (*m_pos == ' ' || *m_pos == '\t' ||
+                              *m_pos == '\n' || *m_pos == '\r'))
+        ++m_pos;
+}
+
+std::size_t sifter::detail::json_unescape(const char *data, std::size_t size,
+                                          char *out)
+{
+    const char *end = data + size;
+    char *begin = out;
+
+    while (data != end)
+    {
+        if (*data != '\\')
+        {
+            *out++ = *data++;
+            continue;
+        }
+
+        ++data;
+        switch (*data++)
+        {
+            case 'b':
+                *out++ = '\b';
+                break;
+            case 'f':
+                *out++ = '\f';
+                break;
+            case 'n':
+                *out++ = '\n';
+                break;
+            case 'r':
+                *out++ = '\r';
+                break;
+            case 't':
+                *out++ = '\t';
+                break;
+            case 'u':
+            {
+                unsigned long code = read_hex(data);
+                data += 4;
+
+                if (is_high_surrogate(static_cast<unsigned>(code)))
+                {
+                    const unsigned low = read_hex(data + 2);
+                    code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                    data += 6;
+                }
+                out = write_utf8(out, code);
+                break;
+            }
+            default:
+                *out++ = data[-1];
+                break;
+        }
+    }
+    return static_cast<std::size_t>(out - begin);
+}
+
+void sifter::detail::json_escape(std::string &out, const char *data,
+                                 std::size_t size)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    out += '"';
+    const char *end = data + size;
+    const char *plain = data;
+
+    for (; data != end; ++data)
+    {
+        const auto c = static_cast<unsigned char>(*data);
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        out.append(plain, data);
+        switch (c)
+        {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+            {
+                const char escape[] = {'\\', 'u', '0', '0', hex[c >> 4],
+                                       hex[c & 0xf]};
+                out.append(escape, sizeof(escape));
+                break;
+            }
+        }
+        plain = data + 1;
+    }
+    out.append(plain, end);
+    out += '"';
+}
+
+void sifter::detail::json_floating(std::string &out, double value)
+{
+    if (!std::isfinite(value))
+        throw std::invalid_argument("JSON can't represent " +
+                                    std::to_string(value));
+
+    char text[floating_size];
+    const int size = std::snprintf(text, sizeof(text), "%.17g", value);
+    out.append(text, static_cast<std::size_t>(size));
+
+    if (out.find_first_of(".eE", out.size() - static_cast<std::size_t>(size))
+        == std::string::npos)
+        out += ".0";
+}
+
+bool sifter::detail::json_comparison(const char *data, std::size_t size,
+                                     comparison &out)
+{
+    const comparison all[] = {eq, ne, lt, le, gt, ge, like, not_like};
+    for (const comparison c : all)
+    {
+        const char *text = token(c);
+        if (std::strlen(text) == size && std::memcmp(text, data, size) == 0)
+        {
+            out = c;
+            return true;
+        }
+    }
+    return false;
+}
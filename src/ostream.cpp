@@ -30,61 +30,17 @@ sifter::default_dumper::default_dumper(std::ostream &out)
 template <>
 void sifter::default_dumper::operator()(const sifter::special &value)
 {
-    switch (value)
-    {
-        case special::filter_begin:
-            m_out << '(';
-            break;
-        case special::filter_end:
-            m_out << ')';
-            break;
-        case special::condition_begin:
-        case special::condition_end:
-            break;
-    }
+    m_out << token(value);
 }
 
 template <>
 void sifter::default_dumper::operator()(const sifter::operation &value)
 {
-    switch (value)
-    {
-        case operation::_none:
-            break;
-        case operation::_and:
-            m_out << "&&";
-            break;
-        case operation::_or:
-            m_out << "||";
-            break;
-    }
+    m_out << token(value);
 }
 
 template <>
 void sifter::default_dumper::operator()(const sifter::comparison &value)
 {
-    switch (value)
-    {
-        case eq:
-            m_out << "==";
-            break;
-        case ne:
-            m_out << "!=";
-            break;
-        case lt:
-            m_out << '<';
-            break;
-        case le:
-            m_out << "<=";
-            break;
-        case gt:
-            m_out << '>';
-            break;
-        case ge:
-            m_out << ">=";
-            break;
-        case like:
-            m_out << '~';
-            break;
-    }
+    m_out << token(value);
 }
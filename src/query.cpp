@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <sifter/query.hpp>
+
+namespace
+{
+    int hex_value(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    bool is_digit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    /*
+     * Longest floating point value, which is accepted. Values are copied to
+     * the null terminated stack buffer for strtod().
+     */
+    const std::size_t floating_size = 64;
+}
+
+sifter::query_error::query_error(const std::string &what,
+                                 std::size_t offset)
+    : std::invalid_argument(what + " at position " + std::to_string(offset)),
+      m_offset(offset)
+{
+}
+
+std::size_t sifter::query_error::offset() const
+{
+    return m_offset;
+}
+
+bool sifter::detail::query_escaped(const char *data, std::size_t size)
+{
+    for (const char *end = data + size; data != end; ++data)
+    {
+        if (*data == '%' || *data == '+')
+            return true;
+    }
+    return false;
+}
+
+bool sifter::detail::query_unescape(const char *data, std::size_t size,
+                                    char *out, std::size_t &out_size)
+{
+    const char *end = data + size;
+    char *begin = out;
+
+    while (data != end)
+    {
+        if (*data == '+')
+        {
+            *out++ = ' ';
+            ++data;
+        }
+        else if (*data == '%')
+        {
+            if (end - data < 3)
+                return false;
+
+            const int high = hex_value(data[1]);
+            const int low = hex_value(data[2]);
+            if (high < 0 || low < 0)
+                return false;
+
+            *out++ = static_cast<char>(high * 16 + low);
+            data += 3;
+        }
+        else
+        {
+            *out++ = *data++;
+        }
+    }
+
+    out_size = static_cast<std::size_t>(out - begin);
+    return true;
+}
+
+bool sifter::detail::query_comparison(const char *data, std::size_t size,
+                                      comparison &out)
+{
+    static const struct
+    {
+        const char *name;
+        comparison value;
+    } names[] = {
+            {"eq", eq},
+            {"ne", ne},
+            {"lt", lt},
+            {"le", le},
+            {"gt", gt},
+            {"ge", ge},
+            {"like", like},
+            {"nlike", not_like}
+    };
+
+    for (const auto &name : names)
+    {
+        if (std::strlen(name.name) == size &&
+            std::memcmp(name.name, data, size) == 0)
+        {
+            out = name.value;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool sifter::detail::query_integer(const char *data, std::size_t size,
+                                   long long &out)
+{
+    const char *end = data + size;
+    const bool negative = data != end && *data == '-';
+    if (negative)
+        ++data;
+
+    if (data == end)
+        return false;
+
+    const unsigned long long limit =
+            static_cast<unsigned long long>(
+                    std::numeric_limits<long long>::max()) + (negative ? 1 : 0);
+    unsigned long long value = 0;
+    for (; data != end; ++data)
+    {
+        if (!is_digit(*data))
+            return false;
+
+        const auto digit = static_cast<unsigned long long>(*data - '0');
+        if (value > (limit - digit) / 10)
+            return false;
+
+        value = value * 10 + digit;
+    }
+
+    out = negative ? static_cast<long long>(0 - value)
+                   : static_cast<long long>(value);
+    return true;
+}
+
+bool sifter::detail::query_floating(const char *data, std::size_t size,
+                                    double &out)
+{
+    if (size == 0 || size >= floating_size)
+        return false;
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        const char c = data[i];
+        if (!is_digit(c) && c != '.' && c != '-' && c != '+' && c != 'e' &&
+            c != 'E')
+            return false;
+    }
+
+    char text[floating_size];
+    std::memcpy(text, data, size);
+    text[size] = '\0';
+
+    char *end = nullptr;
+    out = std::strtod(text, &end);
+    return end == text + size;
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <sifter/thread_pool.hpp>
+
+sifter::thread_pool::thread_pool(std::size_t size)
+    : m_task(nullptr),
+      m_generation(0),
+      m_running(0),
+      m_stop(false)
+{
+    for (std::size_t i = 1; i < size; ++i)
+        m_threads.emplace_back(&thread_pool::work, this, i);
+}
+
+sifter::thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_start.notify_all();
+
+    for (auto &thread : m_threads)
+        thread.join();
+}
+
+void sifter::thread_pool::run(const task_type &task)
+{
+    std::lock_guard<std::mutex> run_lock(m_run_mutex);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_running = m_threads.size();
+        m_error = nullptr;
+        ++m_generation;
+    }
+    m_start.notify_all();
+
+    try
+    {
+        task(0);
+    }
+    catch (...)
+    {
+        fail();
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_running == 0; });
+    m_task = nullptr;
+
+    if (m_error)
+        std::rethrow_exception(m_error);
+}
+
+std::size_t sifter::thread_pool::default_size()
+{
+    const std::size_t size = std::thread::hardware_concurrency();
+    return size == 0 ? 1 : size;
+}
+
+void sifter::thread_pool::work(std::size_t worker)
+{
+    std::size_t generation = 0;
+
+    for (;;)
+    {
+        const task_type *task = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock, [this, generation] {
+                return m_stop || m_generation != generation;
+            });
+
+            if (m_stop)
+                return;
+
+            generation = m_generation;
+            task = m_task;
+        }
+
+        try
+        {
+            (*task)(worker);
+        }
+        catch (...)
+        {
+            fail();
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_running == 0)
+            m_done.notify_one();
+    }
+}
+
+void sifter::thread_pool::fail()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_error)
+        m_error = std::current_exception();
+}
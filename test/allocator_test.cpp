@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <string>
+#include <type_traits>
+#include <gtest/gtest.h>
+#include <sifter/filter.hpp>
+
+#ifndef SIFTER_USE_BOOST_VARIANT
+
+namespace
+{
+    enum field
+    {
+        name,
+        age
+    };
+
+    class counting_resource : public std::pmr::memory_resource
+    {
+    public:
+        std::size_t allocations = 0;
+        std::size_t deallocations = 0;
+
+    private:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *p, std::size_t bytes,
+                           std::size_t alignment) override
+        {
+            ++deallocations;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const memory_resource &r) const noexcept override
+        {
+            return this == &r;
+        }
+    };
+
+    class default_resource_guard
+    {
+    public:
+        explicit default_resource_guard(std::pmr::memory_resource *r)
+            : m_previous(std::pmr::set_default_resource(r))
+        {
+        }
+
+        ~default_resource_guard()
+        {
+            std::pmr::set_default_resource(m_previous);
+        }
+
+    private:
+        std::pmr::memory_resource *m_previous;
+    };
+
+    using condition = sifter::condition<field, int, std::pmr::string>;
+    using filter = sifter::filter<field, int, std::pmr::string>;
+}
+
+TEST(allocator, resource)
+{
+    counting_resource arena;
+    const sifter::allocator_type a(&arena);
+
+    const condition c0 = condition(name) % "some rather long name, which "
+                                           "does not fit into small buffer";
+    const condition c1 = condition(age) > 20;
+    const condition c2 = condition(age) < 60;
+    const filter source = c0 && c1;
+
+    {
+        default_resource_guard guard(std::pmr::null_memory_resource());
+
+        filter f0(source, a);
+        EXPECT_EQ(f0, source);
+        EXPECT_EQ(f0.get_allocator(), a);
+
+        f0 |= c2;
+        f0 &= source;
+        EXPECT_EQ(f0.get_allocator(), a);
+
+        filter f1 = f0 && c2;
+        EXPECT_EQ(f1.get_allocator(), a);
+        EXPECT_TRUE(f1.left_filter().left_filter().left_filter()
+                            .left_is_condition());
+
+        const std::pmr::string &s = sifter::get<std::pmr::string>(
+                f1.left_filter().left_filter().left_filter()
+                        .left_condition().rhs());
+        EXPECT_EQ(s.get_allocator().resource(), &arena);
+
+        filter f2(a);
+        f2 = std::move(f1);
+        EXPECT_EQ(f2.get_allocator(), a);
+        EXPECT_FALSE(f1);
+
+        filter f3(std::move(f2), a);
+        EXPECT_EQ(f3.get_allocator(), a);
+
+        EXPECT_GT(arena.allocations, 0u);
+    }
+
+    EXPECT_EQ(arena.allocations, arena.deallocations);
+}
+
+TEST(allocator, condition)
+{
+    counting_resource arena;
+    const sifter::allocator_type a(&arena);
+
+    const condition::basic_type named(
+            condition(name) == "some rather long name, which does not fit "
+                               "into small buffer", a);
+    const condition older = condition(age) > 20;
+    EXPECT_EQ(named.get_allocator(), a);
+    EXPECT_EQ(older.get_allocator(), sifter::allocator_type());
+
+    {
+        default_resource_guard guard(std::pmr::null_memory_resource());
+
+        const filter f0 = named && older;
+        EXPECT_EQ(f0.get_allocator(), a);
+
+        const filter f1 = named || named;
+        EXPECT_EQ(f1.get_allocator(), a);
+
+        const filter f2 = older && f0;
+        EXPECT_EQ(f2.get_allocator(), a);
+
+        const filter f3 = older || f1;
+        EXPECT_EQ(f3.get_allocator(), a);
+    }
+
+    EXPECT_EQ(arena.allocations, arena.deallocations + 1);
+}
+
+TEST(allocator, copy)
+{
+    counting_resource arena;
+    const sifter::allocator_type a(&arena);
+
+    filter f0(condition(age) > 20, a);
+    f0 &= condition(age) < 60;
+
+    const std::size_t allocations = arena.allocations;
+
+    filter f1 = f0;
+    EXPECT_EQ(f1, f0);
+    EXPECT_EQ(f1.get_allocator(), sifter::allocator_type());
+    EXPECT_EQ(arena.allocations, allocations);
+
+    filter f2(a);
+    f2 = f1;
+    EXPECT_EQ(f2, f0);
+    EXPECT_EQ(f2.get_allocator(), a);
+    EXPECT_GT(arena.allocations, allocations);
+
+    f1 = std::move(f2);
+    EXPECT_EQ(f1, f0);
+    EXPECT_EQ(f1.get_allocator(), sifter::allocator_type());
+}
+
+TEST(allocator, monotonic_buffer)
+{
+    std::pmr::monotonic_buffer_resource arena;
+    const sifter::allocator_type a(&arena);
+
+    filter f(a);
+    for (int i = 0; i < 100; ++i)
+        f |= condition(age) == i;
+
+    EXPECT_EQ(f.get_allocator(), a);
+    EXPECT_EQ(f.right_condition(), condition(age) == 99);
+}
+
+TEST(allocator, layout)
+{
+    /*
+     * The allocator is stored once per node, not by each pointer.
+     */
+    EXPECT_EQ(sizeof(filter::node_type),
+              sizeof(sifter::allocator_type) + 2 * sizeof(void *));
+
+    /*
+     * Polymorphic allocators may differ and are not propagated, so move
+     * assignment may copy the nodes.
+     */
+    EXPECT_TRUE(std::is_nothrow_move_constructible<filter>::value);
+    EXPECT_FALSE(std::is_nothrow_move_assignable<filter>::value);
+}
+#else
+
+TEST(allocator, default_allocator)
+{
+    using filter = sifter::filter<int, std::string>;
+    using condition = sifter::condition<int, std::string>;
+
+    filter f0(condition(1) == 2, sifter::allocator_type());
+    filter f1(f0, f0.get_allocator());
+    EXPECT_EQ(f0, f1);
+}
+
+TEST(allocator, layout)
+{
+    using filter = sifter::filter<int, std::string>;
+
+    EXPECT_EQ(sizeof(filter::node_type), 2 * sizeof(void *));
+    EXPECT_TRUE(std::is_nothrow_move_constructible<filter>::value);
+    EXPECT_TRUE(std::is_nothrow_move_assignable<filter>::value);
+}
+#endif
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <sstream>
+#include <gtest/gtest.h>
+#include <sifter/buffer_dumper.hpp>
+
+namespace
+{
+    enum field
+    {
+        id,
+        name
+    };
+
+    enum class color
+    {
+        red,
+        green
+    };
+
+    std::ostream &operator<<(std::ostream &out, color c)
+    {
+        return out << (c == color::red ? "red" : "green");
+    }
+
+    struct point
+    {
+        int x;
+        int y;
+
+        bool operator==(const point &p) const
+        {
+            return x == p.x && y == p.y;
+        }
+    };
+
+    std::ostream &operator<<(std::ostream &out, const point &p)
+    {
+        return out << '[' << p.x << ',' << p.y << ']';
+    }
+
+    template <typename... Types>
+    void expect_same(const sifter::filter<Types...> &f)
+    {
+        std::stringstream expected;
+        expected << sifter::out<sifter::default_dumper, Types...>(f);
+
+        std::string buffer = "prefix:";
+        sifter::dump(buffer, f);
+        EXPECT_EQ(buffer, "prefix:" + expected.str());
+    }
+}
+
+TEST(buffer_dumper, compatibility)
+{
+    using condition = sifter::condition<field, int, std::string>;
+    using filter = sifter::filter<field, int, std::string>;
+
+    expect_same(filter(condition(id) < -10 && condition(name) % "some text"));
+    expect_same(filter(condition(id) == 2147483647 ||
+                       (condition(name) != "x" && condition(5) >= 7)));
+    expect_same(filter());
+    expect_same(~(condition(id) < -10 && condition(name) % "some text"));
+
+    using vcondition = sifter::condition<color, double, long long, unsigned,
+            bool, char, point>;
+    using vfilter = sifter::filter<color, double, long long, unsigned, bool,
+            char, point>;
+
+    vfilter f(vcondition(color::red) == 1.5);
+    f &= vcondition(color::green) < 1e20;
+    f &= vcondition(0.1) > 123456789.0;
+    f |= vcondition(-9223372036854775807LL) <= 4294967295u;
+    f |= vcondition(true) != 'c';
+    f |= vcondition(point{1, -2}) == 1e-7;
+    f |= vcondition(0.0) == -2.5e-300;
+    expect_same(f);
+}
+
+TEST(buffer_dumper, condition)
+{
+    using condition = sifter::condition<field, int, std::string>;
+
+    std::string buffer;
+    sifter::dump(buffer, condition(id) >= 5);
+    EXPECT_EQ(buffer, "0>=5");
+
+    buffer.clear();
+    sifter::buffer_dumper dumper(buffer);
+    sifter::out<sifter::buffer_dumper, field, int, std::string>(
+            condition(name) % "J%").write(dumper);
+    dumper.flush();
+    EXPECT_EQ(buffer, "1~J%");
+}
+
+TEST(buffer_dumper, long_output)
+{
+    using condition = sifter::condition<field, int, std::string>;
+    using filter = sifter::filter<field, int, std::string>;
+
+    filter f(condition(name) == std::string(1000, 'a'));
+    for (int i = 0; i < 200; ++i)
+        f &= condition(id) > i;
+    f |= condition(name) == std::string(300, 'b');
+    expect_same(f);
+}
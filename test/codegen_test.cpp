@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <limits>
+#include <sstream>
+#include <vector>
+#include <gtest/gtest.h>
+#include <sifter/evaluate.hpp>
+#include <sifter/ostream.hpp>
+#include <codegen/codegen.hpp>
+#include "generated_filters.hpp"
+
+namespace
+{
+    using codegen_test::person;
+
+    using condition = sifter::condition<codegen_test::field, int, double,
+            std::string>;
+    using filter = sifter::filter<codegen_test::field, int, double,
+            std::string>;
+
+    struct person_accessor
+    {
+        condition::value_type operator()(const person &p,
+                                         codegen_test::field f) const
+        {
+            switch (f)
+            {
+                case codegen_test::id:
+                    return p.id;
+                case codegen_test::name:
+                    return p.name;
+                case codegen_test::age:
+                    return p.age;
+                case codegen_test::rating:
+                    return p.rating;
+            }
+            return condition::value_type();
+        }
+    };
+
+    const std::vector<person> persons =
+    {
+        {1, "John Smith", 20, 4.5},
+        {2, "Jane Smith", 17, 3.0},
+        {3, "Bob", 42, -2.0},
+        {11, "Johnny", 25, 5.0},
+        {12, "Bob", 15, 4.9}
+    };
+
+    template <typename Predicate>
+    void expect_same(Predicate predicate, const filter &f)
+    {
+        for (const auto &p : persons)
+            EXPECT_EQ(predicate(p), sifter::evaluate<codegen_test::field>(
+                    f, p, person_accessor())) << p.id;
+    }
+
+    sifter::codegen::schema_description schema()
+    {
+        std::istringstream in(
+                "record person\n"
+                "field 0 id integer\n"
+                "field 1 name string\n"
+                "field 3 rating floating\n");
+        return sifter::codegen::read_schema(in);
+    }
+
+    std::string round_trip(const std::string &text)
+    {
+        std::ostringstream out;
+        out << sifter::out<sifter::default_dumper, sifter::codegen::field_id,
+                long long, double, std::string>(
+                sifter::codegen::parse(text, schema()));
+        return out.str();
+    }
+}
+
+TEST(codegen, generated)
+{
+    using namespace codegen_test;
+
+    expect_same(rules::everyone, filter());
+    expect_same(rules::young, filter(condition(age) < 30));
+    expect_same(rules::smiths, condition(name) % "%Smith" &&
+                               condition(age) >= 18);
+    expect_same(rules::mixed, condition(id) < 10 &&
+                              (condition(name) % "John%" ||
+                               condition(age) > 20));
+    expect_same(rules::rated, (condition(rating) >= 4.5 ||
+                               condition(rating) < -1.25) &&
+                              condition(name) != "Bob");
+    expect_same(rules::exact, condition(name) == "Jane Smith" ||
+                              (condition(id) == 3 && condition(age) <= 42));
+    expect_same(rules::unlike, ~(condition(name) % "J%" ||
+                                 condition(age) <= 16));
+
+    for (const auto &p : persons)
+        EXPECT_TRUE(rules::extremes(p)) << p.id;
+}
+
+TEST(codegen, parse)
+{
+    EXPECT_EQ(round_trip(""), "");
+    EXPECT_EQ(round_trip("0<10"), "0<10");
+    EXPECT_EQ(round_trip("(0<10&&1~J%)"), "(0<10&&1~J%)");
+    EXPECT_EQ(round_trip("((0>=1||3<-2.5)&&(1==a b||1!=))"),
+              "((0>=1||3<-2.5)&&(1==a b||1!=))");
+    EXPECT_EQ(round_trip("(&&0==1)"), "(&&0==1)");
+    EXPECT_EQ(round_trip("(1!~J%||1!=J)"), "(1!~J%||1!=J)");
+}
+
+TEST(codegen, errors)
+{
+    using sifter::codegen::error;
+
+    EXPECT_THROW(round_trip("2<10"), error);
+    EXPECT_THROW(round_trip("0~10"), error);
+    EXPECT_THROW(round_trip("0!~10"), error);
+    EXPECT_THROW(round_trip("0<x"), error);
+    EXPECT_THROW(round_trip("(0<1&&0<2"), error);
+    EXPECT_THROW(round_trip("(0<1 0<2)"), error);
+    EXPECT_THROW(round_trip("0<1)"), error);
+    EXPECT_THROW(round_trip("99999999999999999999<1"), error);
+    EXPECT_THROW(round_trip("4294967296<1"), error);
+    EXPECT_THROW(round_trip("0<99999999999999999999"), error);
+    EXPECT_THROW(round_trip("3<inf"), error);
+
+    std::istringstream bad_type("record person\nfield 0 id int\n");
+    EXPECT_THROW(sifter::codegen::read_schema(bad_type), error);
+
+    std::istringstream bad_name("1rule 0<1\n");
+    EXPECT_THROW(sifter::codegen::read_filters(bad_name, schema()), error);
+}
+
+TEST(codegen, expression)
+{
+    using sifter::codegen::expression;
+    using sifter::codegen::parse;
+
+    EXPECT_EQ(expression(parse("", schema()), schema()), "true");
+    EXPECT_EQ(expression(parse("(0<1&&3>=2)", schema()), schema()),
+              "(sifter::as_integer(r.id) < 1 && "
+              "sifter::as_floating(r.rating) >= 2.0)");
+    EXPECT_EQ(expression(parse("1~a\"%", schema()), schema()),
+              "sifter::like_match(r.name.data(), r.name.size(), "
+              "\"a\\\"%\", 3)");
+    EXPECT_EQ(expression(parse("1!~a%", schema()), schema()),
+              "!sifter::like_match(r.name.data(), r.name.size(), "
+              "\"a%\", 2)");
+
+    using codegen_condition = sifter::codegen::condition;
+    using codegen_filter = sifter::codegen::filter;
+    const auto id = static_cast<sifter::codegen::field_id>(0);
+    const auto rating = static_cast<sifter::codegen::field_id>(3);
+
+    EXPECT_EQ(expression(parse("0>-9223372036854775808", schema()),
+                         schema()),
+              "sifter::as_integer(r.id) > "
+              "(-9223372036854775807LL - 1)");
+    EXPECT_EQ(expression(codegen_filter(codegen_condition(id) >
+                                        std::numeric_limits<long long>::min()),
+                         schema()),
+              "sifter::as_integer(r.id) > "
+              "(-9223372036854775807LL - 1)");
+    EXPECT_THROW(expression(codegen_filter(codegen_condition(rating) <
+                                           std::numeric_limits<double>::
+                                                   infinity()),
+                            schema()),
+                 sifter::codegen::error);
+    EXPECT_THROW(expression(codegen_filter(codegen_condition(rating) ==
+                                           std::numeric_limits<double>::
+                                                   quiet_NaN()),
+                            schema()),
+                 sifter::codegen::error);
+}
@@ -222,9 +222,9 @@ TEST(condition, transformation)
     EXPECT_EQ(f2.right_filter(), f1);
     EXPECT_EQ(f2.oper(), sifter::operation::_and);
 
-    filter f3 = condition("a") == 3 || condition("a") == 3 &&
-                                       (condition("a") == 3 ||
-                                        condition("b") >= -15);
+    filter f3 = condition("a") == 3 || (condition("a") == 3 &&
+                                        (condition("a") == 3 ||
+                                         condition("b") >= -15));
     ASSERT_TRUE(f3.left_is_condition());
     EXPECT_FALSE(f3.left_is_filter());
     EXPECT_FALSE(f3.right_is_condition());
@@ -232,4 +232,36 @@ TEST(condition, transformation)
     EXPECT_EQ(f3.left_condition(), condition("a", 3));
     EXPECT_EQ(f3.right_filter(), f2);
     EXPECT_EQ(f3.oper(), sifter::operation::_or);
-}
\ No newline at end of file
+}
+
+TEST(condition, negation)
+{
+    enum field
+    {
+        id,
+        name
+    };
+
+    using condition = sifter::condition<field, int, std::string>;
+
+    const sifter::comparison pairs[][2] =
+    {
+        {sifter::eq, sifter::ne},
+        {sifter::lt, sifter::ge},
+        {sifter::le, sifter::gt},
+        {sifter::like, sifter::not_like}
+    };
+    for (const auto &p : pairs)
+    {
+        EXPECT_EQ(sifter::complement(p[0]), p[1]);
+        EXPECT_EQ(sifter::complement(p[1]), p[0]);
+    }
+
+    const auto c = ~(condition(id) < 10);
+    EXPECT_EQ(sifter::get<field>(c.lhs()), id);
+    EXPECT_EQ(sifter::get<int>(c.rhs()), 10);
+    EXPECT_EQ(c.comp(), sifter::ge);
+
+    EXPECT_EQ((~(condition(name) % "J%")).comp(), sifter::not_like);
+    EXPECT_EQ(~~(condition(id) == 1), condition(id) == 1);
+}
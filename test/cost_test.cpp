@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <sifter/cost.hpp>
+#include <sifter/evaluate.hpp>
+#include <sifter/ostream.hpp>
+
+namespace
+{
+    enum field
+    {
+        id,
+        name,
+        age
+    };
+
+    struct person
+    {
+        int id;
+        std::string name;
+        int age;
+    };
+
+    using condition = sifter::condition<field, int, std::string>;
+    using filter = sifter::filter<field, int, std::string>;
+
+    struct person_accessor
+    {
+        condition::value_type operator()(const person &p, field f) const
+        {
+            switch (f)
+            {
+                case id:
+                    return p.id;
+                case name:
+                    return p.name;
+                case age:
+                    return p.age;
+            }
+            return condition::value_type();
+        }
+    };
+
+    std::string text(const filter &f)
+    {
+        std::ostringstream out;
+        out << sifter::out<sifter::default_dumper, field, int, std::string>(f);
+        return out.str();
+    }
+}
+
+TEST(cost, default_cost)
+{
+    const sifter::default_cost cost;
+    EXPECT_LT(cost(condition(id) == 1), cost(condition(name) == "John"));
+    EXPECT_LT(cost(condition(name) == "John"), cost(condition(name) % "J%"));
+}
+
+TEST(cost, order)
+{
+    EXPECT_EQ(text(sifter::order_by_cost(filter())), "");
+    EXPECT_EQ(text(sifter::order_by_cost(filter(condition(id) < 1))), "0<1");
+    EXPECT_EQ(text(sifter::order_by_cost(condition(name) % "J%" &&
+                                         condition(id) < 1)),
+              "(0<1&&1~J%)");
+    EXPECT_EQ(text(sifter::order_by_cost(
+                      (condition(name) % "J%" || condition(name) == "Bob") &&
+                      (condition(id) < 1 || condition(age) > 2))),
+              "((0<1||2>2)&&(1==Bob||1~J%))");
+}
+
+TEST(cost, evaluation)
+{
+    const std::vector<person> persons =
+    {
+        {1, "John", 20},
+        {2, "Bob", 30},
+        {3, "Jane", 40}
+    };
+
+    const std::vector<filter> filters =
+    {
+        condition(name) % "J%" && condition(id) < 3,
+        condition(name) % "%o%" || (condition(age) > 25 &&
+                                    condition(name) == "Jane"),
+        (condition(name) == "Bob" || condition(id) == 1) &&
+                (condition(name) % "Jo%" || condition(age) >= 30)
+    };
+
+    for (const auto &f : filters)
+    {
+        const filter ordered = sifter::order_by_cost(f);
+        for (const auto &p : persons)
+            EXPECT_EQ(sifter::evaluate<field>(ordered, p, person_accessor()),
+                      sifter::evaluate<field>(f, p, person_accessor()));
+    }
+}
+
+TEST(cost, custom)
+{
+    struct reverse_cost
+    {
+        double operator()(const filter::condition_type &c) const
+        {
+            return c.comp() == sifter::like ? 0.0 : 1.0;
+        }
+    };
+
+    EXPECT_EQ(text(sifter::order_by_cost(condition(id) < 1 &&
+                                         condition(name) % "J%",
+                                         reverse_cost())),
+              "(1~J%&&0<1)");
+}
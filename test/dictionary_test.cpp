@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <sifter/dictionary.hpp>
+
+namespace
+{
+    enum field
+    {
+        status,
+        country,
+        score
+    };
+
+    using condition = sifter::condition<field, int, std::string>;
+    using filter = sifter::filter<field, int, std::string>;
+    using column = sifter::dictionary_column<condition::value_type>;
+}
+
+TEST(bitmap, operations)
+{
+    sifter::bitmap b0(70);
+    EXPECT_EQ(b0.size(), 70u);
+    EXPECT_TRUE(b0.none());
+
+    b0.set(3);
+    b0.set(69);
+    EXPECT_TRUE(b0.test(3));
+    EXPECT_TRUE(b0.test(69));
+    EXPECT_FALSE(b0.test(4));
+    EXPECT_EQ(b0.count(), 2u);
+
+    sifter::bitmap b1(70, true);
+    EXPECT_TRUE(b1.all());
+    EXPECT_EQ(b1.count(), 70u);
+
+    b1.reset(3);
+    b1 &= b0;
+    EXPECT_EQ(b1.count(), 1u);
+    EXPECT_TRUE(b1.test(69));
+
+    b1 |= b0;
+    EXPECT_EQ(b1, b0);
+
+    b1.flip();
+    EXPECT_EQ(b1.count(), 68u);
+
+    std::vector<std::size_t> positions;
+    b0.for_each([&positions](std::size_t pos) { positions.push_back(pos); });
+    EXPECT_EQ(positions, std::vector<std::size_t>({3, 69}));
+
+    b1.reset();
+    EXPECT_TRUE(b1.none());
+    EXPECT_EQ(b1.size(), 70u);
+}
+
+TEST(dictionary, column)
+{
+    column c;
+    EXPECT_EQ(c.push_back("active"), 0u);
+    EXPECT_EQ(c.push_back("blocked"), 1u);
+    EXPECT_EQ(c.push_back("active"), 0u);
+
+    EXPECT_EQ(c.size(), 3u);
+    EXPECT_EQ(c.dictionary().size(), 2u);
+    EXPECT_EQ(sifter::get<std::string>(c[2]), "active");
+
+    column d(c.dictionary(), c.codes());
+    EXPECT_EQ(d.push_back("blocked"), 1u);
+    EXPECT_EQ(d.push_back("new"), 2u);
+}
+
+TEST(dictionary, evaluate)
+{
+    const char *statuses[] = {"active", "blocked", "new"};
+    const char *countries[] = {"DE", "FR", "US", "DK"};
+
+    std::map<field, column> columns;
+    const std::size_t rows = 200;
+    for (std::size_t i = 0; i < rows; ++i)
+    {
+        columns[status].push_back(statuses[i % 3]);
+        columns[country].push_back(countries[i % 4]);
+        columns[score].push_back(static_cast<int>(i % 10));
+    }
+
+    const auto lookup = [&columns](field f) -> const column &
+    {
+        return columns.at(f);
+    };
+
+    filter f0 = condition(status) == "active" &&
+                (condition(country) % "D%" || condition(score) >= 8);
+    const sifter::bitmap b0 = sifter::evaluate_dictionary<field>(f0, lookup,
+                                                                 rows);
+    ASSERT_EQ(b0.size(), rows);
+    for (std::size_t i = 0; i < rows; ++i)
+    {
+        const bool expected = i % 3 == 0 &&
+                              (i % 4 == 0 || i % 4 == 3 || i % 10 >= 8);
+        EXPECT_EQ(b0.test(i), expected) << i;
+    }
+
+    const sifter::bitmap b1 = sifter::evaluate_dictionary<field>(
+            condition("FR") == condition::value_type(country), lookup, rows);
+    EXPECT_EQ(b1.count(), rows / 4);
+
+    const sifter::bitmap b2 = sifter::evaluate_dictionary<field>(
+            condition(status, country, sifter::eq), lookup, rows);
+    EXPECT_TRUE(b2.none());
+
+    EXPECT_TRUE(sifter::evaluate_dictionary<field>(filter(), lookup, rows)
+                        .all());
+    EXPECT_TRUE(sifter::evaluate_dictionary<field>(condition(1) < 2, lookup,
+                                                   rows).all());
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <map>
+#include <gtest/gtest.h>
+#include <sifter/evaluate.hpp>
+
+namespace
+{
+    enum field
+    {
+        id,
+        name,
+        age
+    };
+
+    struct person
+    {
+        int id;
+        std::string name;
+        int age;
+    };
+
+    using condition = sifter::condition<field, int, std::string>;
+    using filter = sifter::filter<field, int, std::string>;
+
+    struct person_accessor
+    {
+        condition::value_type operator()(const person &p, field f) const
+        {
+            switch (f)
+            {
+                case id:
+                    return p.id;
+                case name:
+                    return p.name;
+                case age:
+                    return p.age;
+            }
+            return condition::value_type();
+        }
+    };
+}
+
+TEST(evaluate, like_match)
+{
+    EXPECT_TRUE(sifter::like_match("John Smith", "John%"));
+    EXPECT_TRUE(sifter::like_match("John Smith", "%Smith"));
+    EXPECT_TRUE(sifter::like_match("John Smith", "%n S%"));
+    EXPECT_TRUE(sifter::like_match("John Smith", "J_hn Smit_"));
+    EXPECT_TRUE(sifter::like_match("John Smith", "%"));
+    EXPECT_TRUE(sifter::like_match("", "%%"));
+    EXPECT_TRUE(sifter::like_match("aaab", "%a%ab"));
+    EXPECT_FALSE(sifter::like_match("John Smith", "John"));
+    EXPECT_FALSE(sifter::like_match("John Smith", "%Smit"));
+    EXPECT_FALSE(sifter::like_match("John", "J_"));
+    EXPECT_FALSE(sifter::like_match("", "_"));
+}
+
+TEST(evaluate, compare)
+{
+    using value_type = condition::value_type;
+
+    EXPECT_TRUE(sifter::compare(sifter::eq, value_type(1), value_type(1)));
+    EXPECT_TRUE(sifter::compare(sifter::ne, value_type(1), value_type(2)));
+    EXPECT_TRUE(sifter::compare(sifter::lt, value_type(1), value_type(2)));
+    EXPECT_TRUE(sifter::compare(sifter::le, value_type(2), value_type(2)));
+    EXPECT_TRUE(sifter::compare(sifter::gt, value_type(3), value_type(2)));
+    EXPECT_TRUE(sifter::compare(sifter::ge, value_type(2), value_type(2)));
+    EXPECT_FALSE(sifter::compare(sifter::like, value_type(2), value_type(2)));
+    EXPECT_TRUE(sifter::compare(sifter::like, value_type("abc"),
+                                value_type("a%")));
+    EXPECT_FALSE(sifter::compare(sifter::not_like, value_type("abc"),
+                                 value_type("a%")));
+    EXPECT_TRUE(sifter::compare(sifter::not_like, value_type("abc"),
+                                value_type("b%")));
+    EXPECT_TRUE(sifter::compare(sifter::not_like, value_type(2),
+                                value_type(2)));
+
+    EXPECT_FALSE(sifter::compare(sifter::eq, value_type(1), value_type("1")));
+    EXPECT_TRUE(sifter::compare(sifter::ne, value_type(1), value_type("1")));
+    EXPECT_FALSE(sifter::compare(sifter::lt, value_type(1), value_type("1")));
+    EXPECT_TRUE(sifter::compare(sifter::not_like, value_type(1),
+                                value_type("1")));
+}
+
+TEST(evaluate, filter)
+{
+    const person john = {1, "John Smith", 25};
+    const person jane = {2, "Jane Doe", 17};
+    const person_accessor accessor;
+
+    filter f0 = condition(id) < 10 &&
+                (condition(name) % "John%" || condition(age) > 20);
+    EXPECT_TRUE(sifter::evaluate<field>(f0, john, accessor));
+    EXPECT_FALSE(sifter::evaluate<field>(f0, jane, accessor));
+
+    EXPECT_TRUE(sifter::evaluate<field>(filter(), jane, accessor));
+
+    filter f1;
+    f1 |= condition(age) < 18;
+    EXPECT_FALSE(sifter::evaluate<field>(f1, john, accessor));
+    EXPECT_TRUE(sifter::evaluate<field>(f1, jane, accessor));
+
+    EXPECT_TRUE(sifter::evaluate<field>(condition(5) > 3, jane, accessor));
+    EXPECT_TRUE(sifter::evaluate<field>(condition(age, id, sifter::gt), john,
+                                        accessor));
+}
+
+TEST(evaluate, negation)
+{
+    const person people[] =
+    {
+        {1, "John Smith", 25},
+        {2, "Jane Doe", 17},
+        {12, "Bob", 40}
+    };
+    const person_accessor accessor;
+
+    const filter f = (condition(id) < 10 &&
+                      (condition(name) % "John%" || condition(age) > 20)) ||
+                     condition(age) == 40;
+    for (const person &p : people)
+    {
+        EXPECT_NE(sifter::evaluate<field>(~f, p, accessor),
+                  sifter::evaluate<field>(f, p, accessor));
+    }
+}
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <sifter/filter_batch.hpp>
+
+namespace
+{
+    enum field
+    {
+        status,
+        country,
+        age
+    };
+
+    struct subscriber
+    {
+        std::string status;
+        std::string country;
+        int age;
+    };
+
+    using condition = sifter::condition<field, int, std::string>;
+    using filter = sifter::filter<field, int, std::string>;
+
+    struct counting_accessor
+    {
+        explicit counting_accessor(std::vector<field> *reads = nullptr)
+            : m_reads(reads)
+        {
+        }
+
+        condition::value_type operator()(const subscriber &s, field f) const
+        {
+            if (m_reads)
+                m_reads->push_back(f);
+
+            switch (f)
+            {
+                case status:
+                    return s.status;
+                case country:
+                    return s.country;
+                case age:
+                    return s.age;
+            }
+            return condition::value_type();
+        }
+
+    private:
+        std::vector<field> *m_reads;
+    };
+
+    using batch = sifter::filter_batch<field, filter, counting_accessor>;
+}
+
+TEST(filter_batch, shared_conditions)
+{
+    std::vector<field> reads;
+    const batch b({condition(status) == "active" && condition(country) == "DE",
+                   condition(status) == "active" && condition(age) > 30,
+                   condition(country) == "DE" || condition(age) > 30,
+                   filter(condition(status) == "active")},
+                  counting_accessor(&reads));
+
+    EXPECT_EQ(b.size(), 4u);
+    EXPECT_EQ(b.conditions().size(), 3u);
+
+    const subscriber s = {"active", "DE", 20};
+    const sifter::bitmap m = b.match(s);
+    EXPECT_TRUE(m.test(0));
+    EXPECT_FALSE(m.test(1));
+    EXPECT_TRUE(m.test(2));
+    EXPECT_TRUE(m.test(3));
+    EXPECT_EQ(reads, std::vector<field>({status, country, age}));
+
+    reads.clear();
+    const subscriber t = {"blocked", "FR", 40};
+    const sifter::bitmap n = b.match(t);
+    EXPECT_EQ(n.count(), 1u);
+    EXPECT_TRUE(n.test(2));
+    EXPECT_EQ(reads, std::vector<field>({status, country, age}));
+}
+
+TEST(filter_batch, short_circuit)
+{
+    std::vector<field> reads;
+    const batch b({condition(status) == "active" && condition(age) > 30,
+                   condition(status) == "active" && condition(country) == "DE"},
+                  counting_accessor(&reads));
+
+    b.match(subscriber{"blocked", "DE", 40});
+    EXPECT_EQ(reads, std::vector<field>({status}));
+}
+
+TEST(filter_batch, scratch)
+{
+    std::vector<field> reads;
+    const batch b({condition(status) == "active" && condition(country) == "DE",
+                   condition(country) == "DE" || condition(age) > 30},
+                  counting_accessor(&reads));
+
+    batch::scratch s;
+    sifter::bitmap m;
+    b.match(subscriber{"active", "DE", 20}, s, m);
+    EXPECT_EQ(m, b.match(subscriber{"active", "DE", 20}));
+    EXPECT_EQ(m.count(), 2u);
+
+    const auto *words = m.words().data();
+    reads.clear();
+    b.match(subscriber{"blocked", "FR", 40}, s, m);
+    EXPECT_EQ(m.size(), 2u);
+    EXPECT_FALSE(m.test(0));
+    EXPECT_TRUE(m.test(1));
+    EXPECT_EQ(m.words().data(), words);
+    EXPECT_EQ(reads, std::vector<field>({status, country, age}));
+
+    const batch other({filter(condition(age) > 30), filter(condition(age) < 30),
+                       filter(condition(status) == "new")});
+    other.match(subscriber{"new", "FR", 40}, s, m);
+    EXPECT_EQ(m.size(), 3u);
+    EXPECT_TRUE(m.test(0));
+    EXPECT_FALSE(m.test(1));
+    EXPECT_TRUE(m.test(2));
+}
+
+TEST(filter_batch, empty)
+{
+    const batch none({});
+    EXPECT_EQ(none.match(subscriber{"", "", 0}).size(), 0u);
+
+    const batch any({filter()});
+    EXPECT_TRUE(any.match(subscriber{"", "", 0}).all());
+}
+
+TEST(filter_batch, equivalence)
+{
+    const std::vector<condition> pool =
+    {
+        condition(status) == "active",
+        condition(status) != "blocked",
+        condition(country) == "DE",
+        condition(country) % "F%",
+        condition(age) > 30,
+        condition(age) <= 18
+    };
+
+    std::mt19937 random(5);
+    std::vector<filter> filters;
+    for (int i = 0; i < 200; ++i)
+    {
+        filter f(pool[random() % pool.size()]);
+        const int size = static_cast<int>(random() % 4);
+        for (int j = 0; j < size; ++j)
+        {
+            if (random() % 2)
+                f &= pool[random() % pool.size()];
+            else
+                f |= pool[random() % pool.size()];
+        }
+        filters.push_back(f);
+    }
+
+    const batch b(filters);
+    EXPECT_EQ(b.conditions().size(), pool.size());
+
+    const std::vector<subscriber> subscribers =
+    {
+        {"active", "DE", 40},
+        {"blocked", "FR", 10},
+        {"new", "FI", 18},
+        {"active", "US", 31}
+    };
+    for (const subscriber &s : subscribers)
+    {
+        const sifter::bitmap m = b.match(s);
+        for (std::size_t i = 0; i < filters.size(); ++i)
+            EXPECT_EQ(m.test(i), sifter::evaluate<field>(
+                    filters[i], s, counting_accessor()));
+    }
+}
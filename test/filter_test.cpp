@@ -254,4 +254,62 @@ TEST(basic_filter, comparison)
 
     EXPECT_EQ(f0, f1);
     EXPECT_FALSE(f0 != f1);
-}
\ No newline at end of file
+}
+
+TEST(basic_filter, rvalue_operators)
+{
+    using basic_condition =
+      sifter::basic_condition<sifter::comparison, sifter::eq, int, std::string>;
+    using basic_filter =
+         sifter::basic_filter<sifter::comparison, sifter::eq, int, std::string>;
+
+    auto c0 = basic_condition("a", 3, sifter::lt);
+    auto c1 = basic_condition("name", "test", sifter::like);
+    auto c2 = basic_condition("z", 4);
+
+    basic_filter expected(c0);
+    expected &= c1;
+    expected |= c2;
+    expected &= basic_filter(c0) || basic_filter(c1);
+
+    basic_filter f(c0);
+    f &= basic_condition(c1);
+    f |= basic_condition(c2);
+    f &= basic_filter(c0) || basic_filter(c1);
+    EXPECT_EQ(f, expected);
+    EXPECT_EQ(f.nodes(), expected.nodes());
+    EXPECT_EQ(f.depth(), expected.depth());
+
+    basic_filter empty;
+    empty |= basic_filter();
+    EXPECT_TRUE(!empty);
+    empty &= basic_filter(c2);
+    EXPECT_EQ(empty.oper(), sifter::operation::_and);
+    EXPECT_EQ(empty.right_condition(), c2);
+}
+
+TEST(basic_filter, negation)
+{
+    using condition = sifter::condition<std::string, int>;
+    using filter = sifter::filter<std::string, int>;
+
+    const filter f0 = condition("a") < 1 &&
+                      (condition("b") == 2 || condition("c") >= 3);
+    const filter n0 = condition("a") >= 1 ||
+                      (condition("b") != 2 && condition("c") < 3);
+    EXPECT_EQ(~f0, n0);
+    EXPECT_EQ(~n0, f0);
+
+    const filter f1(condition("a") > 1);
+    EXPECT_EQ(~f1, filter(condition("a") <= 1));
+
+    filter f2;
+    f2 |= condition("b") == 2;
+    const filter n2 = ~f2;
+    EXPECT_FALSE(n2.left_is_condition());
+    ASSERT_TRUE(n2.right_is_condition());
+    EXPECT_EQ(n2.right_condition(), condition("b") != 2);
+    EXPECT_EQ(n2.oper(), sifter::operation::_and);
+
+    EXPECT_THROW(~filter(), std::domain_error);
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <sifter/flat.hpp>
+
+namespace
+{
+    enum field
+    {
+        a,
+        b,
+        c
+    };
+
+    using condition = sifter::condition<field, int>;
+    using filter = sifter::filter<field, int>;
+
+    struct field_of
+    {
+        field operator()(const filter::condition_type &c) const
+        {
+            return sifter::get<field>(c.lhs());
+        }
+    };
+
+    struct truth
+    {
+        truth(bool a_value, bool b_value, bool c_value,
+              std::vector<field> &tested)
+            : m_values{a_value, b_value, c_value},
+              m_tested(tested)
+        {
+        }
+
+        bool operator()(field f) const
+        {
+            m_tested.push_back(f);
+            return m_values[f];
+        }
+
+    private:
+        bool m_values[3];
+        std::vector<field> &m_tested;
+    };
+}
+
+TEST(flat, empty)
+{
+    const auto program = sifter::flatten(filter(), field_of());
+    EXPECT_TRUE(program.empty());
+
+    std::vector<field> tested;
+    EXPECT_TRUE(program.run(truth(false, false, false, tested)));
+    EXPECT_TRUE(tested.empty());
+}
+
+TEST(flat, short_circuit)
+{
+    const filter f = condition(a) == 0 &&
+                     (condition(b) == 0 || condition(c) == 0);
+    const auto program = sifter::flatten(f, field_of());
+
+    ASSERT_EQ(program.size(), 3u);
+    EXPECT_EQ(program.entry(), 0u);
+    EXPECT_EQ(program.steps()[0].condition, a);
+    EXPECT_EQ(program.steps()[1].condition, b);
+    EXPECT_EQ(program.steps()[2].condition, c);
+
+    std::vector<field> tested;
+    EXPECT_FALSE(program.run(truth(false, true, true, tested)));
+    EXPECT_EQ(tested, std::vector<field>({a}));
+
+    tested.clear();
+    EXPECT_TRUE(program.run(truth(true, true, false, tested)));
+    EXPECT_EQ(tested, std::vector<field>({a, b}));
+
+    tested.clear();
+    EXPECT_TRUE(program.run(truth(true, false, true, tested)));
+    EXPECT_EQ(tested, std::vector<field>({a, b, c}));
+
+    tested.clear();
+    EXPECT_FALSE(program.run(truth(true, false, false, tested)));
+    EXPECT_EQ(tested, std::vector<field>({a, b, c}));
+}
+
+TEST(flat, forward_jumps)
+{
+    filter f(condition(a) == 0);
+    for (int i = 0; i < 5; ++i)
+        f = (f || condition(b) == i) && condition(c) == i;
+
+    const auto program = sifter::flatten(f, field_of());
+    ASSERT_EQ(program.size(), 11u);
+    for (std::size_t i = 0; i < program.size(); ++i)
+    {
+        EXPECT_GT(program.steps()[i].on_true, i);
+        EXPECT_GT(program.steps()[i].on_false, i);
+    }
+}
+
+TEST(flat, one_side)
+{
+    filter f;
+    f |= condition(b) == 0;
+    const auto program = sifter::flatten(f, field_of());
+    ASSERT_EQ(program.size(), 1u);
+
+    std::vector<field> tested;
+    EXPECT_FALSE(program.run(truth(true, false, true, tested)));
+    EXPECT_EQ(tested, std::vector<field>({b}));
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <string>
+#include <utility>
+#include <gtest/gtest.h>
+#include <sifter/filter.hpp>
+#include <sifter/footprint.hpp>
+
+namespace
+{
+    enum field
+    {
+        id,
+        name,
+        age
+    };
+
+    using condition = sifter::condition<field, int, std::string>;
+    using filter = sifter::filter<field, int, std::string>;
+    using basic_condition = filter::condition_type;
+
+    void expect_counters(const filter &f, std::size_t nodes,
+                         std::size_t conditions, std::size_t depth)
+    {
+        EXPECT_EQ(f.nodes(), nodes);
+        EXPECT_EQ(f.conditions(), conditions);
+        EXPECT_EQ(f.depth(), depth);
+    }
+}
+
+TEST(footprint, counters)
+{
+    expect_counters(filter(), 1, 0, 0);
+    expect_counters(filter(condition(id) == 1), 1, 1, 1);
+    expect_counters(condition(id) == 1 && condition(age) > 5, 1, 2, 1);
+    expect_counters(condition(id) == 1 &&
+                    (condition(name) == "x" || condition(age) > 5), 2, 3, 2);
+
+    filter f(condition(id) == 1);
+    for (int i = 0; i < 10; ++i)
+        f &= condition(age) > i;
+    expect_counters(f, 10, 11, 10);
+
+    f |= condition(name) == "x" && condition(id) < 3;
+    expect_counters(f, 12, 13, 11);
+
+    expect_counters(~f, 12, 13, 11);
+}
+
+TEST(footprint, assignment)
+{
+    filter f = condition(id) == 1 && condition(age) > 5;
+    filter g(f);
+    expect_counters(g, 1, 2, 1);
+
+    filter m(std::move(g));
+    expect_counters(m, 1, 2, 1);
+    expect_counters(g, 1, 0, 0);
+
+    g = f || condition(name) == "x";
+    expect_counters(g, 2, 3, 2);
+
+    m = std::move(g);
+    expect_counters(m, 2, 3, 2);
+    expect_counters(g, 1, 0, 0);
+
+    m = condition(id) == 2;
+    expect_counters(m, 1, 1, 1);
+
+    f &= filter();
+    expect_counters(f, 1, 2, 1);
+}
+
+TEST(footprint, nested)
+{
+    filter f = (condition(id) == 1 || condition(id) == 2) &&
+               condition(age) > 5;
+    expect_counters(f, 2, 3, 2);
+
+    f.left_filter() &= condition(name) == "x";
+    expect_counters(f, 3, 4, 3);
+    f.left_filter() &= condition(name) == "y";
+    expect_counters(f, 4, 5, 4);
+
+    filter &nested = f.left_filter();
+    nested |= condition(id) == 3;
+    expect_counters(f, 5, 6, 5);
+    nested.left_filter().left_filter() &= condition(age) < 9;
+    expect_counters(f, 6, 7, 6);
+
+    const filter g = f;
+    EXPECT_EQ(g, f);
+    expect_counters(g, 6, 7, 6);
+
+    f &= condition(id) != 4;
+    expect_counters(f, 7, 8, 7);
+
+    filter h;
+    h = g;
+    expect_counters(h, 6, 7, 6);
+
+    filter m(std::move(f));
+    expect_counters(m, 7, 8, 7);
+    expect_counters(f, 1, 0, 0);
+}
+
+TEST(footprint, bytes)
+{
+    const basic_condition c = condition(id) == 1;
+    EXPECT_EQ(sifter::footprint(c), sizeof(basic_condition));
+
+    const std::string text(1000, 'x');
+    const basic_condition s = condition(name) == text;
+    EXPECT_GE(sifter::footprint(s), sizeof(basic_condition) + 1000);
+
+    const filter empty;
+    EXPECT_EQ(sifter::footprint(empty), sizeof(filter));
+
+    filter f = condition(id) == 1 && condition(name) == text;
+    EXPECT_EQ(sifter::footprint(f), sizeof(filter) + sifter::footprint(c) +
+                                    sifter::footprint(s));
+
+    const filter g = f || condition(id) == 1;
+    EXPECT_EQ(sifter::footprint(g), 2 * sizeof(filter) +
+                                    2 * sifter::footprint(c) +
+                                    sifter::footprint(s));
+}
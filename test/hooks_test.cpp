@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <string>
+#include <utility>
+#include <gtest/gtest.h>
+#include <sifter/filter.hpp>
+
+namespace
+{
+    enum field
+    {
+        id,
+        name,
+        age
+    };
+
+    using condition = sifter::condition<field, int, std::string>;
+    using filter = sifter::filter<field, int, std::string>;
+    using traced_filter = filter;
+
+    struct counters
+    {
+        int allocations = 0;
+        int deallocations = 0;
+        std::size_t bytes = 0;
+        int condition_copies = 0;
+        int filter_copies = 0;
+        int compositions = 0;
+        int comparisons = 0;
+    };
+
+    counters count;
+
+    struct counting_hooks : sifter::null_hooks
+    {
+        template <typename T>
+        static void on_allocate(const T &, std::size_t size)
+        {
+            ++count.allocations;
+            count.bytes += size;
+        }
+
+        template <typename T>
+        static void on_deallocate(const T &, std::size_t size)
+        {
+            ++count.deallocations;
+            count.bytes -= size;
+        }
+
+        static void on_copy(const filter::condition_type &)
+        {
+            ++count.condition_copies;
+        }
+
+        static void on_copy(const filter &)
+        {
+            ++count.filter_copies;
+        }
+
+        static void on_compose(const filter &)
+        {
+            ++count.compositions;
+        }
+
+        template <typename T>
+        static void on_compare(const T &, const T &)
+        {
+            ++count.comparisons;
+        }
+    };
+}
+
+namespace sifter
+{
+    template <>
+    struct filter_hooks<traced_filter> : counting_hooks
+    {
+    };
+}
+
+TEST(hooks, allocation)
+{
+    count = counters();
+    {
+        const filter f = condition(id) < 10 &&
+                         (condition(name) == "x" || condition(age) > 5);
+        EXPECT_GT(count.allocations, 0);
+        EXPECT_EQ(count.compositions, 2);
+        EXPECT_GT(count.bytes, 0u);
+    }
+    EXPECT_EQ(count.allocations, count.deallocations);
+    EXPECT_EQ(count.bytes, 0u);
+}
+
+TEST(hooks, negation)
+{
+    const filter f = condition(id) < 10 &&
+                     (condition(name) == "x" || condition(age) > 5);
+
+    count = counters();
+    {
+        const filter n = ~f;
+        EXPECT_EQ(count.compositions, 2);
+        EXPECT_EQ(count.allocations, 4);
+    }
+    EXPECT_EQ(count.allocations, count.deallocations);
+}
+
+TEST(hooks, copy)
+{
+    const filter f = condition(id) < 10 && condition(age) > 5;
+
+    count = counters();
+    filter c(f);
+    EXPECT_EQ(count.filter_copies, 1);
+    EXPECT_EQ(count.condition_copies, 2);
+    EXPECT_EQ(count.allocations, 2);
+
+    count = counters();
+    const filter m(std::move(c));
+    EXPECT_EQ(count.filter_copies, 0);
+    EXPECT_EQ(count.allocations, 0);
+
+    const condition a = condition(id) == 1;
+    count = counters();
+    condition b(a);
+    b = a;
+    EXPECT_EQ(count.condition_copies, 2);
+}
+
+TEST(hooks, compare)
+{
+    const filter f1 = condition(id) < 10 && condition(age) > 5;
+    const filter f2 = condition(id) < 10 && condition(age) > 6;
+
+    count = counters();
+    EXPECT_FALSE(f1 == f2);
+    EXPECT_EQ(count.comparisons, 3);
+
+    count = counters();
+    EXPECT_TRUE((condition(id) == 1) != (condition(id) == 2));
+    EXPECT_EQ(count.comparisons, 1);
+}
+
+TEST(hooks, null_hooks)
+{
+    using other = sifter::filter<int, std::string>;
+    EXPECT_TRUE((std::is_base_of<sifter::null_hooks,
+            sifter::filter_hooks<other>>::value));
+}
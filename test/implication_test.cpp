@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <sifter/implication.hpp>
+
+namespace
+{
+    enum field
+    {
+        id,
+        name,
+        age
+    };
+
+    using condition = sifter::condition<field, int, std::string>;
+    using filter = sifter::filter<field, int, std::string>;
+
+    bool implies(const filter &premise, const filter &conclusion)
+    {
+        return sifter::implies<field>(premise, conclusion);
+    }
+}
+
+TEST(implication, conditions)
+{
+    EXPECT_TRUE(implies(filter(condition(age) > 20),
+                        filter(condition(age) > 10)));
+    EXPECT_TRUE(implies(filter(condition(age) > 10),
+                        filter(condition(age) >= 10)));
+    EXPECT_TRUE(implies(filter(condition(age) >= 11),
+                        filter(condition(age) > 10)));
+    EXPECT_FALSE(implies(filter(condition(age) >= 10),
+                         filter(condition(age) > 10)));
+    EXPECT_FALSE(implies(filter(condition(age) > 10),
+                         filter(condition(age) > 20)));
+    EXPECT_TRUE(implies(filter(condition(age) < 5),
+                        filter(condition(age) <= 5)));
+    EXPECT_TRUE(implies(filter(condition(age) <= 5),
+                        filter(condition(age) < 6)));
+    EXPECT_FALSE(implies(filter(condition(age) <= 5),
+                         filter(condition(age) < 5)));
+    EXPECT_TRUE(implies(filter(condition(age) < 5),
+                        filter(condition(age) != 5)));
+    EXPECT_FALSE(implies(filter(condition(age) <= 5),
+                         filter(condition(age) != 5)));
+    EXPECT_TRUE(implies(filter(condition(age) > 5),
+                        filter(condition(age) != 3)));
+    EXPECT_FALSE(implies(filter(condition(age) > 5),
+                         filter(condition(age) < 10)));
+
+    EXPECT_TRUE(implies(filter(condition(age) == 7),
+                        filter(condition(age) < 10)));
+    EXPECT_TRUE(implies(filter(condition(age) == 7),
+                        filter(condition(age) != 8)));
+    EXPECT_FALSE(implies(filter(condition(age) == 7),
+                         filter(condition(age) > 7)));
+    EXPECT_TRUE(implies(filter(condition(name) == "John"),
+                        filter(condition(name) % "J%")));
+    EXPECT_FALSE(implies(filter(condition(name) % "J%"),
+                         filter(condition(name) == "John")));
+    EXPECT_TRUE(implies(filter(condition(name) % "J%"),
+                        filter(condition(name) % "J%")));
+    EXPECT_TRUE(implies(filter(condition(name) != "x"),
+                        filter(condition(name) != "x")));
+    EXPECT_FALSE(implies(filter(condition(name) != "x"),
+                         filter(condition(name) != "y")));
+
+    EXPECT_TRUE(implies(filter(condition(10) < age),
+                        filter(condition(age) > 5)));
+    EXPECT_TRUE(implies(filter(condition(age) > 5),
+                        filter(condition(1) < age)));
+    EXPECT_FALSE(implies(filter(condition(age) > 5),
+                         filter(condition(id) > 5)));
+    EXPECT_TRUE(implies(filter(condition(age) < id),
+                        filter(condition(age) < id)));
+    EXPECT_FALSE(implies(filter(condition(age) < id),
+                         filter(condition(age) <= id)));
+}
+
+TEST(implication, types)
+{
+    EXPECT_TRUE(implies(filter(condition(age) > 5),
+                        filter(condition(age) != "x")));
+    EXPECT_FALSE(implies(filter(condition(age) > 5),
+                         filter(condition(age) < "x")));
+    EXPECT_FALSE(implies(filter(condition(age) != 5),
+                         filter(condition(age) != "x")));
+}
+
+TEST(implication, constants)
+{
+    EXPECT_TRUE(implies(filter(condition(age) > 5), filter()));
+    EXPECT_FALSE(implies(filter(), filter(condition(age) > 5)));
+    EXPECT_TRUE(implies(filter(), filter(condition(1) < 2)));
+    EXPECT_TRUE(implies(filter(condition(2) < 1), filter(condition(age) > 5)));
+    EXPECT_TRUE(implies(filter(), filter()));
+}
+
+TEST(implication, structure)
+{
+    const filter cached(condition(age) > 10);
+    EXPECT_TRUE(implies(condition(age) > 20 && condition(name) == "x", cached));
+    EXPECT_TRUE(implies(condition(name) == "x" && condition(age) > 20, cached));
+    EXPECT_FALSE(implies(cached,
+                         condition(age) > 20 && condition(name) == "x"));
+
+    EXPECT_TRUE(implies(condition(age) > 20 || condition(age) == 15, cached));
+    EXPECT_FALSE(implies(condition(age) > 20 || condition(age) == 5, cached));
+
+    EXPECT_TRUE(implies(condition(age) > 20 && condition(id) < 5,
+                        condition(id) < 10 && condition(age) > 0));
+    EXPECT_TRUE(implies(filter(condition(age) > 20),
+                        condition(name) == "x" || condition(age) > 10));
+    EXPECT_TRUE(implies((condition(age) > 20 || condition(id) == 1) &&
+                        condition(name) == "x",
+                        condition(name) % "%" && (condition(age) > 10 ||
+                                                  condition(id) < 3)));
+}
+
+TEST(implication, equivalent)
+{
+    const filter f = condition(age) > 10 && condition(name) == "x";
+    EXPECT_TRUE(sifter::equivalent<field>(f, f));
+    EXPECT_TRUE(sifter::equivalent<field>(
+            f, condition(name) == "x" && condition(10) < age));
+    EXPECT_TRUE(sifter::equivalent<field>(
+            filter(condition(age) > 10),
+            condition(age) > 10 || condition(age) > 20));
+    EXPECT_FALSE(sifter::equivalent<field>(f, filter(condition(age) > 10)));
+}
+
+TEST(implication, budget)
+{
+    filter premise(condition(age) == 0);
+    filter conclusion(condition(age) < 100);
+    for (int i = 1; i < 32; ++i)
+    {
+        premise |= condition(age) == i;
+        conclusion |= condition(id) == i;
+    }
+
+    EXPECT_TRUE(sifter::implies<field>(premise, conclusion));
+    EXPECT_FALSE(sifter::implies<field>(premise, conclusion, 10));
+}
+
+TEST(implication, soundness)
+{
+    std::mt19937 random(7);
+    const auto make_condition = [&random]()
+    {
+        const field f = random() % 2 ? id : age;
+        const int value = static_cast<int>(random() % 6);
+        switch (random() % 6)
+        {
+            case 0:
+                return condition(f) == value;
+            case 1:
+                return condition(f) != value;
+            case 2:
+                return condition(f) < value;
+            case 3:
+                return condition(f) <= value;
+            case 4:
+                return condition(f) > value;
+            default:
+                return condition(f) >= value;
+        }
+    };
+    const auto make_filter = [&]()
+    {
+        filter f(make_condition());
+        const int size = static_cast<int>(random() % 4);
+        for (int i = 0; i < size; ++i)
+        {
+            if (random() % 2)
+                f &= make_condition();
+            else
+                f |= make_condition();
+        }
+        return f;
+    };
+
+    struct accessor
+    {
+        condition::value_type operator()(const std::vector<int> &r,
+                                         field f) const
+        {
+            return r[f];
+        }
+    };
+
+    int proven = 0;
+    for (int i = 0; i < 3000; ++i)
+    {
+        const filter premise = make_filter();
+        const filter conclusion = make_filter();
+        if (!implies(premise, conclusion))
+            continue;
+
+        ++proven;
+        for (int x = -1; x < 7; ++x)
+        {
+            for (int y = -1; y < 7; ++y)
+            {
+                const std::vector<int> r = {y, 0, x};
+                if (sifter::evaluate<field>(premise, r, accessor()))
+                {
+                    ASSERT_TRUE(sifter::evaluate<field>(conclusion, r,
+                                                        accessor()));
+                }
+            }
+        }
+    }
+    EXPECT_GT(proven, 0);
+}
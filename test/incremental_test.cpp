@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include <sifter/incremental.hpp>
+
+namespace
+{
+    enum field
+    {
+        a,
+        b,
+        c
+    };
+
+    struct record
+    {
+        int values[3];
+    };
+
+    using condition = sifter::condition<field, int>;
+    using filter = sifter::filter<field, int>;
+
+    struct counting_accessor
+    {
+        explicit counting_accessor(std::vector<field> *reads = nullptr)
+            : m_reads(reads)
+        {
+        }
+
+        condition::value_type operator()(const record &r, field f) const
+        {
+            if (m_reads)
+                m_reads->push_back(f);
+            return r.values[f];
+        }
+
+    private:
+        std::vector<field> *m_reads;
+    };
+
+    using matcher = sifter::incremental_matcher<field, filter,
+            counting_accessor>;
+}
+
+TEST(incremental, events)
+{
+    matcher m(condition(a) > 0 && (condition(b) == 1 || condition(c) == 1));
+    EXPECT_EQ(m.nodes(), 5u);
+
+    record r = {{1, 0, 0}};
+    EXPECT_EQ(m.insert(0, r), sifter::match_event::none);
+    EXPECT_TRUE(m.contains(0));
+    EXPECT_FALSE(m.matches(0));
+
+    r.values[c] = 1;
+    EXPECT_EQ(m.update(0, r, c), sifter::match_event::enter);
+    EXPECT_TRUE(m.matches(0));
+
+    r.values[b] = 1;
+    EXPECT_EQ(m.update(0, r, b), sifter::match_event::none);
+
+    r.values[a] = 0;
+    EXPECT_EQ(m.update(0, r, a), sifter::match_event::leave);
+    EXPECT_FALSE(m.matches(0));
+
+    r.values[a] = 2;
+    EXPECT_EQ(m.update(0, r, a), sifter::match_event::enter);
+    EXPECT_EQ(m.erase(0), sifter::match_event::leave);
+    EXPECT_FALSE(m.contains(0));
+    EXPECT_EQ(m.erase(0), sifter::match_event::none);
+
+    EXPECT_FALSE(m.matches(5));
+    EXPECT_EQ(m.update(5, r, a), sifter::match_event::enter);
+    EXPECT_FALSE(m.contains(4));
+}
+
+TEST(incremental, reads_changed_field_only)
+{
+    std::vector<field> reads;
+    matcher m((condition(a) > 0 && condition(b) == 1) ||
+              condition(c) < a || condition(b) != 5,
+              counting_accessor(&reads));
+
+    record r = {{1, 1, 0}};
+    m.insert(0, r);
+    EXPECT_EQ(reads.size(), 5u);
+
+    reads.clear();
+    r.values[b] = 5;
+    m.update(0, r, b);
+    EXPECT_EQ(reads, std::vector<field>({b, b}));
+
+    reads.clear();
+    r.values[c] = 3;
+    m.update(0, r, c);
+    std::sort(reads.begin(), reads.end());
+    EXPECT_EQ(reads, std::vector<field>({a, c}));
+
+    reads.clear();
+    m.update(1, r, c);
+    EXPECT_EQ(reads.size(), 5u);
+}
+
+TEST(incremental, empty)
+{
+    matcher m((filter()));
+    EXPECT_EQ(m.nodes(), 0u);
+
+    record r = {{0, 0, 0}};
+    EXPECT_EQ(m.insert(3, r), sifter::match_event::enter);
+    EXPECT_EQ(m.update(3, r, a), sifter::match_event::none);
+    EXPECT_TRUE(m.matches(3));
+}
+
+TEST(incremental, equivalence)
+{
+    filter f(condition(a) == 0);
+    for (int i = 0; i < 6; ++i)
+    {
+        f = i % 2 ? (f || condition(b) < i) && condition(c) != i
+                  : (f && condition(a) >= c) || condition(b) == i;
+    }
+
+    std::vector<record> records(20, record{{0, 0, 0}});
+    matcher m(f);
+    for (std::size_t i = 0; i < records.size(); ++i)
+        m.insert(i, records[i]);
+
+    std::mt19937 random(1);
+    for (int step = 0; step < 2000; ++step)
+    {
+        const std::size_t i = random() % records.size();
+        const field changed = static_cast<field>(random() % 3);
+        record &r = records[i];
+        r.values[changed] = static_cast<int>(random() % 8);
+
+        const bool before = m.matches(i);
+        const bool after = sifter::evaluate<field>(f, r, counting_accessor());
+        const sifter::match_event e = m.update(i, r, changed);
+
+        ASSERT_EQ(m.matches(i), after);
+        if (before == after)
+            EXPECT_EQ(e, sifter::match_event::none);
+        else
+            EXPECT_EQ(e, after ? sifter::match_event::enter
+                               : sifter::match_event::leave);
+    }
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <sstream>
+#include <gtest/gtest.h>
+#include "instantiate/types.hpp"
+
+using namespace instantiated;
+
+TEST(instantiate, filter)
+{
+    filter f = condition(id) < 10 && (condition(name) % "J%" ||
+                                      condition(age) == 20);
+    f |= condition(age) > 30;
+
+    const filter c(f);
+    EXPECT_EQ(c, f);
+    EXPECT_EQ(c.conditions(), 4u);
+
+    std::ostringstream out;
+    out << sifter::out<sifter::default_dumper, field, int, std::string>(c);
+    EXPECT_EQ(out.str(), "((0<10&&(1~J%||2==20))||2>30)");
+}
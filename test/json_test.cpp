@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <limits>
+#include <string>
+#include <gtest/gtest.h>
+#include <sifter/json.hpp>
+
+namespace
+{
+    enum field
+    {
+        id,
+        name,
+        age
+    };
+
+    const char *const names[] = {"id", "name", "age"};
+
+    struct field_map
+    {
+        bool operator()(const char *text, std::size_t size, field &out) const
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                if (std::strlen(names[i]) == size &&
+                    std::memcmp(names[i], text, size) == 0)
+                {
+                    out = static_cast<field>(i);
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    struct field_names
+    {
+        const char *operator()(field f) const
+        {
+            return names[f];
+        }
+    };
+
+    using condition = sifter::condition<field, int, double, std::string>;
+    using filter = sifter::filter<field, int, double, std::string>;
+
+    filter decode(const std::string &text)
+    {
+        return sifter::decode_json<field, filter>(text, field_map());
+    }
+
+    std::string encode(const filter &f)
+    {
+        std::string out;
+        sifter::encode_json<field>(out, f, field_names());
+        return out;
+    }
+
+    std::size_t error_offset(const std::string &text)
+    {
+        try
+        {
+            decode(text);
+        }
+        catch (const sifter::json_error &e)
+        {
+            return e.offset();
+        }
+        ADD_FAILURE() << "no error in " << text;
+        return 0;
+    }
+}
+
+TEST(json, decode)
+{
+    EXPECT_EQ(decode("{\"lhs\": {\"field\": \"age\"}, \"op\": \">\", "
+                     "\"rhs\": 20}"),
+              filter(condition(age) > 20));
+    EXPECT_EQ(decode(" {\"rhs\":\"J%\",\"op\":\"~\","
+                     "\"lhs\":{\"field\":\"name\"}} "),
+              filter(condition(name) % "J%"));
+    EXPECT_EQ(decode("{\"lhs\":{\"field\":\"id\"},\"op\":\"!=\",\"rhs\":1.5}"),
+              filter(condition(id) != 1.5));
+
+    filter expected = condition(age) > 20 && condition(age) < 60;
+    expected &= condition(name) == "x";
+    EXPECT_EQ(decode("{\"and\": ["
+                     "{\"lhs\":{\"field\":\"age\"},\"op\":\">\",\"rhs\":20},"
+                     "{\"lhs\":{\"field\":\"age\"},\"op\":\"<\",\"rhs\":60},"
+                     "{\"lhs\":{\"field\":\"name\"},\"op\":\"==\","
+                     "\"rhs\":\"x\"}]}"),
+              expected);
+
+    filter nested(condition(id) == 1);
+    nested |= condition(id) < 2 && condition(age) >= 3;
+    EXPECT_EQ(decode("{\"or\":["
+                     "{\"lhs\":{\"field\":\"id\"},\"op\":\"==\",\"rhs\":1},"
+                     "{\"and\":["
+                     "{\"lhs\":{\"field\":\"id\"},\"op\":\"<\",\"rhs\":2},"
+                     "{\"lhs\":{\"field\":\"age\"},\"op\":\">=\",\"rhs\":3}"
+                     "]}]}"),
+              nested);
+}
+
+TEST(json, empty)
+{
+    EXPECT_FALSE(decode("{}"));
+    EXPECT_FALSE(decode("{\"and\":[]}"));
+    EXPECT_FALSE(decode("{\"or\":[{}, {}]}"));
+    EXPECT_EQ(encode(filter()), "{}");
+
+    const filter single(condition(id) == 1);
+    EXPECT_EQ(decode("{\"and\":[{\"lhs\":{\"field\":\"id\"},\"op\":\"==\","
+                     "\"rhs\":1},{}]}"),
+              single);
+
+    filter right;
+    right &= condition(id) == 1;
+    const filter decoded = decode("{\"and\":[{},{\"lhs\":{\"field\":\"id\"},"
+                                  "\"op\":\"==\",\"rhs\":1}]}");
+    EXPECT_EQ(decoded, right);
+    EXPECT_FALSE(decoded.left_is_condition());
+    EXPECT_FALSE(decoded.left_is_filter());
+}
+
+TEST(json, encode)
+{
+    EXPECT_EQ(encode(filter(condition(age) > 20)),
+              "{\"lhs\":{\"field\":\"age\"},\"op\":\">\",\"rhs\":20}");
+    EXPECT_EQ(encode(filter(condition(name) != "a\"b\\c\n\x01")),
+              "{\"lhs\":{\"field\":\"name\"},\"op\":\"!=\","
+              "\"rhs\":\"a\\\"b\\\\c\\n\\u0001\"}");
+    EXPECT_EQ(encode(filter(condition(id) == 2.0)),
+              "{\"lhs\":{\"field\":\"id\"},\"op\":\"==\",\"rhs\":2.0}");
+
+    filter f = condition(id) == 1 && condition(id) == 2;
+    f &= condition(id) == 3;
+    f |= condition(id) == 4;
+    EXPECT_EQ(encode(f),
+              "{\"or\":[{\"and\":["
+              "{\"lhs\":{\"field\":\"id\"},\"op\":\"==\",\"rhs\":1},"
+              "{\"lhs\":{\"field\":\"id\"},\"op\":\"==\",\"rhs\":2},"
+              "{\"lhs\":{\"field\":\"id\"},\"op\":\"==\",\"rhs\":3}]},"
+              "{\"lhs\":{\"field\":\"id\"},\"op\":\"==\",\"rhs\":4}]}");
+
+    std::string out = "prefix";
+    sifter::encode_json<field>(out, filter(), field_names());
+    EXPECT_EQ(out, "prefix{}");
+}
+
+TEST(json, round_trip)
+{
+    filter f(condition(name) % "J_hn%");
+    f &= condition(age) >= 0.1 || condition(age) < -7;
+    f |= condition(id) != 1e300 && condition(name) == "\t\xc3\xa9";
+    f &= ~(condition(age) > id || condition(1) == 2.5);
+    f |= filter();
+
+    filter g;
+    g |= f;
+    g &= condition(id) == 9;
+
+    const filter samples[] = {filter(), filter(condition(id) == 1), f, g,
+                              filter(condition(0.1 + 0.2) < 3e-9)};
+    for (const filter &sample : samples)
+    {
+        const std::string text = encode(sample);
+        const filter decoded = decode(text);
+        EXPECT_EQ(decoded, sample) << text;
+        EXPECT_EQ(decoded.nodes(), sample.nodes()) << text;
+        EXPECT_EQ(encode(decoded), text);
+    }
+}
+
+TEST(json, escapes)
+{
+    const filter f = decode("{\"lhs\":{\"field\":\"n\\u0061me\"},"
+                            "\"o\\u0070\":\"\\u003d=\",\"rhs\":"
+                            "\"\\\"\\\\\\/\\b\\f\\n\\r\\t\\u00e9\\u20ac"
+                            "\\ud83d\\ude00\"}");
+    EXPECT_EQ(f, filter(condition(name) == "\"\\/\b\f\n\r\t\xc3\xa9\xe2\x82\xac"
+                                           "\xf0\x9f\x98\x80"));
+}
+
+TEST(json, numbers)
+{
+    using narrow = sifter::filter<field, short, std::string>;
+    const std::string small = "{\"lhs\":1,\"op\":\"<\",\"rhs\":-32768}";
+    EXPECT_EQ((sifter::decode_json<field, narrow>(small, field_map())),
+              narrow(sifter::condition<field, short, std::string>(
+                      short(1)) < short(-32768)));
+    EXPECT_THROW((sifter::decode_json<field, narrow>(
+                         "{\"lhs\":1,\"op\":\"<\",\"rhs\":32768}",
+                         field_map())),
+                 sifter::json_error);
+    EXPECT_THROW((sifter::decode_json<field, narrow>(
+                         "{\"lhs\":1,\"op\":\"<\",\"rhs\":1.5}",
+                         field_map())),
+                 sifter::json_error);
+
+    EXPECT_EQ(decode("{\"lhs\":1e2,\"op\":\"<\",\"rhs\":"
+                     "99999999999999999999}"),
+              filter(condition(100.0) < 1e20));
+    EXPECT_EQ(decode("{\"lhs\":-0,\"op\":\"<\",\"rhs\":0.5E-1}"),
+              filter(condition(0) < 0.05));
+}
+
+TEST(json, booleans)
+{
+    using flag_condition = sifter::condition<field, bool, int>;
+    using flag_filter = sifter::filter<field, bool, int>;
+
+    const flag_filter f(flag_condition(true) != age);
+    std::string text;
+    sifter::encode_json<field>(text, f, field_names());
+    EXPECT_EQ(text,
+              "{\"lhs\":true,\"op\":\"!=\",\"rhs\":{\"field\":\"age\"}}");
+    EXPECT_EQ((sifter::decode_json<field, flag_filter>(text, field_map())), f);
+    EXPECT_EQ((sifter::decode_json<field, flag_filter>(
+                      "{\"lhs\":false,\"op\":\"==\",\"rhs\":7}",
+                      field_map())),
+              flag_filter(flag_condition(false) == 7));
+
+    EXPECT_THROW(decode("{\"lhs\":true,\"op\":\"==\",\"rhs\":1}"),
+                 sifter::json_error);
+}
+
+TEST(json, errors)
+{
+    const std::string c = "{\"lhs\":1,\"op\":\"==\",\"rhs\":1}";
+
+    EXPECT_EQ(error_offset(""), 0u);
+    EXPECT_EQ(error_offset("[]"), 0u);
+    EXPECT_EQ(error_offset(c + " x"), c.size() + 1);
+    EXPECT_EQ(error_offset("{\"lhs\":1,\"op\":\"==\"}"), 19u);
+    EXPECT_EQ(error_offset("{\"lhs\":1,\"lhs\":1}"), 15u);
+    EXPECT_EQ(error_offset("{\"lhs\":1,\"op\":\"=\",\"rhs\":1}"), 17u);
+    EXPECT_EQ(error_offset("{\"lhs\":{\"field\":\"x\"}"), 19u);
+    EXPECT_EQ(error_offset("{\"lhs\":01"), 8u);
+    EXPECT_EQ(error_offset("{\"lhs\":1.}"), 9u);
+    EXPECT_EQ(error_offset("{\"lhs\":tru}"), 7u);
+    EXPECT_EQ(error_offset("{\"lhs\":\"a\\x\"}"), 10u);
+    EXPECT_EQ(error_offset("{\"lhs\":\"\\ud800\"}"), 14u);
+    EXPECT_EQ(error_offset("{\"lhs\":\"a\nb\"}"), 9u);
+    EXPECT_EQ(error_offset("{\"lhs\":\"abc"), 11u);
+    EXPECT_EQ(error_offset("{\"and\":[" + c + "," + c + "]"),
+              2 * c.size() + 10);
+    EXPECT_EQ(error_offset("{\"xor\":[]}"), 7u);
+
+    std::string deep;
+    for (int i = 0; i < 200; ++i)
+        deep += "{\"and\":[";
+    EXPECT_EQ(error_offset(deep), 129 * 8u);
+
+    std::string items = "{\"or\":[" + c;
+    for (int i = 1; i < 1025; ++i)
+        items += "," + c;
+    EXPECT_EQ(decode(items + "]}").depth(), 1024u);
+
+    items += "," + c;
+    const std::size_t too_deep = items.size();
+    EXPECT_EQ(error_offset(items + "]}"), too_deep);
+
+    for (int i = 1026; i < 1000000; ++i)
+        items += "," + c;
+    EXPECT_EQ(error_offset(items + "]}"), too_deep);
+
+    try
+    {
+        decode("{\"lhs\":{\"field\":\"x\"}}");
+        FAIL();
+    }
+    catch (const sifter::json_error &e)
+    {
+        EXPECT_STREQ(e.what(), "unknown field at position 19");
+    }
+
+    EXPECT_THROW(encode(filter(condition(id) ==
+                               std::numeric_limits<double>::infinity())),
+                 std::invalid_argument);
+}
+
+#ifndef SIFTER_USE_BOOST_VARIANT
+#include <memory_resource>
+
+namespace
+{
+    class counting_resource : public std::pmr::memory_resource
+    {
+    public:
+        std::size_t allocations = 0;
+
+    private:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *p, std::size_t bytes,
+                           std::size_t alignment) override
+        {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const memory_resource &r) const noexcept override
+        {
+            return this == &r;
+        }
+    };
+
+    using pmr_filter = sifter::filter<field, int, std::pmr::string>;
+}
+
+TEST(json, allocator)
+{
+    const std::string text =
+            "{\"or\":[{\"and\":["
+            "{\"lhs\":{\"field\":\"name\"},\"op\":\"~\",\"rhs\":"
+            "\"a pattern, which does not fit into small string buffer%\"},"
+            "{\"lhs\":{\"field\":\"name\"},\"op\":\"!=\",\"rhs\":"
+            "\"escaped \\u00e9 string, which does not fit into buffer\"},"
+            "{\"lhs\":{\"field\":\"age\"},\"op\":\">\",\"rhs\":20}]},"
+            "{\"lhs\":{\"field\":\"id\"},\"op\":\"==\",\"rhs\":\"short\"}]}";
+
+    counting_resource decoded;
+    const pmr_filter f = sifter::decode_json<field, pmr_filter>(
+            text, field_map(), sifter::allocator_type(&decoded));
+
+    counting_resource copied;
+    const pmr_filter copy(f, sifter::allocator_type(&copied));
+
+    EXPECT_EQ(f, copy);
+    EXPECT_EQ(decoded.allocations, copied.allocations);
+}
+#endif
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <random>
+#include <sstream>
+#include <vector>
+#include <gtest/gtest.h>
+#include <sifter/evaluate.hpp>
+#include <sifter/normal_form.hpp>
+#include <sifter/ostream.hpp>
+
+namespace
+{
+    enum field
+    {
+        a,
+        b,
+        c
+    };
+
+    using condition = sifter::condition<field, int>;
+    using filter = sifter::filter<field, int>;
+
+    std::string text(const filter &f)
+    {
+        std::stringstream out;
+        out << sifter::out<sifter::default_dumper, field, int>(f);
+        return out.str();
+    }
+
+    struct accessor
+    {
+        condition::value_type operator()(const std::vector<int> &r,
+                                         field f) const
+        {
+            return r[f];
+        }
+    };
+}
+
+TEST(normal_form, dnf)
+{
+    const filter f = condition(a) == 1 &&
+                     (condition(b) == 2 || condition(c) == 3);
+    const auto dnf = sifter::to_dnf(f);
+
+    EXPECT_EQ(dnf.type, sifter::normal_form_type::dnf);
+    EXPECT_TRUE(dnf.complete());
+    ASSERT_EQ(dnf.conditions.size(), 3u);
+    EXPECT_EQ(dnf.terms, std::vector<std::vector<std::size_t>>(
+            {{0, 1}, {0, 2}}));
+    EXPECT_EQ(text(dnf.to_filter()), "((0==1&&1==2)||(0==1&&2==3))");
+}
+
+TEST(normal_form, cnf)
+{
+    const filter f = condition(a) == 1 ||
+                     (condition(b) == 2 && condition(c) == 3);
+    const auto cnf = sifter::to_cnf(f);
+
+    EXPECT_EQ(cnf.type, sifter::normal_form_type::cnf);
+    EXPECT_TRUE(cnf.complete());
+    EXPECT_EQ(cnf.terms, std::vector<std::vector<std::size_t>>(
+            {{0, 1}, {0, 2}}));
+    EXPECT_EQ(text(cnf.to_filter()), "((0==1||1==2)&&(0==1||2==3))");
+}
+
+TEST(normal_form, duplicates)
+{
+    const filter f = (condition(a) == 1 || condition(b) == 2) &&
+                     (condition(b) == 2 || condition(a) == 1);
+    const auto dnf = sifter::to_dnf(f);
+    EXPECT_EQ(dnf.conditions.size(), 2u);
+    EXPECT_EQ(dnf.terms, std::vector<std::vector<std::size_t>>(
+            {{0}, {0, 1}, {1}}));
+
+    const auto cnf = sifter::to_cnf(f);
+    EXPECT_EQ(cnf.terms, std::vector<std::vector<std::size_t>>({{0, 1}}));
+}
+
+TEST(normal_form, empty)
+{
+    const auto dnf = sifter::to_dnf(filter());
+    EXPECT_EQ(dnf.terms, std::vector<std::vector<std::size_t>>(1));
+    EXPECT_FALSE(dnf.to_filter());
+
+    const auto cnf = sifter::to_cnf(filter());
+    EXPECT_TRUE(cnf.terms.empty());
+    EXPECT_FALSE(cnf.to_filter());
+}
+
+TEST(normal_form, limit)
+{
+    filter f(condition(a) == 0 || condition(b) == 0);
+    for (int i = 1; i < 10; ++i)
+        f &= condition(a) == i || condition(b) == i;
+
+    const auto dnf = sifter::to_dnf(f, 256);
+    EXPECT_FALSE(dnf.complete());
+    EXPECT_EQ(dnf.terms.size(), 256u);
+    EXPECT_EQ(dnf.conditions.size(), 16u);
+    EXPECT_EQ(text(dnf.residual),
+              "((0==8||1==8)&&(0==9||1==9))");
+
+    const auto cnf = sifter::to_cnf(f, 256);
+    EXPECT_TRUE(cnf.complete());
+    EXPECT_EQ(cnf.terms.size(), 10u);
+
+    const auto single = sifter::to_dnf(filter(condition(a) == 0) ||
+                                       f, 8);
+    EXPECT_EQ(single.terms, std::vector<std::vector<std::size_t>>(1));
+    EXPECT_EQ(single.residual, filter(condition(a) == 0) || f);
+}
+
+TEST(normal_form, equivalence)
+{
+    std::mt19937 random(3);
+    const auto make_condition = [&random]()
+    {
+        const field f = static_cast<field>(random() % 3);
+        const int value = static_cast<int>(random() % 3);
+        return random() % 2 ? condition(f) == value : condition(f) < value;
+    };
+
+    for (int i = 0; i < 500; ++i)
+    {
+        filter f(make_condition());
+        const int size = static_cast<int>(random() % 10);
+        for (int j = 0; j < size; ++j)
+        {
+            filter g(make_condition());
+            if (random() % 2)
+                g = random() % 2 ? g && f : f && g;
+            else
+                g = random() % 2 ? g || f : f || g;
+            f = g;
+        }
+
+        const std::size_t limit = random() % 16 + 1;
+        const filter dnf = sifter::to_dnf(f, limit).to_filter();
+        const filter cnf = sifter::to_cnf(f, limit).to_filter();
+
+        std::vector<int> r(3);
+        for (r[a] = 0; r[a] < 3; ++r[a])
+        {
+            for (r[b] = 0; r[b] < 3; ++r[b])
+            {
+                for (r[c] = 0; r[c] < 3; ++r[c])
+                {
+                    const bool expected = sifter::evaluate<field>(f, r,
+                                                                  accessor());
+                    ASSERT_EQ(sifter::evaluate<field>(dnf, r, accessor()),
+                              expected) << text(f);
+                    ASSERT_EQ(sifter::evaluate<field>(cnf, r, accessor()),
+                              expected) << text(f);
+                }
+            }
+        }
+    }
+}
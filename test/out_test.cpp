@@ -51,4 +51,11 @@ TEST(out, default_dumper)
     std::stringstream b2;
     b2 << out(f2);
     EXPECT_EQ(b2.str(), "(a==10||(b!=20&&c>=7))");
-}
\ No newline at end of file
+
+
+    const filter f3 = ~(condition("a") < 10 && condition("name") % "J%");
+
+    std::stringstream b3;
+    b3 << out(f3);
+    EXPECT_EQ(b3.str(), "(a>=10||name!~J%)");
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <sstream>
+#include <gtest/gtest.h>
+#include <sifter/partial.hpp>
+#include <sifter/ostream.hpp>
+
+namespace
+{
+    enum field
+    {
+        tenant,
+        shard,
+        name,
+        age
+    };
+
+    using condition = sifter::condition<field, int, std::string>;
+    using filter = sifter::filter<field, int, std::string>;
+    using bindings = std::map<field, condition::value_type>;
+    using out = sifter::out<sifter::default_dumper, field, int, std::string>;
+
+    std::string str(const filter &f)
+    {
+        std::stringstream s;
+        s << out(f);
+        return s.str();
+    }
+}
+
+TEST(partial, constant)
+{
+    const bindings b = {{tenant, 7}, {shard, 2}};
+
+    filter f0 = condition(tenant) == 7 && condition(shard) < 3;
+    EXPECT_EQ(sifter::partially_evaluate(f0, b).value, sifter::outcome::_true);
+
+    filter f1 = condition(tenant) == 8 && condition(age) > 20;
+    const auto r1 = sifter::partially_evaluate(f1, b);
+    EXPECT_EQ(r1.value, sifter::outcome::_false);
+    EXPECT_FALSE(r1.residual);
+
+    filter f2 = condition(tenant) == 7 || condition(age) > 20;
+    EXPECT_EQ(sifter::partially_evaluate(f2, b).value, sifter::outcome::_true);
+
+    EXPECT_EQ(sifter::partially_evaluate(filter(), b).value,
+              sifter::outcome::_true);
+    EXPECT_EQ(sifter::partially_evaluate(condition(shard) != 2, b).value,
+              sifter::outcome::_false);
+}
+
+TEST(partial, residual)
+{
+    const bindings b = {{tenant, 7}, {shard, 2}};
+
+    filter f0 = condition(tenant) == 7 && condition(age) > 20;
+    const auto r0 = sifter::partially_evaluate(f0, b);
+    EXPECT_EQ(r0.value, sifter::outcome::_residual);
+    EXPECT_EQ(r0.residual, filter(condition(age) > 20));
+
+    filter f1 = (condition(tenant) == 8 || condition(name) == "x") &&
+                (condition(shard) == 2 || condition(age) > 20) &&
+                condition(age) < 60;
+    const auto r1 = sifter::partially_evaluate(f1, b);
+    EXPECT_EQ(r1.value, sifter::outcome::_residual);
+    EXPECT_EQ(str(r1.residual), "(2==x&&3<60)");
+
+    filter f2 = condition(age) > 20 || condition(tenant) == 1;
+    EXPECT_EQ(sifter::partially_evaluate(f2, b).residual,
+              filter(condition(age) > 20));
+
+    const auto r3 = sifter::partially_evaluate(
+            condition(age, shard, sifter::gt), b);
+    EXPECT_EQ(r3.value, sifter::outcome::_residual);
+    EXPECT_EQ(r3.residual, filter(condition(age) > 2));
+}
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <sifter/profile.hpp>
+
+namespace
+{
+    enum field
+    {
+        id,
+        name,
+        age
+    };
+
+    struct person
+    {
+        int id;
+        std::string name;
+        int age;
+    };
+
+    using condition = sifter::condition<field, int, std::string>;
+    using filter = sifter::filter<field, int, std::string>;
+
+    struct person_accessor
+    {
+        condition::value_type operator()(const person &p, field f) const
+        {
+            switch (f)
+            {
+                case id:
+                    return p.id;
+                case name:
+                    return p.name;
+                case age:
+                    return p.age;
+            }
+            return condition::value_type();
+        }
+    };
+
+    const std::vector<person> people = {
+            {1, "John", 25},
+            {2, "Jane", 17},
+            {3, "Bob", 40},
+            {4, "Bill", 30}
+    };
+
+    const filter f = condition(age) > 18 &&
+                     (condition(name) % "J%" || condition(id) == 3);
+
+    std::string strip_time(const std::string &text)
+    {
+        return std::regex_replace(
+                std::regex_replace(text, std::regex(" time=[0-9]+ns"), ""),
+                std::regex("\"nanoseconds\":[0-9]+"), "\"nanoseconds\":0");
+    }
+}
+
+TEST(profile, counters)
+{
+    sifter::evaluation_profile profile(f, 1);
+    ASSERT_EQ(profile.nodes(), 5u);
+    EXPECT_EQ(profile.subtree_size(0), 5u);
+    EXPECT_EQ(profile.subtree_size(2), 3u);
+
+    for (const person &p : people)
+        EXPECT_EQ(sifter::evaluate<field>(f, p, person_accessor(), profile),
+                  sifter::evaluate<field>(f, p, person_accessor()));
+
+    EXPECT_EQ(profile.samples(), 4u);
+
+    const std::vector<std::pair<std::uint64_t, std::uint64_t>> expected = {
+            {4, 2}, {4, 3}, {3, 2}, {3, 1}, {2, 1}
+    };
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+        const sifter::node_stats s = profile.stats(i);
+        EXPECT_EQ(s.visits, expected[i].first) << i;
+        EXPECT_EQ(s.passes, expected[i].second) << i;
+    }
+
+    profile.reset();
+    EXPECT_EQ(profile.samples(), 0u);
+    EXPECT_EQ(profile.stats(0).visits, 0u);
+}
+
+TEST(profile, sampling)
+{
+    sifter::evaluation_profile second(f, 2);
+    sifter::evaluation_profile third(f, 3);
+    sifter::evaluation_profile every(f, 0);
+    EXPECT_EQ(every.sample_period(), 1u);
+    for (const person &p : people)
+    {
+        EXPECT_EQ(sifter::evaluate<field>(f, p, person_accessor(), second),
+                  sifter::evaluate<field>(f, p, person_accessor()));
+        sifter::evaluate<field>(f, p, person_accessor(), third);
+        sifter::evaluate<field>(f, p, person_accessor(), every);
+    }
+
+    EXPECT_EQ(second.samples(), 2u);
+    EXPECT_EQ(second.stats(0).visits, 2u);
+    EXPECT_EQ(second.stats(0).passes, 2u);
+    EXPECT_EQ(second.stats(4).visits, 1u);
+    EXPECT_EQ(third.samples(), 2u);
+    EXPECT_EQ(every.samples(), 4u);
+}
+
+TEST(profile, empty)
+{
+    const filter empty;
+    sifter::evaluation_profile profile(empty, 1);
+    EXPECT_EQ(profile.nodes(), 1u);
+    EXPECT_TRUE(sifter::evaluate<field>(empty, people[0], person_accessor(),
+                                        profile));
+    EXPECT_EQ(profile.stats(0).passes, 1u);
+}
+
+TEST(profile, threads)
+{
+    sifter::evaluation_profile profile(f, 1, 4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&profile]()
+        {
+            for (int i = 0; i < 1000; ++i)
+                for (const person &p : people)
+                    sifter::evaluate<field>(f, p, person_accessor(), profile);
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    EXPECT_EQ(profile.samples(), 32000u);
+    EXPECT_EQ(profile.stats(0).visits, 32000u);
+    EXPECT_EQ(profile.stats(0).passes, 16000u);
+    EXPECT_EQ(profile.stats(4).visits, 16000u);
+}
+
+TEST(profile, explain)
+{
+    sifter::evaluation_profile profile(f, 1);
+    for (const person &p : people)
+        sifter::evaluate<field>(f, p, person_accessor(), profile);
+
+    std::ostringstream text;
+    sifter::explain(text, f, profile);
+    EXPECT_EQ(strip_time(text.str()),
+              "samples=4 sample_period=1\n"
+              "&& visits=4 passes=2\n"
+              "    2>18 visits=4 passes=3\n"
+              "    || visits=3 passes=2\n"
+              "        1~J% visits=3 passes=1\n"
+              "        0==3 visits=2 passes=1\n");
+
+    std::ostringstream json;
+    sifter::explain_json(json, f, profile);
+    EXPECT_EQ(strip_time(json.str()),
+              "{\"samples\":4,\"sample_period\":1,\"tree\":"
+              "{\"node\":\"&&\",\"visits\":4,\"passes\":2,"
+              "\"nanoseconds\":0,\"children\":["
+              "{\"condition\":\"2>18\",\"visits\":4,\"passes\":3,"
+              "\"nanoseconds\":0},"
+              "{\"node\":\"||\",\"visits\":3,\"passes\":2,"
+              "\"nanoseconds\":0,\"children\":["
+              "{\"condition\":\"1~J%\",\"visits\":3,\"passes\":1,"
+              "\"nanoseconds\":0},"
+              "{\"condition\":\"0==3\",\"visits\":2,\"passes\":1,"
+              "\"nanoseconds\":0}]}]}}");
+}
+
+TEST(profile, null_profile)
+{
+    sifter::null_profile profile(f);
+    EXPECT_TRUE(sifter::evaluate<field>(f, people[0], person_accessor(),
+                                        profile));
+    EXPECT_FALSE(sifter::evaluate<field>(f, people[1], person_accessor(),
+                                         profile));
+
+    std::ostringstream text;
+    sifter::explain(text, f, profile);
+    EXPECT_TRUE(text.str().empty());
+}
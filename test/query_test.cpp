@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <string>
+#include <gtest/gtest.h>
+#include <sifter/query.hpp>
+
+namespace
+{
+    enum field
+    {
+        id,
+        name,
+        age
+    };
+
+    struct field_map
+    {
+        bool operator()(sifter::string_view text, field &out) const
+        {
+            if (text == "id")
+                out = id;
+            else if (text == "name")
+                out = name;
+            else if (text == "age")
+                out = age;
+            else
+                return false;
+            return true;
+        }
+    };
+
+    using condition = sifter::condition<field, int, double, std::string>;
+    using filter = sifter::filter<field, int, double, std::string>;
+
+    /*
+     * Names are strings, ids and ages are integers.
+     */
+    struct value_map
+    {
+        bool operator()(field f, sifter::string_view text,
+                        condition::value_type &out) const
+        {
+            if (f == name)
+            {
+                out = std::string(text.data(), text.size());
+                return true;
+            }
+            return sifter::query_values<filter>()(f, text, out) &&
+                   sifter::holds_alternative<int>(out);
+        }
+    };
+
+    filter decode(const std::string &query)
+    {
+        return sifter::decode_query<field, filter>(query, field_map(),
+                                                   value_map());
+    }
+
+    std::size_t error_offset(const std::string &query)
+    {
+        try
+        {
+            decode(query);
+        }
+        catch (const sifter::query_error &e)
+        {
+            return e.offset();
+        }
+        ADD_FAILURE() << "no error in " << query;
+        return 0;
+    }
+}
+
+TEST(query, conditions)
+{
+    EXPECT_FALSE(decode(""));
+    EXPECT_FALSE(decode("?"));
+    EXPECT_FALSE(decode("&&"));
+    EXPECT_EQ(decode("age=20"), filter(condition(age) == 20));
+    EXPECT_EQ(decode("?age=gt:20"), filter(condition(age) > 20));
+    EXPECT_EQ(decode("id=ne:-3"), filter(condition(id) != -3));
+    EXPECT_EQ(decode("name=like:J%25"), filter(condition(name) % "J%"));
+    EXPECT_EQ(decode("name=nlike:J%25"),
+              filter(condition(name) % "J%").operator~());
+    EXPECT_EQ(decode("name=10:30"), filter(condition(name) == "10:30"));
+    EXPECT_EQ(decode("name=eq:lt:x"), filter(condition(name) == "lt:x"));
+    EXPECT_EQ(decode("name="), filter(condition(name) == ""));
+    EXPECT_EQ(decode("n%61me=John+Smith%2C%26%3d"),
+              filter(condition(name) == "John Smith,&="));
+
+    filter expected = condition(age) >= 20 && condition(age) <= 60;
+    expected &= condition(name) == "x";
+    EXPECT_EQ(decode("age=ge:20&age=le:60&&name=x&"), expected);
+}
+
+TEST(query, alternatives)
+{
+    filter any(condition(id) == 1);
+    any |= condition(id) < 0;
+    any |= condition(name) == "a,b";
+
+    filter expected(condition(age) > 20);
+    expected &= any;
+    EXPECT_EQ(decode("age=gt:20&or=id:1,id:lt:0,name:a%2Cb"), expected);
+    EXPECT_EQ(decode("or=id:1,id:lt:0,name:a%2Cb"), any);
+    EXPECT_EQ(decode("or=id:5"), filter(condition(id) == 5));
+    EXPECT_FALSE(decode("or="));
+    EXPECT_EQ(decode("or=&age=1"), filter(condition(age) == 1));
+}
+
+TEST(query, values)
+{
+    const auto decode_default = [](const std::string &query)
+    {
+        return sifter::decode_query<field, filter>(query, field_map());
+    };
+    EXPECT_EQ(decode_default("id=12&name=1.5&age=x"),
+              condition(id) == 12 && condition(name) == 1.5 &&
+              condition(age) == "x");
+    EXPECT_EQ(decode_default("id=99999999999"),
+              filter(condition(id) == 99999999999.0));
+    EXPECT_EQ(decode_default("id=1e3"), filter(condition(id) == 1000.0));
+    EXPECT_EQ(decode_default("id=-"), filter(condition(id) == "-"));
+    EXPECT_EQ(decode_default("id=%201"), filter(condition(id) == " 1"));
+
+    using flag_condition = sifter::condition<field, bool, long long>;
+    using flag_filter = sifter::filter<field, bool, long long>;
+    EXPECT_EQ((sifter::decode_query<field, flag_filter>(
+                      "id=true&age=-9223372036854775808", field_map())),
+              flag_condition(id) == true &&
+              flag_condition(age) == (-9223372036854775807LL - 1));
+    EXPECT_THROW((sifter::decode_query<field, flag_filter>(
+                         "id=9223372036854775808", field_map())),
+                 sifter::query_error);
+    EXPECT_THROW((sifter::decode_query<field, flag_filter>(
+                         "id=x", field_map())),
+                 sifter::query_error);
+}
+
+TEST(query, long_values)
+{
+    const std::string raw(1000, 'a');
+    std::string escaped;
+    for (int i = 0; i < 500; ++i)
+        escaped += "%61+";
+
+    EXPECT_EQ(decode("name=" + raw), filter(condition(name) == raw));
+
+    std::string spaced;
+    for (int i = 0; i < 500; ++i)
+        spaced += "a ";
+    EXPECT_EQ(decode("name=" + escaped.substr(0, 1024)),
+              filter(condition(name) == spaced.substr(0, 512)));
+    EXPECT_EQ(error_offset("name=" + escaped.substr(0, 1028)), 5u);
+}
+
+TEST(query, errors)
+{
+    EXPECT_EQ(error_offset("age"), 3u);
+    EXPECT_EQ(error_offset("age=1&x=1"), 6u);
+    EXPECT_EQ(error_offset("age=1&age=x"), 10u);
+    EXPECT_EQ(error_offset("age=gt:x"), 7u);
+    EXPECT_EQ(error_offset("name=%4"), 5u);
+    EXPECT_EQ(error_offset("name=%zz"), 5u);
+    EXPECT_EQ(error_offset("or=age"), 6u);
+    EXPECT_EQ(error_offset("or=age:1,x:1"), 9u);
+
+    try
+    {
+        decode("age=1&x=1");
+        FAIL();
+    }
+    catch (const sifter::query_error &e)
+    {
+        EXPECT_STREQ(e.what(), "unknown field at position 6");
+    }
+}
+
+TEST(query, long_queries)
+{
+    std::string terms = "age=1";
+    for (int i = 1; i < 1025; ++i)
+        terms += "&age=1";
+    EXPECT_EQ(decode(terms).depth(), 1024u);
+
+    const std::size_t too_deep_term = terms.size() + 1;
+    terms += "&age=1";
+    EXPECT_EQ(error_offset(terms), too_deep_term);
+    for (int i = 1026; i < 1000000; ++i)
+        terms += "&age=1";
+    EXPECT_EQ(error_offset(terms), too_deep_term);
+
+    std::string alternatives = "or=age:1";
+    for (int i = 1; i < 1025; ++i)
+        alternatives += ",age:1";
+    EXPECT_EQ(decode(alternatives).depth(), 1024u);
+
+    const std::size_t too_deep_alternative = alternatives.size() + 1;
+    alternatives += ",age:1";
+    EXPECT_EQ(error_offset(alternatives), too_deep_alternative);
+    for (int i = 1026; i < 1000000; ++i)
+        alternatives += ",age:1";
+    EXPECT_EQ(error_offset(alternatives), too_deep_alternative);
+}
+
+#ifndef SIFTER_USE_BOOST_VARIANT
+#include <memory_resource>
+
+TEST(query, allocator)
+{
+    using pmr_filter = sifter::filter<field, int, std::pmr::string>;
+
+    char buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(
+            buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    const sifter::allocator_type a(&arena);
+
+    const pmr_filter f = sifter::decode_query<field, pmr_filter>(
+            "name=a+string,+which+does+not+fit+into+small+buffer&age=gt:1"
+            "&or=id:1,id:2",
+            field_map(), sifter::query_values<pmr_filter>(a), a);
+    EXPECT_EQ(f.conditions(), 4u);
+    EXPECT_EQ(f.get_allocator(), a);
+}
+#endif
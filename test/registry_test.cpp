@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <sifter/evaluate.hpp>
+#include <sifter/filter.hpp>
+#include <sifter/registry.hpp>
+
+namespace
+{
+    enum field
+    {
+        id,
+        age
+    };
+
+    using condition = sifter::condition<field, int>;
+    using filter = sifter::filter<field, int>;
+    using registry = sifter::registry<std::string, filter>;
+
+    struct accessor
+    {
+        condition::value_type operator()(int value, field) const
+        {
+            return value;
+        }
+    };
+
+    std::atomic<int> alive(0);
+
+    struct tracked
+    {
+        explicit tracked(int v)
+            : value(v)
+        {
+            ++alive;
+        }
+
+        tracked(const tracked &t)
+            : value(t.value)
+        {
+            ++alive;
+        }
+
+        ~tracked()
+        {
+            --alive;
+        }
+
+        int value;
+    };
+}
+
+TEST(registry, set_find_erase)
+{
+    registry r;
+    EXPECT_EQ(r.read().size(), 0u);
+    EXPECT_EQ(r.read().find("adults"), nullptr);
+
+    r.set("adults", filter(condition(age) >= 18));
+    r.set("kids", filter(condition(age) < 18));
+    {
+        const registry::snapshot s = r.read();
+        ASSERT_NE(s.find("adults"), nullptr);
+        EXPECT_TRUE(sifter::evaluate<field>(*s.find("adults"), 20,
+                                            accessor()));
+        EXPECT_FALSE(sifter::evaluate<field>(*s.find("kids"), 20,
+                                             accessor()));
+        EXPECT_EQ(s.size(), 2u);
+    }
+
+    r.erase("kids");
+    EXPECT_EQ(r.read().find("kids"), nullptr);
+    EXPECT_EQ(r.read().size(), 1u);
+}
+
+TEST(registry, update)
+{
+    registry r;
+    r.set("old", filter(condition(age) > 1));
+    const filter *old = r.read().find("old");
+
+    r.update([](registry::map_type &map)
+    {
+        for (int i = 0; i < 1000; ++i)
+            map["rule " + std::to_string(i)] =
+                    std::make_shared<const filter>(condition(id) == i);
+    });
+
+    const registry::snapshot s = r.read();
+    EXPECT_EQ(s.size(), 1001u);
+    EXPECT_EQ(s.find("old"), old);
+    EXPECT_EQ(*s.find("rule 7"), filter(condition(id) == 7));
+}
+
+TEST(registry, snapshot_outlives_version)
+{
+    alive = 0;
+    {
+        sifter::registry<int, tracked> r;
+        r.set(1, tracked(1));
+
+        std::atomic<bool> published(false);
+        {
+            auto s = r.read();
+            const tracked *t = s.find(1);
+            std::thread writer([&r, &published]()
+            {
+                r.set(1, tracked(2));
+                published = true;
+            });
+            writer.join();
+
+            EXPECT_TRUE(published);
+            EXPECT_EQ(t->value, 1);
+            EXPECT_EQ(alive, 2);
+            EXPECT_EQ(r.reclaim(), 1u);
+            EXPECT_EQ(t->value, 1);
+        }
+
+        EXPECT_EQ(r.reclaim(), 0u);
+        EXPECT_EQ(alive, 1);
+        EXPECT_EQ(r.read().find(1)->value, 2);
+    }
+    EXPECT_EQ(alive, 0);
+}
+
+TEST(registry, update_under_snapshot)
+{
+    alive = 0;
+    {
+        sifter::registry<int, tracked> r;
+        r.set(1, tracked(1));
+        {
+            auto s = r.read();
+            r.set(1, tracked(2));
+            r.set(1, tracked(3));
+
+            EXPECT_EQ(s.find(1)->value, 1);
+            EXPECT_EQ(r.read().find(1)->value, 3);
+            EXPECT_EQ(alive, 3);
+        }
+
+        r.synchronize();
+        EXPECT_EQ(r.reclaim(), 0u);
+        EXPECT_EQ(alive, 1);
+
+        r.set(1, tracked(4));
+        EXPECT_EQ(alive, 1);
+    }
+    EXPECT_EQ(alive, 0);
+}
+
+TEST(registry, concurrent)
+{
+    sifter::registry<int, tracked> r;
+    r.update([](sifter::registry<int, tracked>::map_type &map)
+    {
+        for (int k = 0; k < 16; ++k)
+            map[k] = std::make_shared<const tracked>(0);
+    });
+
+    std::atomic<bool> stop(false);
+    std::atomic<int> errors(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t)
+    {
+        readers.emplace_back([&]()
+        {
+            while (!stop)
+            {
+                const auto s = r.read();
+                const int generation = s.find(0)->value;
+                for (const auto &item : s.items())
+                {
+                    if (item.second->value != generation)
+                        ++errors;
+                }
+            }
+        });
+    }
+
+    for (int g = 1; g <= 200; ++g)
+    {
+        r.update([g](sifter::registry<int, tracked>::map_type &map)
+        {
+            for (auto &item : map)
+                item.second = std::make_shared<const tracked>(g);
+        });
+    }
+    stop = true;
+    for (auto &reader : readers)
+        reader.join();
+
+    r.synchronize();
+    EXPECT_EQ(r.reclaim(), 0u);
+    EXPECT_EQ(errors, 0);
+    EXPECT_EQ(r.read().find(15)->value, 200);
+}
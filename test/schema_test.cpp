@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <sifter/evaluate.hpp>
+#include <sifter/schema.hpp>
+
+namespace
+{
+    enum field
+    {
+        id,
+        name,
+        age,
+        parent_id,
+        nickname,
+        score
+    };
+
+    struct person
+    {
+        int id;
+        std::string name;
+        int age;
+        int parent_id;
+        std::string nickname;
+        double score;
+    };
+
+    using condition = sifter::condition<field, int, std::string>;
+    using filter = sifter::filter<field, int, std::string>;
+
+    using person_schema = sifter::schema<person,
+            SIFTER_FIELD(id, &person::id),
+            SIFTER_FIELD(name, &person::name),
+            SIFTER_FIELD(age, &person::age),
+            SIFTER_FIELD(parent_id, &person::parent_id),
+            SIFTER_FIELD(nickname, &person::nickname),
+            SIFTER_FIELD(score, &person::score)>;
+
+    struct person_accessor
+    {
+        condition::value_type operator()(const person &p, field f) const
+        {
+            switch (f)
+            {
+                case id:
+                    return p.id;
+                case name:
+                case nickname:
+                    return f == name ? p.name : p.nickname;
+                case age:
+                    return p.age;
+                case parent_id:
+                    return p.parent_id;
+                case score:
+                    break;
+            }
+            return condition::value_type();
+        }
+    };
+
+    const std::vector<person> persons =
+    {
+        {1, "John Smith", 20, 0, "John", 1.0},
+        {2, "Jane Smith", 35, 1, "Jane Smith", 2.0},
+        {3, "Bob Brown", 42, 3, "Bobby", 3.0},
+        {4, "Alice", 17, 2, "Al", 4.0}
+    };
+
+    void expect_same(const filter &f)
+    {
+        const auto bound = person_schema::bind(f);
+        for (const auto &p : persons)
+            EXPECT_EQ(bound(p), sifter::evaluate<field>(f, p,
+                                                        person_accessor()))
+                    << p.id;
+    }
+
+    void expect_same(const condition &c)
+    {
+        expect_same(filter(c));
+    }
+}
+
+TEST(schema, evaluate)
+{
+    expect_same(filter());
+    expect_same(condition(id) == 2);
+    expect_same(condition(id) != 2);
+    expect_same(condition(age) < 35);
+    expect_same(condition(age) <= 35);
+    expect_same(condition(age) > 20);
+    expect_same(condition(age) >= 20);
+    expect_same(condition(name) % "%Smith");
+    expect_same(filter(~(condition(name) % "%Smith")));
+    expect_same(condition(name) < "Bob");
+    expect_same(condition(id) < 3 && (condition(name) % "J%" ||
+                                      condition(age) > 40));
+    expect_same((condition(id) == 1 || condition(id) == 4) &&
+                condition(age) < 18);
+    expect_same(~(condition(id) < 3 && (condition(name) % "J%" ||
+                                        condition(age) > 40)));
+}
+
+TEST(schema, operand_order)
+{
+    expect_same(filter(condition(30) < age));
+    expect_same(filter(condition("Jane Smith") % nickname));
+    expect_same(filter(condition(parent_id, id, sifter::lt)));
+    expect_same(filter(condition(name, nickname, sifter::eq)));
+    expect_same(filter(condition(1) < 2) && condition(age) > 20);
+    expect_same(filter(condition(1) > 2) || condition(age) > 20);
+}
+
+TEST(schema, errors)
+{
+    using vcondition = sifter::condition<field, int, std::string, long>;
+    using vfilter = sifter::filter<field, int, std::string, long>;
+
+    EXPECT_THROW(person_schema::bind(filter(condition(age) == "20")),
+                 sifter::schema_error);
+    EXPECT_THROW(person_schema::bind(filter(condition(age) % 20)),
+                 sifter::schema_error);
+    EXPECT_THROW(person_schema::bind(filter(~(condition(age) % 20))),
+                 sifter::schema_error);
+    EXPECT_THROW(person_schema::bind(filter(condition(age, name,
+                                                      sifter::eq))),
+                 sifter::schema_error);
+    EXPECT_THROW(person_schema::bind(filter(condition(score) == 1)),
+                 sifter::schema_error);
+    EXPECT_THROW(person_schema::bind(vfilter(vcondition(age) == 20L)),
+                 sifter::schema_error);
+    EXPECT_THROW(person_schema::bind(filter(condition(static_cast<field>(9))
+                                            == 1)),
+                 sifter::schema_error);
+}
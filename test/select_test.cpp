@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <sifter/select.hpp>
+
+namespace
+{
+    enum field
+    {
+        id,
+        name
+    };
+
+    struct person
+    {
+        int id;
+        std::string name;
+    };
+
+    using condition = sifter::condition<field, int, std::string>;
+    using filter = sifter::filter<field, int, std::string>;
+
+    struct person_accessor
+    {
+        condition::value_type operator()(const person &p, field f) const
+        {
+            if (f == id)
+                return p.id;
+            return p.name;
+        }
+    };
+
+    struct divisible
+    {
+        bool operator()(int value) const
+        {
+            return value % divisor == 0;
+        }
+
+        int divisor;
+    };
+
+    std::vector<std::size_t> expected(const std::vector<int> &values,
+                                      divisible predicate, std::size_t limit)
+    {
+        std::vector<std::size_t> out;
+        for (std::size_t i = 0; i < values.size() && out.size() < limit; ++i)
+        {
+            if (predicate(values[i]))
+                out.push_back(i);
+        }
+        return out;
+    }
+}
+
+TEST(select, select_if)
+{
+    sifter::thread_pool pool(4);
+    sifter::inline_executor single;
+
+    for (const std::size_t size : {0, 1, 4095, 4096, 4097, 100000})
+    {
+        std::vector<int> values(size);
+        for (std::size_t i = 0; i < size; ++i)
+            values[i] = static_cast<int>(i * 7919 % 1000);
+
+        for (const int divisor : {1, 3, 1000, 2000})
+        {
+            const divisible predicate{divisor};
+            EXPECT_EQ(sifter::select_if(values, predicate, pool),
+                      expected(values, predicate, sifter::no_limit));
+            EXPECT_EQ(sifter::select_if(values, predicate, single),
+                      expected(values, predicate, sifter::no_limit));
+        }
+    }
+}
+
+TEST(select, limit)
+{
+    sifter::thread_pool pool(4);
+
+    std::vector<int> values(50000);
+    for (std::size_t i = 0; i < values.size(); ++i)
+        values[i] = static_cast<int>(i % 5000);
+
+    const divisible predicate{7};
+    for (const std::size_t limit : {0, 1, 10, 700, 5000, 100000})
+    {
+        for (int i = 0; i < 10; ++i)
+            EXPECT_EQ(sifter::select_if(values, predicate, pool, limit),
+                      expected(values, predicate, limit));
+    }
+}
+
+TEST(select, early_exit)
+{
+    struct counting
+    {
+        bool operator()(int value) const
+        {
+            ++*calls;
+            return value % 10 == 0;
+        }
+
+        std::atomic<std::size_t> *calls;
+    };
+
+    const std::vector<int> values(1000000, 0);
+    std::atomic<std::size_t> calls(0);
+
+    sifter::inline_executor single;
+    EXPECT_EQ(sifter::select_if(values, counting{&calls}, single, 50).size(),
+              50u);
+    EXPECT_EQ(calls.load(), 50u);
+
+    calls = 0;
+    sifter::thread_pool pool(4);
+    EXPECT_EQ(sifter::select_if(values, counting{&calls}, pool, 50).size(),
+              50u);
+    EXPECT_LT(calls.load(), 4u * 4096u);
+}
+
+TEST(select, filter)
+{
+    sifter::thread_pool pool(3);
+
+    std::vector<person> persons;
+    for (int i = 0; i < 10000; ++i)
+        persons.push_back({i, i % 3 == 0 ? "John" : "Jane"});
+
+    const filter f = condition(id) < 5000 && condition(name) % "Jo%";
+    const auto indices = sifter::select<field>(persons, f,
+                                               person_accessor(), pool);
+
+    ASSERT_EQ(indices.size(), 1667u);
+    for (std::size_t i = 0; i < indices.size(); ++i)
+        EXPECT_EQ(indices[i], i * 3);
+
+    EXPECT_EQ(sifter::select<field>(persons, f, person_accessor(), pool, 2),
+              std::vector<std::size_t>({0, 3}));
+}
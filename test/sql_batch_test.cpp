@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "sql/sql.hpp"
+
+namespace
+{
+    const sql::fieldmap &sql_fields()
+    {
+        static const sql::fieldmap fields =
+        {
+            {sql::id, "id"},
+            {sql::name, "name"},
+            {sql::age, "age"}
+        };
+        return fields;
+    }
+
+    const std::vector<sql::filter> &filters()
+    {
+        static const std::vector<sql::filter> out =
+        {
+            sql::filter(sql::condition(sql::age) >= 18),
+            sql::filter(sql::condition(sql::name) % "J%"),
+            sql::condition(sql::id) > 10 || sql::condition(sql::age) < 20
+        };
+        return out;
+    }
+
+    sql::batch make_batch(sql::batch_mode mode,
+                          const std::vector<sql::filter> &filters)
+    {
+        return sql::batch(mode, "id, name", "person", filters, sql_fields());
+    }
+
+    /*
+     * Row, returned by the batched statement: id of the person and integer
+     * columns, added by the batch.
+     */
+    struct row
+    {
+        int id;
+        std::map<std::string, int> columns;
+    };
+
+    struct reader
+    {
+        int operator()(const row &r, const std::string &column) const
+        {
+            return r.columns.at(column);
+        }
+    };
+
+    std::vector<int> ids(const std::vector<row> &rows)
+    {
+        std::vector<int> out;
+        for (const auto &r : rows)
+            out.push_back(r.id);
+        return out;
+    }
+}
+
+TEST(sql_batch, union_all)
+{
+    const auto b = make_batch(sql::batch_mode::union_all, filters());
+    EXPECT_EQ(3u, b.size());
+    EXPECT_EQ("sifter_filter", b.column(0));
+    EXPECT_EQ("sifter_filter", b.column(2));
+    EXPECT_EQ("select 0 as sifter_filter, id, name from person"
+              " where (age >= :q0lrv)"
+              " union all "
+              "select 1 as sifter_filter, id, name from person"
+              " where (name like :q1lrv)"
+              " union all "
+              "select 2 as sifter_filter, id, name from person"
+              " where (id > :q2lrv or age < :q2rrv)",
+              b.statement().sql());
+}
+
+TEST(sql_batch, case_flags)
+{
+    const auto b = make_batch(sql::batch_mode::case_flags, filters());
+    EXPECT_EQ(3u, b.size());
+    EXPECT_EQ("sifter_f0", b.column(0));
+    EXPECT_EQ("sifter_f2", b.column(2));
+    EXPECT_EQ("select id, name"
+              ", case when (age >= :q0lrv) then 1 else 0 end as sifter_f0"
+              ", case when (name like :q1lrv) then 1 else 0 end as sifter_f1"
+              ", case when (id > :q2lrv or age < :q2rrv)"
+              " then 1 else 0 end as sifter_f2"
+              " from person where (age >= :q0lrv) or (name like :q1lrv)"
+              " or (id > :q2lrv or age < :q2rrv)",
+              b.statement().sql());
+}
+
+TEST(sql_batch, placeholders)
+{
+    const auto b = make_batch(sql::batch_mode::union_all, filters());
+    EXPECT_EQ("select 0 as sifter_filter, id, name from person"
+              " where (age >= 18)"
+              " union all "
+              "select 1 as sifter_filter, id, name from person"
+              " where (name like 'J%')"
+              " union all "
+              "select 2 as sifter_filter, id, name from person"
+              " where (id > 10 or age < 20)",
+              b.statement().bound_sql());
+}
+
+TEST(sql_batch, demultiplex_union_all)
+{
+    const auto b = make_batch(sql::batch_mode::union_all, filters());
+    const std::vector<row> rows =
+    {
+        {1, {{"sifter_filter", 0}}},
+        {2, {{"sifter_filter", 2}}},
+        {3, {{"sifter_filter", 0}}},
+        {3, {{"sifter_filter", 1}}},
+        {4, {{"sifter_filter", 3}}}
+    };
+
+    const auto out = b.demultiplex(rows, reader());
+    ASSERT_EQ(3u, out.size());
+    EXPECT_EQ((std::vector<int>{1, 3}), ids(out[0]));
+    EXPECT_EQ((std::vector<int>{3}), ids(out[1]));
+    EXPECT_EQ((std::vector<int>{2}), ids(out[2]));
+}
+
+TEST(sql_batch, demultiplex_case_flags)
+{
+    const auto b = make_batch(sql::batch_mode::case_flags, filters());
+    const std::vector<row> rows =
+    {
+        {1, {{"sifter_f0", 1}, {"sifter_f1", 0}, {"sifter_f2", 1}}},
+        {2, {{"sifter_f0", 0}, {"sifter_f1", 1}, {"sifter_f2", 0}}},
+        {3, {{"sifter_f0", 1}, {"sifter_f1", 1}, {"sifter_f2", 0}}}
+    };
+
+    const auto out = b.demultiplex(rows, reader());
+    ASSERT_EQ(3u, out.size());
+    EXPECT_EQ((std::vector<int>{1, 3}), ids(out[0]));
+    EXPECT_EQ((std::vector<int>{2, 3}), ids(out[1]));
+    EXPECT_EQ((std::vector<int>{1}), ids(out[2]));
+}
+
+TEST(sql_batch, empty)
+{
+    const std::vector<sql::filter> none;
+    const std::vector<row> rows = {{1, {{"sifter_filter", 0}}}};
+
+    const auto by_union = make_batch(sql::batch_mode::union_all, none);
+    EXPECT_EQ(0u, by_union.size());
+    EXPECT_EQ("select 0 as sifter_filter, id, name from person where 1 = 0",
+              by_union.statement().sql());
+    EXPECT_TRUE(by_union.demultiplex(rows, reader()).empty());
+
+    const auto by_flags = make_batch(sql::batch_mode::case_flags, none);
+    EXPECT_EQ(0u, by_flags.size());
+    EXPECT_EQ("select id, name from person where 1 = 0",
+              by_flags.statement().sql());
+    EXPECT_TRUE(by_flags.demultiplex(rows, reader()).empty());
+}
+
+TEST(sql_batch, single)
+{
+    const std::vector<sql::filter> one =
+            {sql::filter(sql::condition(sql::id) == 7)};
+    const std::vector<row> rows =
+    {
+        {7, {{"sifter_filter", 0}, {"sifter_f0", 1}}}
+    };
+
+    const auto by_union = make_batch(sql::batch_mode::union_all, one);
+    EXPECT_EQ("select 0 as sifter_filter, id, name from person"
+              " where (id = 7)",
+              by_union.statement().bound_sql());
+    const auto union_out = by_union.demultiplex(rows, reader());
+    ASSERT_EQ(1u, union_out.size());
+    EXPECT_EQ((std::vector<int>{7}), ids(union_out[0]));
+
+    const auto by_flags = make_batch(sql::batch_mode::case_flags, one);
+    EXPECT_EQ("select id, name"
+              ", case when (id = 7) then 1 else 0 end as sifter_f0"
+              " from person where (id = 7)",
+              by_flags.statement().bound_sql());
+    const auto flags_out = by_flags.demultiplex(rows, reader());
+    ASSERT_EQ(1u, flags_out.size());
+    EXPECT_EQ((std::vector<int>{7}), ids(flags_out[0]));
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <sstream>
+#include <gtest/gtest.h>
+#include <sifter/static_filter.hpp>
+#include <sifter/ostream.hpp>
+
+namespace
+{
+    enum field
+    {
+        id,
+        name,
+        age
+    };
+
+    struct person
+    {
+        int id;
+        std::string name;
+        int age;
+    };
+
+    using condition = sifter::condition<field, int, std::string>;
+    using filter = sifter::filter<field, int, std::string>;
+
+    using id_field = SIFTER_FIELD(id, &person::id);
+    using name_field = SIFTER_FIELD(name, &person::name);
+    using age_field = SIFTER_FIELD(age, &person::age);
+
+    const id_field id_ = id_field();
+    const name_field name_ = name_field();
+    const age_field age_ = age_field();
+}
+
+TEST(static_filter, field)
+{
+    const person john = {1, "John Smith", 25};
+
+    EXPECT_EQ(age_field::key(), age);
+    EXPECT_EQ(age_field::get(john), 25);
+    EXPECT_EQ(name_field::get(john), "John Smith");
+}
+
+TEST(static_filter, evaluate)
+{
+    const person john = {1, "John Smith", 25};
+    const person jane = {2, "Jane Doe", 17};
+
+    const auto f0 = id_ < 10 && (name_ % "John%" || age_ > 20);
+    EXPECT_TRUE(f0(john));
+    EXPECT_FALSE(f0(jane));
+
+    EXPECT_TRUE((id_ == 2)(jane));
+    EXPECT_TRUE((id_ != 2)(john));
+    EXPECT_TRUE((age_ <= 17)(jane));
+    EXPECT_TRUE((age_ >= 25)(john));
+    EXPECT_TRUE((name_ == "Jane Doe")(jane));
+    EXPECT_TRUE((name_ < std::string("K"))(jane));
+    EXPECT_FALSE((name_ % "%Doe")(john));
+
+    const auto f1 = ~f0;
+    EXPECT_FALSE(f1(john));
+    EXPECT_TRUE(f1(jane));
+    EXPECT_TRUE((~(name_ % "%Doe"))(john));
+}
+
+TEST(static_filter, to_filter)
+{
+    const auto f0 = id_ < 10 && (name_ % "John%" || age_ > 20);
+    const filter f1 = condition(id) < 10 &&
+                      (condition(name) % "John%" || condition(age) > 20);
+
+    EXPECT_EQ(sifter::to_filter<filter>(f0), f1);
+    EXPECT_EQ(sifter::to_filter<filter>(age_ >= 5),
+              filter(condition(age) >= 5));
+    EXPECT_EQ(sifter::to_filter<filter>(~f0), ~f1);
+}
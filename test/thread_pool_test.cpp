@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include <gtest/gtest.h>
+#include <sifter/thread_pool.hpp>
+
+TEST(thread_pool, run)
+{
+    sifter::thread_pool pool(4);
+    EXPECT_EQ(pool.size(), 4u);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        std::vector<std::atomic<int>> calls(pool.size());
+        for (auto &c : calls)
+            c = 0;
+
+        pool.run([&calls](std::size_t worker) { ++calls[worker]; });
+
+        for (auto &c : calls)
+            EXPECT_EQ(c.load(), 1);
+    }
+}
+
+TEST(thread_pool, exception)
+{
+    sifter::thread_pool pool(3);
+
+    EXPECT_THROW(pool.run([](std::size_t worker) {
+        if (worker == 2)
+            throw std::runtime_error("error");
+    }), std::runtime_error);
+
+    std::atomic<int> calls(0);
+    pool.run([&calls](std::size_t) { ++calls; });
+    EXPECT_EQ(calls.load(), 3);
+}
+
+TEST(thread_pool, single)
+{
+    sifter::thread_pool pool(1);
+    std::size_t called = 10;
+    pool.run([&called](std::size_t worker) { called = worker; });
+    EXPECT_EQ(called, 0u);
+}
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <forward_list>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include <sifter/schema.hpp>
+#include <sifter/view.hpp>
+
+namespace
+{
+    enum field
+    {
+        id,
+        name
+    };
+
+    struct person
+    {
+        int id;
+        std::string name;
+    };
+
+    using condition = sifter::condition<field, int, std::string>;
+    using filter = sifter::filter<field, int, std::string>;
+
+    using person_schema = sifter::schema<person,
+            SIFTER_FIELD(id, &person::id),
+            SIFTER_FIELD(name, &person::name)>;
+
+    struct person_accessor
+    {
+        condition::value_type operator()(const person &p, field f) const
+        {
+            if (f == id)
+                return p.id;
+            return p.name;
+        }
+    };
+
+    struct divisible
+    {
+        bool operator()(int value) const
+        {
+            ++*calls;
+            return value % divisor == 0;
+        }
+
+        int divisor;
+        int *calls;
+    };
+
+    template <typename Range>
+    std::vector<int> collect(const Range &range)
+    {
+        std::vector<int> out;
+        for (const auto &value : range)
+            out.push_back(value);
+        return out;
+    }
+
+    /*
+     * Single-pass range of the integers, read from the stream.
+     */
+    class input_range
+    {
+    public:
+        explicit input_range(const std::string &text)
+            : m_stream(new std::istringstream(text))
+        {
+        }
+
+        std::istream_iterator<int> begin() const
+        {
+            return std::istream_iterator<int>(*m_stream);
+        }
+
+        std::istream_iterator<int> end() const
+        {
+            return std::istream_iterator<int>();
+        }
+
+    private:
+        std::shared_ptr<std::istringstream> m_stream;
+    };
+
+    template <typename Range, typename Adaptor, typename = void>
+    struct is_adaptable : std::false_type
+    {
+    };
+
+    template <typename Range, typename Adaptor>
+    struct is_adaptable<Range, Adaptor, decltype(static_cast<void>(
+            std::declval<const Range &>() | std::declval<Adaptor>()))>
+        : std::true_type
+    {
+    };
+
+    std::vector<int> iota(int size)
+    {
+        std::vector<int> out;
+        for (int i = 0; i < size; ++i)
+            out.push_back(i);
+        return out;
+    }
+}
+
+TEST(view, where)
+{
+    int calls = 0;
+
+    for (const int size : {0, 1, 63, 64, 65, 200})
+    {
+        const std::vector<int> values = iota(size);
+
+        for (const int divisor : {1, 2, 64, 70, 1000})
+        {
+            std::vector<int> expected;
+            for (const int v : values)
+            {
+                if (v % divisor == 0)
+                    expected.push_back(v);
+            }
+
+            const divisible predicate{divisor, &calls};
+            EXPECT_EQ(collect(values | sifter::where_if(predicate)),
+                      expected);
+
+            const std::list<int> list(values.begin(), values.end());
+            EXPECT_EQ(collect(list | sifter::where_if(predicate)), expected);
+
+            const std::forward_list<int> forward(values.begin(),
+                                                 values.end());
+            EXPECT_EQ(collect(forward | sifter::where_if(predicate)),
+                      expected);
+        }
+    }
+}
+
+TEST(view, take)
+{
+    const std::vector<int> values = iota(10);
+
+    EXPECT_EQ(collect(values | sifter::take(3)), std::vector<int>({0, 1, 2}));
+    EXPECT_EQ(collect(values | sifter::take(0)), std::vector<int>());
+    EXPECT_EQ(collect(values | sifter::take(20)), values);
+
+    int calls = 0;
+    const divisible even{2, &calls};
+    EXPECT_EQ(collect(values | sifter::take(5) | sifter::where_if(even)),
+              std::vector<int>({0, 2, 4}));
+    EXPECT_EQ(collect(values | sifter::where_if(even) | sifter::take(2)),
+              std::vector<int>({0, 2}));
+}
+
+TEST(view, lazy)
+{
+    const std::vector<int> values = iota(10000);
+
+    int calls = 0;
+    const divisible predicate{3, &calls};
+    const auto view = values | sifter::where_if(predicate) | sifter::take(5);
+    EXPECT_EQ(calls, 0);
+
+    EXPECT_EQ(collect(view), std::vector<int>({0, 3, 6, 9, 12}));
+    EXPECT_EQ(calls, 64);
+
+    calls = 0;
+    const divisible rare{1000, &calls};
+    EXPECT_EQ(collect(values | sifter::where_if(rare) | sifter::take(2)),
+              std::vector<int>({0, 1000}));
+    EXPECT_EQ(calls, 1024);
+}
+
+TEST(view, filter)
+{
+    std::vector<person> persons;
+    for (int i = 0; i < 300; ++i)
+        persons.push_back({i, i % 2 ? "John" : "Jane"});
+
+    const filter f = condition(id) >= 100 && condition(name) == "John";
+
+    std::vector<int> ids;
+    for (const auto &p : persons | sifter::where<field>(f, person_accessor())
+                                 | sifter::take(3))
+        ids.push_back(p.id);
+    EXPECT_EQ(ids, std::vector<int>({101, 103, 105}));
+
+    ids.clear();
+    const auto bound = person_schema::bind(f);
+    for (const auto &p : persons | sifter::where_if(bound) | sifter::take(2))
+        ids.push_back(p.id);
+    EXPECT_EQ(ids, std::vector<int>({101, 103}));
+}
+
+TEST(view, input_range)
+{
+    using where_adaptor = sifter::where_adaptor<divisible>;
+    static_assert(is_adaptable<std::vector<int>, where_adaptor>::value,
+                  "where accepts forward ranges");
+    static_assert(is_adaptable<std::forward_list<int>, where_adaptor>::value,
+                  "where accepts forward ranges");
+    static_assert(!is_adaptable<input_range, where_adaptor>::value,
+                  "where rejects single-pass ranges");
+
+    using take_category =
+            sifter::take_view<input_range>::iterator::iterator_category;
+    static_assert(std::is_same<take_category, std::input_iterator_tag>::value,
+                  "take over single-pass range is single-pass");
+
+    const input_range numbers("1 2 3 4 5");
+    EXPECT_EQ(collect(numbers | sifter::take(3)), std::vector<int>({1, 2, 3}));
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <map>
+#include <gtest/gtest.h>
+#include <sifter/zone_map.hpp>
+
+namespace
+{
+    enum field
+    {
+        ts,
+        name,
+        age
+    };
+
+    using condition = sifter::condition<field, int, std::string>;
+    using filter = sifter::filter<field, int, std::string>;
+    using stats = sifter::column_stats<condition::value_type>;
+
+    class block
+    {
+    public:
+        block()
+        {
+            m_stats[ts].min = 100;
+            m_stats[ts].max = 200;
+            m_stats[ts].rows = 10;
+
+            m_stats[name].min = "Jane";
+            m_stats[name].max = "John";
+            m_stats[name].rows = 10;
+            m_stats[name].nulls = 2;
+        }
+
+        const stats *operator()(field f) const
+        {
+            const auto p = m_stats.find(f);
+            return p == m_stats.end() ? nullptr : &p->second;
+        }
+
+        stats &operator[](field f)
+        {
+            return m_stats[f];
+        }
+
+    private:
+        std::map<field, stats> m_stats;
+    };
+}
+
+TEST(zone_map, condition)
+{
+    block b;
+
+    EXPECT_EQ(sifter::match_block<field>(condition(ts) < 100, b),
+              sifter::block_match::never);
+    EXPECT_EQ(sifter::match_block<field>(condition(ts) < 150, b),
+              sifter::block_match::maybe);
+    EXPECT_EQ(sifter::match_block<field>(condition(ts) < 201, b),
+              sifter::block_match::always);
+    EXPECT_EQ(sifter::match_block<field>(condition(ts) <= 200, b),
+              sifter::block_match::always);
+    EXPECT_EQ(sifter::match_block<field>(condition(ts) > 200, b),
+              sifter::block_match::never);
+    EXPECT_EQ(sifter::match_block<field>(condition(ts) >= 100, b),
+              sifter::block_match::always);
+    EXPECT_EQ(sifter::match_block<field>(condition(ts) == 50, b),
+              sifter::block_match::never);
+    EXPECT_EQ(sifter::match_block<field>(condition(ts) != 50, b),
+              sifter::block_match::always);
+    EXPECT_EQ(sifter::match_block<field>(condition(ts) == 150, b),
+              sifter::block_match::maybe);
+    EXPECT_EQ(sifter::match_block<field>(condition(ts) == "150", b),
+              sifter::block_match::never);
+
+    // literal on the left side
+    EXPECT_EQ(sifter::match_block<field>(
+            condition(50, condition::value_type(ts), sifter::lt), b),
+              sifter::block_match::always);
+
+    // no statistics
+    EXPECT_EQ(sifter::match_block<field>(condition(age) == 5, b),
+              sifter::block_match::maybe);
+
+    // nulls never match
+    EXPECT_EQ(sifter::match_block<field>(condition(name) >= "A", b),
+              sifter::block_match::maybe);
+    b[age].rows = 4;
+    b[age].nulls = 4;
+    EXPECT_EQ(sifter::match_block<field>(condition(age) != 5, b),
+              sifter::block_match::never);
+
+    // single value
+    b[age].min = 7;
+    b[age].max = 7;
+    b[age].nulls = 0;
+    EXPECT_EQ(sifter::match_block<field>(condition(age) == 7, b),
+              sifter::block_match::always);
+    EXPECT_EQ(sifter::match_block<field>(condition(age) != 7, b),
+              sifter::block_match::never);
+}
+
+TEST(zone_map, like)
+{
+    block b;
+    b[name].nulls = 0;
+
+    EXPECT_EQ(sifter::match_block<field>(condition(name) % "Jo%", b),
+              sifter::block_match::maybe);
+    EXPECT_EQ(sifter::match_block<field>(condition(name) % "Ja%", b),
+              sifter::block_match::maybe);
+    EXPECT_EQ(sifter::match_block<field>(condition(name) % "Jb%", b),
+              sifter::block_match::maybe);
+    EXPECT_EQ(sifter::match_block<field>(condition(name) % "Ab%", b),
+              sifter::block_match::never);
+    EXPECT_EQ(sifter::match_block<field>(condition(name) % "K%", b),
+              sifter::block_match::never);
+    EXPECT_EQ(sifter::match_block<field>(condition(name) % "%n", b),
+              sifter::block_match::maybe);
+    EXPECT_EQ(sifter::match_block<field>(condition(ts) % "1%", b),
+              sifter::block_match::never);
+
+    EXPECT_EQ(sifter::match_block<field>(~(condition(name) % "Jo%"), b),
+              sifter::block_match::maybe);
+    EXPECT_EQ(sifter::match_block<field>(~(condition(name) % "K%"), b),
+              sifter::block_match::always);
+    EXPECT_EQ(sifter::match_block<field>(~(condition(ts) % "1%"), b),
+              sifter::block_match::always);
+}
+
+TEST(zone_map, sketch)
+{
+    block b;
+    b[ts].may_contain = [](const condition::value_type &v)
+    {
+        return sifter::get<int>(v) % 2 == 0;
+    };
+
+    EXPECT_EQ(sifter::match_block<field>(condition(ts) == 151, b),
+              sifter::block_match::never);
+    EXPECT_EQ(sifter::match_block<field>(condition(ts) != 151, b),
+              sifter::block_match::always);
+    EXPECT_EQ(sifter::match_block<field>(condition(ts) == 150, b),
+              sifter::block_match::maybe);
+}
+
+TEST(zone_map, filter)
+{
+    block b;
+
+    filter f0 = condition(ts) > 300 && condition(age) == 5;
+    EXPECT_EQ(sifter::match_block<field>(f0, b), sifter::block_match::never);
+
+    filter f1 = condition(ts) > 50 && condition(ts) < 300;
+    EXPECT_EQ(sifter::match_block<field>(f1, b), sifter::block_match::always);
+
+    filter f2 = condition(ts) > 50 && condition(age) == 5;
+    EXPECT_EQ(sifter::match_block<field>(f2, b), sifter::block_match::maybe);
+
+    filter f3 = condition(ts) > 300 || condition(age) == 5;
+    EXPECT_EQ(sifter::match_block<field>(f3, b), sifter::block_match::maybe);
+
+    filter f4 = condition(ts) > 300 || condition(ts) < 10;
+    EXPECT_EQ(sifter::match_block<field>(f4, b), sifter::block_match::never);
+
+    filter f5 = condition(age) == 5 || condition(ts) < 300;
+    EXPECT_EQ(sifter::match_block<field>(f5, b), sifter::block_match::always);
+
+    EXPECT_EQ(sifter::match_block<field>(filter(), b),
+              sifter::block_match::always);
+}
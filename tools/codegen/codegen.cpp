@@ -0,0 +1,565 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include "codegen.hpp"
+
+namespace
+{
+    using sifter::codegen::condition;
+    using sifter::codegen::error;
+    using sifter::codegen::field_id;
+    using sifter::codegen::filter;
+    using sifter::codegen::kind;
+    using sifter::codegen::schema_description;
+    using sifter::comparison;
+    using sifter::operation;
+    using sifter::eq;
+    using sifter::ne;
+    using sifter::lt;
+    using sifter::le;
+    using sifter::gt;
+    using sifter::ge;
+    using sifter::like;
+    using sifter::not_like;
+
+    std::string trim(const std::string &text)
+    {
+        const auto begin = text.find_first_not_of(" \t\r");
+        if (begin == std::string::npos)
+            return std::string();
+
+        const auto end = text.find_last_not_of(" \t\r");
+        return text.substr(begin, end - begin + 1);
+    }
+
+    bool is_identifier(const std::string &text)
+    {
+        if (text.empty() || std::isdigit(static_cast<unsigned char>(text[0])))
+            return false;
+
+        for (const char c : text)
+        {
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_')
+                return false;
+        }
+        return true;
+    }
+
+    std::string at_line(std::size_t line, const std::string &what)
+    {
+        return "line " + std::to_string(line) + ": " + what;
+    }
+
+    kind parse_kind(const std::string &text)
+    {
+        if (text == "integer")
+            return kind::integer;
+        if (text == "floating")
+            return kind::floating;
+        if (text == "string")
+            return kind::string;
+
+        throw error("unknown field type \"" + text +
+                    "\", expected integer, floating or string");
+    }
+
+    class parser
+    {
+    public:
+        parser(const std::string &text, const schema_description &schema)
+            : m_text(text),
+              m_schema(schema),
+              m_pos(0)
+        {
+        }
+
+        filter parse()
+        {
+            if (m_text.empty())
+                return filter();
+
+            filter f = node();
+            if (m_pos != m_text.size())
+                fail("unexpected text");
+
+            return f;
+        }
+
+    private:
+        filter node()
+        {
+            if (!consume("("))
+                return filter(parse_condition());
+
+            filter out;
+            if (!at_operation())
+                out = node();
+
+            const operation oper = parse_operation();
+
+            if (!consume(")"))
+            {
+                const filter rhs = node();
+                if (oper == operation::_and)
+                    out &= rhs;
+                else
+                    out |= rhs;
+
+                if (!consume(")"))
+                    fail("')' expected");
+            }
+            return out;
+        }
+
+        condition parse_condition()
+        {
+            const std::size_t begin = m_pos;
+            while (m_pos < m_text.size() &&
+                   std::isdigit(static_cast<unsigned char>(m_text[m_pos])))
+                ++m_pos;
+
+            if (m_pos == begin)
+                fail("field expected");
+
+            const std::string digits = m_text.substr(begin, m_pos - begin);
+            errno = 0;
+            const long number = std::strtol(digits.c_str(), nullptr, 10);
+            if (errno == ERANGE || number > INT_MAX)
+                fail("unknown field " + digits);
+
+            const int id = static_cast<int>(number);
+            const auto field = m_schema.fields.find(id);
+            if (field == m_schema.fields.end())
+                fail("unknown field " + digits);
+
+            const comparison c = parse_comparison();
+            if ((c == like || c == not_like) &&
+                field->second.type != kind::string)
+                fail("'~' and '!~' are applicable to strings only");
+
+            return condition(static_cast<field_id>(id),
+                             parse_value(field->second.type), c);
+        }
+
+        comparison parse_comparison()
+        {
+            if (consume("=="))
+                return eq;
+            if (consume("!="))
+                return ne;
+            if (consume("<="))
+                return le;
+            if (consume(">="))
+                return ge;
+            if (consume("<"))
+                return lt;
+            if (consume(">"))
+                return gt;
+            if (consume("~"))
+                return like;
+            if (consume("!~"))
+                return not_like;
+
+            fail("comparison expected");
+            return eq;
+        }
+
+        operation parse_operation()
+        {
+            if (consume("&&"))
+                return operation::_and;
+            if (consume("||"))
+                return operation::_or;
+
+            fail("\"&&\" or \"||\" expected");
+            return operation::_none;
+        }
+
+        condition::value_type parse_value(kind type)
+        {
+            const char *begin = m_text.c_str() + m_pos;
+            char *end = nullptr;
+
+            switch (type)
+            {
+                case kind::integer:
+                {
+                    errno = 0;
+                    const long long value = std::strtoll(begin, &end, 10);
+                    advance(begin, end, "integer expected");
+                    if (errno == ERANGE)
+                        fail("integer out of range");
+                    return value;
+                }
+                case kind::floating:
+                {
+                    const double value = std::strtod(begin, &end);
+                    advance(begin, end, "number expected");
+                    if (!std::isfinite(value))
+                        fail("finite number expected");
+                    return value;
+                }
+                case kind::string:
+                    break;
+            }
+
+            const std::size_t start = m_pos;
+            while (m_pos < m_text.size() && m_text[m_pos] != ')' &&
+                   !at_operation())
+                ++m_pos;
+
+            return m_text.substr(start, m_pos - start);
+        }
+
+        void advance(const char *begin, const char *end,
+                     const std::string &what)
+        {
+            if (end == begin || std::isspace(static_cast<unsigned char>(*begin)))
+                fail(what);
+
+            m_pos += static_cast<std::size_t>(end - begin);
+        }
+
+        bool at_operation() const
+        {
+            return m_text.compare(m_pos, 2, "&&") == 0 ||
+                   m_text.compare(m_pos, 2, "||") == 0;
+        }
+
+        bool consume(const char *token)
+        {
+            const std::size_t size = std::strlen(token);
+            if (m_text.compare(m_pos, size, token) != 0)
+                return false;
+
+            m_pos += size;
+            return true;
+        }
+
+        void fail(const std::string &what) const
+        {
+            throw error(what + " at position " + std::to_string(m_pos));
+        }
+
+        const std::string &m_text;
+        const schema_description &m_schema;
+        std::size_t m_pos;
+    };
+
+    std::string string_literal(const std::string &value)
+    {
+        std::string out = "\"";
+        for (const char c : value)
+        {
+            const auto u = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\')
+            {
+                out += '\\';
+                out += c;
+            }
+            else if (u < 0x20 || u >= 0x7f || c == '?')
+            {
+                char text[8];
+                std::snprintf(text, sizeof(text), "\\%03o", u);
+                out += text;
+            }
+            else
+            {
+                out += c;
+            }
+        }
+        return out + '"';
+    }
+
+    std::string literal(const condition::value_type &value)
+    {
+        if (sifter::holds_alternative<long long>(value))
+        {
+            /*
+             * -9223372036854775808 is the negated literal, which does not
+             * fit long long.
+             */
+            const long long number = sifter::get<long long>(value);
+            if (number == LLONG_MIN)
+                return "(" + std::to_string(LLONG_MIN + 1) + "LL - 1)";
+            return std::to_string(number);
+        }
+
+        if (sifter::holds_alternative<double>(value))
+        {
+            const double number = sifter::get<double>(value);
+            if (!std::isfinite(number))
+                throw error("finite number expected");
+
+            char text[32];
+            std::snprintf(text, sizeof(text), "%.17g", number);
+            std::string out = text;
+            if (out.find_first_of(".e") == std::string::npos)
+                out += ".0";
+            return out;
+        }
+
+        return string_literal(sifter::get<std::string>(value));
+    }
+
+    const char *cpp_operator(comparison c)
+    {
+        switch (c)
+        {
+            case eq:
+                return " == ";
+            case ne:
+                return " != ";
+            case lt:
+                return " < ";
+            case le:
+                return " <= ";
+            case gt:
+                return " > ";
+            case ge:
+                return " >= ";
+            case like:
+            case not_like:
+                break;
+        }
+        return "";
+    }
+
+    std::string condition_expression(const filter::condition_type &c,
+                                     const schema_description &schema)
+    {
+        const int id = sifter::get<field_id>(c.lhs());
+        const std::string member = "r." + schema.fields.at(id).member;
+
+        /*
+         * Numbers are compared in the type of the literal, not of the
+         * member, so narrow and unsigned members are compared by value.
+         */
+        if (sifter::holds_alternative<long long>(c.rhs()))
+            return "sifter::as_integer(" + member + ")" +
+                   cpp_operator(c.comp()) + literal(c.rhs());
+
+        if (sifter::holds_alternative<double>(c.rhs()))
+            return "sifter::as_floating(" + member + ")" +
+                   cpp_operator(c.comp()) + literal(c.rhs());
+
+        /*
+         * Strings are compared without temporary std::string, the size is
+         * passed explicitly, so values may contain '\0'.
+         */
+        const std::string &pattern = sifter::get<std::string>(c.rhs());
+        if (c.comp() != like && c.comp() != not_like)
+            return member + ".compare(0, " + member + ".size(), " +
+                   literal(c.rhs()) + ", " + std::to_string(pattern.size()) +
+                   ")" + cpp_operator(c.comp()) + "0";
+
+        return std::string(c.comp() == not_like ? "!" : "") +
+               "sifter::like_match(" + member + ".data(), " + member +
+               ".size(), " + string_literal(pattern) + ", " +
+               std::to_string(pattern.size()) + ")";
+    }
+}
+
+sifter::codegen::schema_description sifter::codegen::read_schema(
+        std::istream &in)
+{
+    schema_description schema;
+    std::string text;
+    std::size_t line = 0;
+
+    while (std::getline(in, text))
+    {
+        ++line;
+        text = trim(text);
+        if (text.empty() || text[0] == '#')
+            continue;
+
+        std::istringstream words(text);
+        std::string keyword;
+        words >> keyword;
+
+        if (keyword == "record")
+        {
+            words >> schema.record;
+        }
+        else if (keyword == "include")
+        {
+            schema.includes.push_back(trim(text.substr(keyword.size())));
+        }
+        else if (keyword == "namespace")
+        {
+            words >> schema.name_space;
+        }
+        else if (keyword == "field")
+        {
+            field_description field;
+            std::string type;
+            if (!(words >> field.id >> field.member >> type))
+                throw error(at_line(line, "field id, member and type "
+                                          "expected"));
+
+            try
+            {
+                field.type = parse_kind(type);
+            }
+            catch (const error &e)
+            {
+                throw error(at_line(line, e.what()));
+            }
+
+            if (!schema.fields.emplace(field.id, field).second)
+                throw error(at_line(line, "duplicate field " +
+                                          std::to_string(field.id)));
+        }
+        else
+        {
+            throw error(at_line(line, "unknown keyword \"" + keyword + "\""));
+        }
+    }
+
+    if (schema.record.empty())
+        throw error("record is not declared");
+
+    return schema;
+}
+
+sifter::codegen::filter sifter::codegen::parse(
+        const std::string &text, const schema_description &schema)
+{
+    return parser(text, schema).parse();
+}
+
+std::vector<sifter::codegen::named_filter> sifter::codegen::read_filters(
+        std::istream &in, const schema_description &schema)
+{
+    std::vector<named_filter> filters;
+    std::string text;
+    std::size_t line = 0;
+
+    while (std::getline(in, text))
+    {
+        ++line;
+        if (!text.empty() && text.back() == '\r')
+            text.pop_back();
+
+        const auto begin = text.find_first_not_of(" \t");
+        if (begin == std::string::npos || text[begin] == '#')
+            continue;
+
+        const auto end = text.find_first_of(" \t", begin);
+        const std::string name = text.substr(begin, end - begin);
+        if (!is_identifier(name))
+            throw error(at_line(line, "invalid function name \"" + name +
+                                      "\""));
+
+        const auto start = end == std::string::npos
+                ? std::string::npos : text.find_first_not_of(" \t", end);
+
+        try
+        {
+            filters.emplace_back(name, parse(start == std::string::npos
+                    ? std::string() : text.substr(start), schema));
+        }
+        catch (const error &e)
+        {
+            throw error(at_line(line, e.what()));
+        }
+    }
+
+    return filters;
+}
+
+std::string sifter::codegen::expression(const filter &f,
+                                        const schema_description &schema)
+{
+    const bool has_lhs = f.left_is_filter() || f.left_is_condition();
+    const bool has_rhs = f.right_is_filter() || f.right_is_condition();
+
+    std::string lhs;
+    if (has_lhs)
+    {
+        lhs = f.left_is_filter()
+                ? expression(f.left_filter(), schema)
+                : condition_expression(f.left_condition(), schema);
+
+        if (!has_rhs || f.oper() == operation::_none)
+            return lhs;
+    }
+
+    if (!has_rhs)
+        return "true";
+
+    const std::string rhs = f.right_is_filter()
+            ? expression(f.right_filter(), schema)
+            : condition_expression(f.right_condition(), schema);
+
+    if (!has_lhs)
+        return rhs;
+
+    return "(" + lhs + (f.oper() == operation::_and ? " && " : " || ") +
+           rhs + ")";
+}
+
+void sifter::codegen::generate(std::ostream &out,
+                               const schema_description &schema,
+                               const std::vector<named_filter> &filters)
+{
+    const std::string indent = schema.name_space.empty() ? "" : "    ";
+
+    out << "// Generated by sifter_codegen, do not edit.\n"
+        << "#pragma once\n\n"
+        << "#include <string>\n"
+        << "#include <sifter/evaluate.hpp>\n";
+
+    for (const auto &include : schema.includes)
+        out << "#include " << include << "\n";
+
+    out << "\n";
+    if (!schema.name_space.empty())
+        out << "namespace " << schema.name_space << "\n{\n";
+
+    for (std::size_t i = 0; i < filters.size(); ++i)
+    {
+        if (i != 0)
+            out << "\n";
+
+        const std::string body = expression(filters[i].second, schema);
+        out << indent << "inline bool " << filters[i].first << "(const "
+            << schema.record << (body == "true" ? " &" : " &r") << ")\n"
+            << indent << "{\n"
+            << indent << "    return " << body << ";\n"
+            << indent << "}\n";
+    }
+
+    if (!schema.name_space.empty())
+        out << "}\n";
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SIFTER_CODEGEN_HPP
+#define SIFTER_CODEGEN_HPP
+
+#include <iosfwd>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sifter/filter.hpp>
+
+namespace sifter
+{
+    namespace codegen
+    {
+        enum class kind
+        {
+            integer,
+            floating,
+            string
+        };
+
+        struct field_description
+        {
+            int id;
+            std::string member;
+            kind type;
+        };
+
+        /*
+         * Record, the filters are generated for:
+         *
+         * record person
+         * include "person.hpp"
+         * namespace rules
+         * field 0 id integer
+         * field 1 name string
+         */
+        struct schema_description
+        {
+            std::string record;
+            std::vector<std::string> includes;
+            std::string name_space;
+            std::map<int, field_description> fields;
+        };
+
+        /*
+         * Fields are written by default_dumper as integers, so the parsed
+         * filter uses unscoped enumeration as the field type.
+         */
+        enum field_id : int
+        {
+        };
+
+        using condition = sifter::condition<field_id, long long, double,
+                std::string>;
+        using filter = sifter::filter<field_id, long long, double,
+                std::string>;
+
+        using named_filter = std::pair<std::string, filter>;
+
+        class error : public std::runtime_error
+        {
+        public:
+            explicit error(const std::string &what)
+                : std::runtime_error(what)
+            {
+            }
+        };
+
+        schema_description read_schema(std::istream &in);
+
+        /*
+         * Parses filter in default_dumper text form. Left operand of each
+         * condition should be field, right one is the value of the field
+         * type. String values may not contain ')', "&&" and "||".
+         */
+        filter parse(const std::string &text, const schema_description &schema);
+
+        /*
+         * Reads filters, one per line: function name and filter text,
+         * separated by whitespace. Empty lines and lines, starting with '#',
+         * are skipped.
+         */
+        std::vector<named_filter> read_filters(std::istream &in,
+                                               const schema_description &schema);
+
+        /*
+         * Writes C++ expression, evaluating the filter over record r.
+         */
+        std::string expression(const filter &f,
+                               const schema_description &schema);
+
+        void generate(std::ostream &out, const schema_description &schema,
+                      const std::vector<named_filter> &filters);
+    }
+}
+
+#endif //SIFTER_CODEGEN_HPP
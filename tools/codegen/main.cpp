@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2021 Sergei Fundaev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <fstream>
+#include <iostream>
+#include "codegen.hpp"
+
+int main(int argc, char **argv)
+{
+    if (argc != 4)
+    {
+        std::cerr << "usage: sifter_codegen <schema> <filters> <output>"
+                  << std::endl;
+        return 2;
+    }
+
+    std::ifstream schema_file(argv[1]);
+    if (!schema_file)
+    {
+        std::cerr << argv[1] << ": can't open" << std::endl;
+        return 1;
+    }
+
+    std::ifstream filters_file(argv[2]);
+    if (!filters_file)
+    {
+        std::cerr << argv[2] << ": can't open" << std::endl;
+        return 1;
+    }
+
+    sifter::codegen::schema_description schema;
+    try
+    {
+        schema = sifter::codegen::read_schema(schema_file);
+    }
+    catch (const sifter::codegen::error &e)
+    {
+        std::cerr << argv[1] << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::vector<sifter::codegen::named_filter> filters;
+    try
+    {
+        filters = sifter::codegen::read_filters(filters_file, schema);
+    }
+    catch (const sifter::codegen::error &e)
+    {
+        std::cerr << argv[2] << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::ofstream out(argv[3]);
+    sifter::codegen::generate(out, schema, filters);
+    if (!out)
+    {
+        std::cerr << argv[3] << ": can't write" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}